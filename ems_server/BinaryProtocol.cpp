@@ -0,0 +1,149 @@
+#include "BinaryProtocol.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+
+void putU16(char* p, uint16_t value)
+{
+    p[0] = static_cast<char>(value >> 8);
+    p[1] = static_cast<char>(value);
+}
+
+void putU32(char* p, uint32_t value)
+{
+    p[0] = static_cast<char>(value >> 24);
+    p[1] = static_cast<char>(value >> 16);
+    p[2] = static_cast<char>(value >> 8);
+    p[3] = static_cast<char>(value);
+}
+
+void putU64(char* p, uint64_t value)
+{
+    putU32(p, static_cast<uint32_t>(value >> 32));
+    putU32(p + 4, static_cast<uint32_t>(value));
+}
+
+uint16_t getU16(const char* p)
+{
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint16_t>((u[0] << 8) | u[1]);
+}
+
+uint32_t getU32(const char* p)
+{
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return (uint32_t(u[0]) << 24) | (uint32_t(u[1]) << 16) | (uint32_t(u[2]) << 8) | uint32_t(u[3]);
+}
+
+// 길이(u8) + 문자열 (255바이트까지)
+void appendShortString(std::string& out, std::string_view text)
+{
+    if (text.size() > 255)
+        text = text.substr(0, 255);
+    out += static_cast<char>(text.size());
+    out.append(text.data(), text.size());
+}
+
+} // namespace
+
+BinaryStatus binaryStatus(CommandResult result)
+{
+    switch (result)
+    {
+    case CommandResult::Sent:     return BinaryStatus::Ok;
+    case CommandResult::Timeout:  return BinaryStatus::Timeout;
+    case CommandResult::Busy:     return BinaryStatus::Busy;
+    case CommandResult::NoDevice: return BinaryStatus::NoDevice;
+    case CommandResult::Failed:   return BinaryStatus::SendFailed;
+    case CommandResult::Superseded: return BinaryStatus::Superseded;
+    }
+    return BinaryStatus::SendFailed;
+}
+
+BinaryHeader decodeBinaryHeader(const char* data)
+{
+    BinaryHeader header;
+    header.length = getU16(data);
+    header.opcode = static_cast<uint8_t>(data[2]);
+    header.status = static_cast<uint8_t>(data[3]);
+    header.requestId = getU32(data + 4);
+    header.homeId = getU32(data + 8);
+    return header;
+}
+
+size_t beginBinaryFrame(std::string& out, Opcode opcode, uint32_t requestId, uint32_t homeId)
+{
+    size_t start = out.size();
+    out.resize(start + kBinaryHeaderSize);
+    char* p = &out[start];
+    putU16(p, 0);
+    p[2] = static_cast<char>(opcode);
+    p[3] = 0;
+    putU32(p + 4, requestId);
+    putU32(p + 8, homeId);
+    return start;
+}
+
+void finishBinaryFrame(std::string& out, size_t start, BinaryStatus status)
+{
+    putU16(&out[start], static_cast<uint16_t>(out.size() - start - kBinaryHeaderSize));
+    out[start + 3] = static_cast<char>(status);
+}
+
+void appendSampleRecord(std::string& out, std::string_view device, int64_t timeUs, uint64_t updates,
+                        const SensorSample& sample)
+{
+    double values[kMaxSampleFields];
+    size_t fields = sampleFieldValues(sample, values);
+    if (device.size() > 255)
+        device = device.substr(0, 255);
+
+    size_t start = out.size();
+    out.resize(start + kSampleRecordHeaderSize + device.size() + fields * sizeof(float));
+    char* p = &out[start];
+    p[0] = static_cast<char>(sample.index());
+    p[1] = static_cast<char>(fields);
+    p[2] = static_cast<char>(device.size());
+    p[3] = 0;
+    putU64(p + 4, static_cast<uint64_t>(timeUs));
+    putU32(p + 12, static_cast<uint32_t>(updates));
+    std::memcpy(p + kSampleRecordHeaderSize, device.data(), device.size());
+
+    p += kSampleRecordHeaderSize + device.size();
+    for (size_t i = 0; i < fields; ++i)
+    {
+        float value = static_cast<float>(values[i]);
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        putU32(p + i * sizeof(float), bits);
+    }
+}
+
+void appendActuatorState(std::string& out, std::string_view device, const ActuatorState& state)
+{
+    appendShortString(out, device);
+    appendShortString(out, state.commanded);
+    appendShortString(out, state.confirmed);
+    out += static_cast<char>(state.pending ? 1 : 0);
+    size_t start = out.size();
+    out.resize(start + 4);
+    int64_t ageMs = std::min<int64_t>(state.confirmedAgeMs, INT32_MAX);
+    putU32(&out[start], static_cast<uint32_t>(static_cast<int32_t>(ageMs)));
+}
+
+bool splitSensorPayload(std::string_view payload, std::string_view& device, std::string_view& line)
+{
+    if (payload.empty())
+        return false;
+
+    size_t length = static_cast<unsigned char>(payload[0]);
+    if (length == 0 || payload.size() <= 1 + length)
+        return false;
+
+    device = payload.substr(1, length);
+    line = payload.substr(1 + length);
+    return true;
+}
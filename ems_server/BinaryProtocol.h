@@ -0,0 +1,90 @@
+#ifndef BINARYPROTOCOL_H
+#define BINARYPROTOCOL_H
+
+#include "CommandTable.h"
+#include "SensorParser.h"
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+// 텍스트 명령과 같은 포트에서 쓰는 바이너리 프로토콜 (자동화 클라이언트용)
+// 연결의 첫 바이트가 kBinaryMagic이면 [magic][version] 2바이트로 협상하고, 서버도 같은 2바이트로 답함
+// (텍스트 명령은 ASCII, 길이 헤더 방식은 첫 바이트가 0이라 겹치지 않음, 지원하지 않는 version이면 답한 뒤 끊음)
+//
+// 이후 모든 프레임 = 12바이트 고정 헤더 + payload (정수는 big-endian, 실수는 IEEE754 float)
+//   u16 length      payload 바이트 수
+//   u8  opcode      Opcode (응답은 요청과 같은 값, 구독 업데이트는 Opcode::Event)
+//   u8  status      요청은 0, 응답은 BinaryStatus
+//   u32 requestId   클라이언트가 정한 번호를 응답에 그대로 돌려줌 (구독 업데이트는 0)
+//   u32 homeId      요청: 대상 home (0이면 연결의 home), 응답: 처리한 home
+//
+// opcode별 payload
+//   제어 명령 (WindowOpen 등)   요청/응답 없음 (응답은 블루투스 전송 결과가 나온 뒤)
+//   Get                         요청: 모듈 이름 또는 종류, 응답: 샘플 레코드 1개
+//   Snapshot                    응답: u16 개수 + 샘플 레코드 (home의 모든 모듈을 한 프레임으로)
+//   State                       요청: 모듈 이름, 응답: 구동기 상태 레코드 1개
+//   Subscribe                   요청: 대상 ("all", 종류, 모듈 이름), 이후 Event 프레임마다 샘플 레코드 1개
+//   Unsubscribe                 없음
+//   Home                        헤더의 homeId를 연결의 home으로 선택 (응답 헤더에 선택된 home)
+//   Sensor                      요청: u8 이름 길이 + 모듈 이름 + 센서 줄
+//
+// 샘플 레코드 = u8 종류(fire 0, pet 1, plant 2) + u8 필드 수 + u8 이름 길이 + u8 0
+//               + i64 time_us + u32 updates + 이름 + float 필드 값 (sampleFieldName 순서)
+//
+// 구동기 상태 레코드 = u8 이름 길이 + 이름 + u8 명령 길이 + 마지막 요청 명령 + u8 명령 길이 + 확인된 명령
+//                      + u8 대기 중(0/1) + i32 확인 후 ms (모르면 -1)
+//
+// 응답마다 requestId가 있으므로 텍스트와 달리 응답 순서를 지키지 않음
+// (블루투스 전송을 기다리는 제어 명령 뒤의 조회도 바로 응답)
+
+constexpr uint8_t kBinaryMagic = 0xB1;
+constexpr uint8_t kBinaryVersion = 1;
+constexpr size_t kBinaryHelloSize = 2;
+constexpr size_t kBinaryHeaderSize = 12;
+constexpr size_t kSampleRecordHeaderSize = 16;
+
+// 응답 상태
+enum class BinaryStatus : uint8_t
+{
+    Ok            = 0,
+    Timeout       = 1,  // CommandResult와 같은 의미
+    Busy          = 2,
+    NoDevice      = 3,
+    SendFailed    = 4,
+    NoData        = 5,  // 조회할 값이 없음
+    BadRequest    = 6,  // payload 형식이 맞지 않음
+    Unavailable   = 7,  // 서버에 해당 기능이 설정되지 않음 (구독 hub 등)
+    UnknownOpcode = 8,
+    Superseded    = 9   // CommandResult::Superseded
+};
+
+BinaryStatus binaryStatus(CommandResult result);
+
+struct BinaryHeader
+{
+    uint16_t length;
+    uint8_t opcode;
+    uint8_t status;
+    uint32_t requestId;
+    uint32_t homeId;
+};
+
+// data에서 kBinaryHeaderSize 바이트를 읽음 (복사 없이 수신 버퍼 위에서 바로 해석)
+BinaryHeader decodeBinaryHeader(const char* data);
+
+// 헤더를 out 뒤에 추가하고 시작 위치 반환 (payload를 붙인 뒤 finishBinaryFrame으로 길이/상태 기록)
+size_t beginBinaryFrame(std::string& out, Opcode opcode, uint32_t requestId, uint32_t homeId);
+void finishBinaryFrame(std::string& out, size_t start, BinaryStatus status);
+
+// 샘플 레코드 하나를 out 뒤에 추가 (이름은 255바이트까지)
+void appendSampleRecord(std::string& out, std::string_view device, int64_t timeUs, uint64_t updates,
+                        const SensorSample& sample);
+
+// 구동기 상태 레코드 하나를 out 뒤에 추가 (이름과 명령은 255바이트까지)
+void appendActuatorState(std::string& out, std::string_view device, const ActuatorState& state);
+
+// Sensor 요청 payload를 모듈 이름과 센서 줄로 나눔 (형식이 맞지 않으면 false)
+bool splitSensorPayload(std::string_view payload, std::string_view& device, std::string_view& line);
+
+#endif // BINARYPROTOCOL_H
@@ -1,300 +1,982 @@
 #include "BluetoothManager.h"
-#include "DBManager.h"
+#include "Logger.h"
 
 #include <fcntl.h>
 #include <unistd.h>
 #include <iostream>
-#include <sstream>
 #include <cstring>
-#include <sys/select.h>
-#include <map>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include <sys/eventfd.h>
+#include <chrono>
+#include <algorithm>
 
-// 디바이스별 데이터 버퍼
-std::map<std::string, std::string> deviceBuffers;
+namespace
+{
+
+constexpr size_t kDeviceBufferSize = 2048;   // 디바이스별 수신 버퍼 (한 줄 최대 길이)
+constexpr int kMaxEvents = 16;
+constexpr int kIdleWaitMs = 1000;            // 기한이 걸린 송신 명령이 없을 때 epoll_wait 타임아웃
+constexpr size_t kMaxOutboundCommands = 32;  // 디바이스별 송신 대기열 한도 (넘으면 Busy)
+constexpr auto kDefaultCommandTimeout = std::chrono::milliseconds(2000);
+
+void complete(const CommandCompletion& done, CommandResult result)
+{
+    if (done)
+        done(result);
+}
+
+// 대기열 항목(명령 + 개행)이 command와 같은지
+bool sameCommand(const std::string& bytes, const std::string& command)
+{
+    return bytes.size() == command.size() + 1 && bytes.compare(0, command.size(), command) == 0;
+}
+
+// 디바이스별 메트릭 label (home마다 같은 이름의 디바이스가 있으므로 home도 붙임)
+std::string deviceLabels(uint32_t homeId, const std::string& name)
+{
+    return "home=\"" + std::to_string(homeId) + "\",device=\"" + name + "\"";
+}
+
+} // namespace
+
+BluetoothManager::Device::Device(uint32_t deviceIndex, uint32_t deviceHome, const std::string& deviceName,
+                                 const std::string& devicePath)
+    : index(deviceIndex), homeId(deviceHome), name(deviceName),
+      label(deviceHome == kDefaultHomeId ? deviceName : "h" + std::to_string(deviceHome) + "/" + deviceName),
+      path(devicePath), remote(devicePath.empty()), input(kDeviceBufferSize, kDeviceBufferSize),
+      receivedLines(Metrics::instance().counter("ems_sensor_lines_total", "디바이스별 수신 줄 수",
+                                                deviceLabels(deviceHome, deviceName))),
+      sentCommands(Metrics::instance().counter("ems_bt_commands_sent_total", "디바이스별 송신 명령 수",
+                                               deviceLabels(deviceHome, deviceName))),
+      disconnects(Metrics::instance().counter("ems_device_disconnects_total", "디바이스별 연결 끊김 수",
+                                              deviceLabels(deviceHome, deviceName)))
+{
+}
+
+BluetoothManager::BluetoothManager()
+    : epollFd(-1),
+      wakeFd(-1),
+      outboundPending(false),
+      commandTimeoutMs(kDefaultCommandTimeout.count()),
+      debounceMs(ActuatorOptions().debounce.count()),
+      stateTtlMs(ActuatorOptions().stateTtl.count()),
+      stopRequested(false),
+      loopRunning(false),
+      handleLatency(Metrics::instance().histogram(
+          "ems_sensor_handle_seconds", "센서 줄 하나의 파싱 + sink 기록 시간")),
+      sendLatency(Metrics::instance().histogram(
+          "ems_bt_send_seconds", "블루투스 명령 송신 시간 (대기열 대기 포함)")),
+      sendFailures(Metrics::instance().counter(
+          "ems_bt_send_failures_total", "블루투스 명령 송신 실패 수 (기한 초과 제외)")),
+      coalescedCommands(Metrics::instance().counter(
+          "ems_bt_commands_coalesced_total", "대기 중인 같은 명령에 합쳐진 송신 요청 수")),
+      expiredCommands(Metrics::instance().counter(
+          "ems_bt_commands_expired_total", "기한 안에 보내지 못한 블루투스 명령 수")),
+      suppressedCommands(Metrics::instance().counter(
+          "ems_bt_commands_suppressed_total", "이미 그 상태라서 보내지 않은 구동기 명령 수")),
+      supersededCommands(Metrics::instance().counter(
+          "ems_bt_commands_superseded_total", "debounce로 기다리다 다른 상태 명령으로 바뀐 명령 수"))
+{
+    Metrics& metrics = Metrics::instance();
+    metrics.gauge("ems_ingest_queue_depth", "파싱/DB worker 큐에 대기 중인 줄 수", "",
+                  [this] { return static_cast<double>(ingest.queueDepth()); }, this);
+    metrics.counterFn("ems_ingest_dropped_lines_total", "worker 큐가 가득 차서 버린 줄 수", "",
+                      [this] { return static_cast<double>(ingest.droppedLines()); }, this);
+    metrics.counterFn("ems_ingest_processed_lines_total", "worker가 처리한 줄 수", "",
+                      [this] { return static_cast<double>(ingest.processedLines()); }, this);
+    metrics.counterFn("ems_sensor_accepted_lines_total", "파싱에 성공한 센서 줄 수", "",
+                      [this] { return static_cast<double>(parser.acceptedLines()); }, this);
+
+    for (size_t i = 1; i < static_cast<size_t>(ParseError::Count); ++i)
+    {
+        ParseError error = static_cast<ParseError>(i);
+        metrics.counterFn("ems_sensor_rejected_lines_total", "파싱에 실패한 센서 줄 수 (원인별)",
+                          std::string("reason=\"") + parseErrorName(error) + "\"",
+                          [this, error] { return static_cast<double>(parser.rejectedLines(error)); },
+                          this);
+    }
+    metrics.gauge("ems_homes", "디바이스가 등록된 home 수", "",
+                  [this] { return static_cast<double>(homeCount()); }, this);
+}
+
+BluetoothManager::~BluetoothManager()
+{
+    Metrics::instance().removeOwner(this);
+    stop();
+
+    for (auto& device : devices)
+    {
+        if (device->fd >= 0)
+            close(device->fd);
+    }
+    for (auto& opened : openedPorts)
+        close(opened.second);
+    if (wakeFd >= 0)
+        close(wakeFd);
+    if (epollFd >= 0)
+        close(epollFd);
+}
 
 // 디바이스 등록
-void BluetoothManager::addDevice(const std::string& name, const std::string& path)
+void BluetoothManager::addDevice(const std::string& name, const std::string& path, uint32_t homeId)
+{
+    if (Device* existing = findDevice(homeId, name))
+    {
+        existing->path = path;
+        existing->remote = path.empty();
+        return;
+    }
+
+    Device* device = createDevice(name, path, homeId);
+    Metrics::instance().gauge("ems_device_up", "디바이스 포트가 열려 있으면 1", deviceLabels(homeId, name),
+                              [device] { return device->up.load(std::memory_order_relaxed) ? 1.0 : 0.0; },
+                              this);
+}
+
+void BluetoothManager::addRemoteDevice(const std::string& name, uint32_t homeId)
+{
+    if (Device* existing = findDevice(homeId, name))
+    {
+        existing->path.clear();
+        existing->remote = true;
+        return;
+    }
+    createDevice(name, std::string(), homeId);
+}
+
+BluetoothManager::Device* BluetoothManager::createDevice(const std::string& name, const std::string& path,
+                                                         uint32_t homeId)
+{
+    devices.emplace_back(new Device(static_cast<uint32_t>(devices.size()), homeId, name, path));
+    Device* device = devices.back().get();
+    homes[homeId].emplace(name, device);
+
+    Metrics::instance().gauge("ems_device_last_line_age_seconds", "마지막 센서 줄 이후 지난 시간 (받은 적 없으면 -1)",
+                              deviceLabels(homeId, name),
+                              [device] {
+                                  int64_t last = device->lastLineUs.load(std::memory_order_relaxed);
+                                  if (last == 0)
+                                      return -1.0;
+                                  int64_t nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                      std::chrono::system_clock::now().time_since_epoch()).count();
+                                  return (nowUs - last) / 1e6;
+                              }, this);
+    return device;
+}
+
+size_t BluetoothManager::connectedDevices() const
 {
-    devices[name] = path;
-    deviceBuffers[name] = ""; // 버퍼 초기화
+    size_t count = 0;
+    for (const auto& device : devices)
+    {
+        if (device->up.load(std::memory_order_relaxed))
+            ++count;
+    }
+    return count;
+}
+
+void BluetoothManager::setActuatorOptions(const ActuatorOptions& options)
+{
+    debounceMs.store(options.debounce.count(), std::memory_order_relaxed);
+    stateTtlMs.store(options.stateTtl.count(), std::memory_order_relaxed);
+}
+
+void BluetoothManager::setIngestWorkers(size_t workers, size_t queueCapacity)
+{
+    ingest.configure(workers, queueCapacity);
+}
+
+BluetoothManager::Device* BluetoothManager::findDevice(uint32_t homeId, std::string_view name)
+{
+    auto home = homes.find(homeId);
+    if (home == homes.end())
+        return nullptr;
+    auto it = home->second.find(name);
+    return it == home->second.end() ? nullptr : it->second;
 }
 
 // 포트 초기화
 bool BluetoothManager::initializeDevices()
 {
-    for (auto& it : devices)
+    if (epollFd < 0)
     {
-        // 읽기는 Non-blocking, 쓰기는 Blocking으로 설정
-        int fd = open(it.second.c_str(), O_RDWR | O_NOCTTY);
-        if (fd < 0)
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0)
         {
-            perror(("블루투스 포트 열기 실패: " + it.second).c_str());
+            perror("epoll 생성 실패");
             return false;
         }
+    }
 
-        // 읽기용 Non-blocking 설정
-        int flags = fcntl(fd, F_GETFL, 0);
-        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    if (wakeFd < 0)
+    {
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = &wakeFd;
+        if (wakeFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev) < 0)
+        {
+            perror("eventfd 생성 실패");
+            return false;
+        }
+    }
 
-        deviceFds[it.first] = fd;
-        std::cout << it.first << " (" << it.second << ") 포트 열림" << std::endl;
+    // 감시자가 다시 연 포트는 openedPorts에 넣고 수신 루프를 깨움
+    std::vector<std::string> paths;
+    for (auto& device : devices)
+        paths.push_back(device->path);
+    supervisor.start(paths, [this](uint32_t index, int fd) {
+        {
+            std::lock_guard<std::mutex> lock(openedMutex);
+            openedPorts.emplace_back(index, fd);
+        }
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    });
+
+    for (auto& device : devices)
+    {
+        // 원격 디바이스는 TCP로 줄을 받으므로 열 포트가 없음
+        if (device->remote)
+            continue;
+
+        // 읽기/쓰기 모두 Non-blocking (쓰기는 송신 대기열에서 processDataLoop가 처리)
+        int fd = DeviceSupervisor::openPort(device->path);
+        if (fd < 0)
+        {
+            // 나머지 모듈은 계속 동작, 이 모듈은 감시자가 다시 엶 (/dev에 노드가 생기면 바로)
+            LOG_WARN("블루투스 포트 열기 실패: %s: %s - 연결될 때까지 재시도", device->path.c_str(), strerror(errno));
+            supervisor.reportDown(device->index, std::chrono::steady_clock::duration::zero());
+            continue;
+        }
+        adoptPort(*device, fd);
+        std::cout << device->label << " (" << device->path << ") 포트 열림" << std::endl;
     }
+
+    // 파싱/DB 저장은 worker 풀에서 처리 (수신 스레드는 read만 담당)
+    ingest.start([this](const RawLine& line) {
+        processLine(line);
+    });
+    std::cout << "센서 처리 worker " << ingest.workerCount() << "개 시작" << std::endl;
     return true;
 }
 
-// Non-blocking 데이터 수신 루프 - 버퍼링 추가
+// epoll 기반 데이터 수신 + 송신 대기열 처리 루프
+// 한 디바이스의 포트가 막혀도 그 디바이스 대기열만 쌓이고 다른 디바이스 송수신은 계속됨
 void BluetoothManager::processDataLoop()
 {
-    char buf[1024];
+    struct epoll_event events[kMaxEvents];
 
-    while (true)
     {
-        fd_set readfds;
-        FD_ZERO(&readfds);
+        std::lock_guard<std::mutex> lock(loopMutex);
+        loopRunning = true;
+    }
 
-        int maxFd = 0;
-        for (auto& it : deviceFds)
-        {
-            FD_SET(it.second, &readfds);
-            if (it.second > maxFd)
-                maxFd = it.second;
-        }
+    // 루프 시작 전에 들어온 명령 전송
+    adoptOpenedPorts();
+    for (auto& device : devices)
+        flushDevice(*device);
 
-        struct timeval tv;
-        tv.tv_sec = 1;   // 1초 타임아웃
-        tv.tv_usec = 0;
+    while (!stopRequested.load(std::memory_order_acquire))
+    {
+        // 조용해진 디바이스를 끊긴 것으로 처리
+        checkLiveness(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
 
-        int ret = select(maxFd + 1, &readfds, nullptr, nullptr, &tv);
-        if (ret < 0)
+        // debounce 간격이 끝난 구동기 명령 전송
+        for (auto& device : devices)
         {
-            perror("select 오류");
-            continue;
+            if (device->holding)
+                flushDevice(*device);
         }
-        else if (ret == 0)
+
+        // 기한이 지난 송신 명령을 정리하고 다음 기한까지만 대기
+        int timeoutMs = expireOutbound(std::chrono::steady_clock::now());
+        int ret = epoll_wait(epollFd, events, kMaxEvents, timeoutMs);
+        if (ret < 0)
         {
-            // 타임아웃: 데이터 없음
+            if (errno != EINTR)
+                perror("epoll_wait 오류");
             continue;
         }
 
-        // 읽을 수 있는 fd 처리
-        for (auto& it : deviceFds)
+        for (int i = 0; i < ret; ++i)
         {
-            int fd = it.second;
-            std::string deviceName = it.first;
-            
-            if (FD_ISSET(fd, &readfds))
+            if (events[i].data.ptr == &wakeFd)
             {
-                int bytesRead = read(fd, buf, sizeof(buf)-1);
-                if (bytesRead > 0)
-                {
-                    buf[bytesRead] = '\0';
-                    
-                    // 디바이스별 버퍼에 데이터 추가
-                    deviceBuffers[deviceName] += std::string(buf);
-                    
-                    // 완전한 줄(개행문자 포함) 검사 및 처리
-                    processCompleteLines(deviceName);
-                }
+                // 대기열에 새 명령이 들어왔거나 감시자가 포트를 다시 엶
+                // (플래그를 먼저 내려야 그 뒤에 들어온 명령이 다시 깨움)
+                uint64_t value;
+                ssize_t ignored = read(wakeFd, &value, sizeof(value));
+                (void)ignored;
+                outboundPending.store(false, std::memory_order_release);
+                adoptOpenedPorts();
+                for (auto& device : devices)
+                    flushDevice(*device);
+                continue;
             }
+
+            // 끊김(EPOLLHUP/EPOLLERR)은 read가 0이나 오류를 돌려줘서 readDevice에서 처리
+            Device& device = *static_cast<Device*>(events[i].data.ptr);
+            if (device.fd >= 0 && (events[i].events & ~static_cast<uint32_t>(EPOLLOUT)))
+                readDevice(device);
+            if (device.fd >= 0 && (events[i].events & EPOLLOUT))
+                flushDevice(device);
         }
     }
-}
 
-// 완전한 줄을 찾아서 처리하는 함수
-void BluetoothManager::processCompleteLines(const std::string& deviceName)
-{
-    std::string& buffer = deviceBuffers[deviceName];
-    size_t pos = 0;
-    
-    while ((pos = buffer.find('\n')) != std::string::npos)
+    // 남은 송신 명령을 마지막으로 한 번 보내 봄 (debounce로 기다리던 명령도, 막힌 포트는 기다리지 않음)
+    auto last = std::chrono::steady_clock::now();
+    for (auto& device : devices)
     {
-        // 완전한 한 줄 추출
-        std::string completeLine = buffer.substr(0, pos);
-        
-        // \r 문자 제거 (Windows 스타일 줄바꿈 대응)
-        if (!completeLine.empty() && completeLine.back() == '\r')
         {
-            completeLine.pop_back();
+            std::lock_guard<std::mutex> lock(device->outboundMutex);
+            for (OutboundCommand& entry : device->outbound)
+                entry.notBefore = std::min(entry.notBefore, last);
         }
-        
-        // 빈 줄이 아니면 처리
-        if (!completeLine.empty())
+        flushDevice(*device);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(loopMutex);
+        loopRunning = false;
+    }
+    loopCv.notify_all();
+}
+
+void BluetoothManager::stop()
+{
+    stopRequested.store(true, std::memory_order_release);
+    if (wakeFd >= 0)
+    {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(loopMutex);
+        loopCv.wait(lock, [this] { return !loopRunning; });
+    }
+
+    // 수신 루프가 끝난 뒤에 worker를 멈춰야 큐에 남은 줄까지 모두 sink로 넘어감
+    supervisor.stop();
+    ingest.stop();
+}
+
+// 열린 포트를 epoll에 등록하고 연결 상태로 표시
+void BluetoothManager::adoptPort(Device& device, int fd)
+{
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = &device;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+        LOG_ERROR("epoll 등록 실패: %s: %s", device.path.c_str(), strerror(errno));
+        close(fd);
+        supervisor.reportDown(device.index, std::chrono::steady_clock::duration::zero());
+        return;
+    }
+
+    device.fd = fd;
+    device.writeWatched = false;
+    device.upSince = std::chrono::steady_clock::now();
+    device.upSinceUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    device.up.store(true, std::memory_order_release);
+}
+
+void BluetoothManager::adoptOpenedPorts()
+{
+    std::vector<std::pair<uint32_t, int>> opened;
+    {
+        std::lock_guard<std::mutex> lock(openedMutex);
+        opened.swap(openedPorts);
+    }
+
+    for (auto& entry : opened)
+    {
+        Device& device = *devices[entry.first];
+        if (device.fd >= 0)
         {
-            std::cout << "[" << deviceName << "] received: " << completeLine << std::endl;
-            handleData(completeLine);
+            close(entry.second);
+            continue;
         }
-        
-        // 처리된 줄을 버퍼에서 제거
-        buffer.erase(0, pos + 1);
+        adoptPort(device, entry.second);
+        LOG_INFO("[%s] 다시 연결됨", device.label.c_str());
     }
-    
-    // 버퍼가 너무 크면 일부 제거 (메모리 보호)
-    if (buffer.length() > 2048)
+}
+
+// 포트를 닫고 감시자에게 재연결을 맡김 (대기 중이던 명령은 NoDevice로 완료)
+void BluetoothManager::markDown(Device& device, const char* reason)
+{
+    LOG_WARN("[%s] 연결 끊김 (%s) - 다시 연결 시도", device.label.c_str(), reason);
+
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, device.fd, nullptr);
+    close(device.fd);
+    device.fd = -1;
+    device.writeWatched = false;
+    device.up.store(false, std::memory_order_release);
+    device.input.clear();
+    device.discarding = false;
+    device.disconnects.inc();
+
+    std::vector<CommandCompletion> dropped;
     {
-        buffer.clear();
-        std::cout << "[" << deviceName << "] 버퍼 오버플로우 - 초기화" << std::endl;
+        std::lock_guard<std::mutex> lock(device.outboundMutex);
+        for (OutboundCommand& entry : device.outbound)
+        {
+            for (CommandCompletion& waiter : entry.waiters)
+                dropped.push_back(std::move(waiter));
+        }
+        device.outbound.clear();
+        device.confirmed.clear();      // 다시 연결된 모듈은 초기 상태일 수 있음
     }
+    device.holding = false;
+    for (CommandCompletion& waiter : dropped)
+        waiter(CommandResult::NoDevice);
+
+    supervisor.reportDown(device.index, std::chrono::steady_clock::now() - device.upSince);
 }
 
-// 특정 디바이스에 명령 전송
-bool BluetoothManager::sendCommand(const std::string& deviceName, const std::string& command)
+// 연결된 뒤 센서 줄을 보내던 디바이스가 staleTimeout 동안 조용하면 링크가 죽은 것으로 봄
+// (명령만 받는 모듈은 줄을 보내지 않으므로 판정하지 않음)
+void BluetoothManager::checkLiveness(int64_t nowUs)
 {
-    std::lock_guard<std::mutex> lock(sendMutex);
-    
-    auto it = deviceFds.find(deviceName);
-    if (it == deviceFds.end())
+    int64_t staleUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        supervisor.options().staleTimeout).count();
+    if (staleUs <= 0)
+        return;
+
+    for (auto& device : devices)
     {
-        std::cerr << "디바이스를 찾을 수 없음: " << deviceName << std::endl;
-        return false;
+        if (device->fd < 0)
+            continue;
+        int64_t last = device->lastLineUs.load(std::memory_order_relaxed);
+        if (last >= device->upSinceUs && nowUs - last > staleUs)
+            markDown(*device, "수신 없음");
     }
+}
 
-    int fd = it->second;
-    std::string fullCommand = command + "\n";  // 개행 문자 추가
-    
-    ssize_t bytesWritten = write(fd, fullCommand.c_str(), fullCommand.length());
-    if (bytesWritten < 0)
+// 디바이스 링 버퍼의 빈 공간에 바로 읽고 완성된 줄 처리
+void BluetoothManager::readDevice(Device& device)
+{
+    while (true)
     {
-        perror(("블루투스 전송 실패: " + deviceName).c_str());
-        return false;
-    }
+        struct iovec iov[2];
+        size_t count = device.input.writableSpans(iov);
+        if (count == 0)
+        {
+            // 개행 없이 버퍼가 가득 참: 버리고 다음 개행에서 다시 동기화
+            device.input.clear();
+            device.discarding = true;
+            LOG_WARN("[%s] 버퍼 오버플로우 - 다음 줄부터 다시 수신", device.label.c_str());
+            continue;
+        }
 
-    std::cout << "[" << deviceName << "] sent: " << command << std::endl;
-    return true;
+        ssize_t bytesRead = readv(device.fd, iov, static_cast<int>(count));
+        if (bytesRead > 0)
+        {
+            device.input.commitWrite(bytesRead);
+
+            // 완전한 줄(개행문자 포함) 검사 및 처리
+            processCompleteLines(device);
+            continue;
+        }
+
+        if (bytesRead < 0 && errno == EINTR)
+            continue;
+        if (bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+
+        // 0(hangup)이나 EIO 등: 블루투스 링크가 끊김
+        markDown(device, bytesRead == 0 ? "hangup" : strerror(errno));
+        return;
+    }
 }
 
-// 모든 디바이스에 명령 전송
-bool BluetoothManager::sendToAllDevices(const std::string& command)
+// 완전한 줄을 찾아서 처리하는 함수 (memchr로 개행 검색, 줄 단위 복사 없음)
+void BluetoothManager::processCompleteLines(Device& device)
 {
-    bool allSuccess = true;
-    for (auto& it : deviceFds)
+    RingBuffer& buffer = device.input;
+    size_t pos;
+
+    // 한 번에 읽힌 줄들은 같은 수신 시각을 사용
+    int64_t receivedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    device.lastLineUs.store(receivedUs, std::memory_order_relaxed);
+
+    while ((pos = buffer.find('\n')) != RingBuffer::npos)
     {
-        if (!sendCommand(it.first, command))
+        if (device.discarding)
         {
-            allSuccess = false;
+            // 잘린 줄의 나머지는 버림
+            buffer.consume(pos + 1);
+            device.discarding = false;
+            continue;
         }
+
+        // \r 문자 제거 (Windows 스타일 줄바꿈 대응)
+        size_t length = pos;
+        if (length > 0 && buffer.at(length - 1) == '\r')
+            --length;
+
+        // 빈 줄이 아니면 worker 큐로 넘김 (가득 차면 버려지고 집계됨)
+        if (length > 0)
+        {
+            std::string_view completeLine(buffer.contiguous(0, length, device.scratch), length);
+            device.receivedLines.inc();
+            ingest.submit(device.index, completeLine, receivedUs);
+        }
+
+        // 처리된 줄을 버퍼에서 제거
+        buffer.consume(pos + 1);
+    }
+
+    if (device.discarding)
+    {
+        buffer.clear();
     }
-    return allSuccess;
 }
 
-// TCP 명령을 블루투스 명령으로 변환하여 전송
-void BluetoothManager::handleTCPCommand(const std::string& tcpCommand)
+// worker 스레드에서 줄 하나 처리 (같은 디바이스의 줄은 항상 같은 worker가 순서대로 처리)
+void BluetoothManager::processLine(const RawLine& line)
 {
-    std::string bluetoothCommand = convertTCPToBluetoothCommand(tcpCommand);
-    
-    if (!bluetoothCommand.empty())
+    const Device& device = *devices[line.source];
+    LOG_SAMPLED(LogLevel::Info, "[%s] received: %.*s", device.label.c_str(),
+                static_cast<int>(line.length), line.data);
+    handleData(device, line.receivedUs, line.text());
+}
+
+// 샘플 저장 대상 추가 (initializeDevices 전에 호출, sink는 BluetoothManager보다 오래 살아야 함)
+void BluetoothManager::addSink(SensorSink* sink)
+{
+    if (sink)
+        sinks.push_back(sink);
+}
+
+// 특정 디바이스 송신 대기열에 명령 추가 (write는 processDataLoop 스레드에서)
+bool BluetoothManager::sendCommand(uint32_t homeId, const std::string& deviceName, const std::string& command,
+                                   CommandCompletion done)
+{
+    Device* device = findDevice(homeId, deviceName);
+    if (!device || device->remote || !device->up.load(std::memory_order_acquire))
+    {
+        LOG_ERROR("디바이스를 찾을 수 없거나 연결되지 않음: home %u %s", homeId, deviceName.c_str());
+        sendFailures.inc();
+        complete(done, CommandResult::NoDevice);
+        return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    auto timeout = std::chrono::milliseconds(commandTimeoutMs.load(std::memory_order_relaxed));
+    bool actuator = isActuatorCommand(command);
+    std::vector<CommandCompletion> superseded;
+    CommandCompletion suppressed;
+    CommandCompletion busy;
+    bool full = false;
+    bool wasEmpty = false;
     {
-        // 명령에 따라 특정 디바이스나 모든 디바이스에 전송
-        if (tcpCommand.find("window") != std::string::npos)
+        std::lock_guard<std::mutex> lock(device->outboundMutex);
+
+        auto notBefore = now;
+        OutboundCommand* pending = nullptr;
+        bool replaced = false;
+        if (actuator)
         {
-            // 창문 관련 명령은 창문 모듈(Smart Window)에 전송
-            sendCommand("windowModule", bluetoothCommand);
-            std::cout << "[TCP->BT] Window command sent: " << bluetoothCommand << std::endl;
+            // debounce로 기다리는 마지막 명령이 다른 상태면 보내지 않고 새 명령으로 바꿈
+            // (OPEN, CLOSE, OPEN이 몰리면 처음 OPEN과 마지막 상태만 전송)
+            if (!device->outbound.empty())
+            {
+                OutboundCommand& last = device->outbound.back();
+                if (last.actuator && last.written == 0 && last.notBefore > now && !sameCommand(last.bytes, command))
+                {
+                    for (CommandCompletion& waiter : last.waiters)
+                        superseded.push_back(std::move(waiter));
+                    notBefore = last.notBefore;
+                    device->outbound.pop_back();
+                    supersededCommands.inc();
+                    replaced = true;
+                }
+            }
+            pending = pendingActuatorCommand(*device);
         }
-        else if (tcpCommand.find("light") != std::string::npos)
+
+        if (pending && sameCommand(pending->bytes, command))
         {
-            // 조명 관련 명령은 조명 제어 모듈에 전송
-            sendCommand("lightModule", bluetoothCommand);
-            std::cout << "[TCP->BT] Light command sent: " << bluetoothCommand << std::endl;
+            // 같은 상태 명령이 이미 대기 중이면 그 결과를 같이 받음
+            if (done)
+                pending->waiters.push_back(std::move(done));
+            pending->deadline = std::max(pending->deadline, now + timeout);
+            coalescedCommands.inc();
         }
-        else if (tcpCommand.find("door") != std::string::npos)
+        else if (actuator && !pending && device->confirmed == command &&
+                 now - device->confirmedAt < std::chrono::milliseconds(stateTtlMs.load(std::memory_order_relaxed)))
         {
-            // 문 관련 명령은 문 제어 모듈에 전송
-            sendCommand("doorModule", bluetoothCommand);
-            std::cout << "[TCP->BT] Door command sent: " << bluetoothCommand << std::endl;
+            // 대기 중인 상태 명령이 없고 stateTtl 안에 같은 명령을 보냈으면 이미 그 상태
+            suppressedCommands.inc();
+            suppressed = std::move(done);
         }
-        else if (tcpCommand.find("set_") != std::string::npos)
+        else if (!actuator && !device->outbound.empty() && device->outbound.back().written == 0 &&
+                 sameCommand(device->outbound.back().bytes, command))
         {
-            // 설정 명령은 해당 창문 모듈에 전송
-            sendCommand("windowModule", bluetoothCommand);
-            std::cout << "[TCP->BT] Setting command sent: " << bluetoothCommand << std::endl;
+            // 아직 보내기 시작하지 않은 마지막 명령과 같으면 합침
+            // 마지막 명령만 비교해야 명령 순서가 바뀌지 않음
+            OutboundCommand& last = device->outbound.back();
+            if (done)
+                last.waiters.push_back(std::move(done));
+            last.deadline = std::max(last.deadline, now + timeout);
+            coalescedCommands.inc();
+        }
+        else if (device->outbound.size() >= kMaxOutboundCommands)
+        {
+            LOG_WARN("[%s] 송신 대기열 가득 참 - 명령 버림: %s", device->label.c_str(), command.c_str());
+            sendFailures.inc();
+            busy = std::move(done);
+            full = true;
         }
         else
         {
-            // 기타 명령은 모든 디바이스에 전송
-            sendToAllDevices(bluetoothCommand);
-            std::cout << "[TCP->BT] Broadcast command sent: " << bluetoothCommand << std::endl;
+            // 상태 명령은 디바이스별로 debounce 간격에 한 번까지만 내보냄 (바꾼 명령은 기다리던 시각 유지)
+            // 기다리는 명령은 실제로 보낼 때 releaseAt을 옮김 (취소된 명령이 다음 명령을 더 미루지 않도록)
+            if (actuator && !replaced)
+            {
+                auto debounce = std::chrono::milliseconds(debounceMs.load(std::memory_order_relaxed));
+                notBefore = std::max(now, device->releaseAt + debounce);
+                if (notBefore <= now)
+                    device->releaseAt = now;
+            }
+
+            wasEmpty = device->outbound.empty();
+            device->outbound.emplace_back();
+            OutboundCommand& entry = device->outbound.back();
+            entry.bytes.reserve(command.size() + 1);
+            entry.bytes = command;
+            entry.bytes += '\n';   // 개행 문자 추가
+            entry.queuedAt = now;
+            entry.notBefore = notBefore;
+            entry.deadline = notBefore + timeout;
+            entry.actuator = actuator;
+            if (done)
+                entry.waiters.push_back(std::move(done));
         }
     }
-    else
+
+    // 완료 콜백은 락 밖에서
+    for (CommandCompletion& waiter : superseded)
+        waiter(CommandResult::Superseded);
+    complete(suppressed, CommandResult::Sent);
+    if (full)
+    {
+        complete(busy, CommandResult::Busy);
+        return false;
+    }
+
+    // 대기열이 비어 있었을 때만 깨움 (아니면 이미 전송 중이거나 깨운 상태)
+    if (wasEmpty)
+        wakeLoop();
+    return true;
+}
+
+// 대기열에서 아직 끝까지 보내지 않은 마지막 상태 명령 (없으면 nullptr, outboundMutex를 잡고 호출)
+BluetoothManager::OutboundCommand* BluetoothManager::pendingActuatorCommand(Device& device)
+{
+    for (auto it = device.outbound.rbegin(); it != device.outbound.rend(); ++it)
     {
-        std::cout << "[TCP->BT] Unknown command: " << tcpCommand << std::endl;
+        if (it->actuator)
+            return &*it;
     }
+    return nullptr;
 }
 
-// TCP 명령을 블루투스 프로토콜로 변환
-std::string BluetoothManager::convertTCPToBluetoothCommand(const std::string& tcpCommand)
+bool BluetoothManager::actuatorState(uint32_t homeId, std::string_view deviceName, ActuatorState& state)
 {
-    // TCP 명령을 아두이노가 이해할 수 있는 형식으로 변환
-    if (tcpCommand == "window_open")
-        return "OPEN";
-    else if (tcpCommand == "window_close")
-        return "CLOSE";
-    else if (tcpCommand == "light_on")
-        return "CMD_LIGHT_ON";
-    else if (tcpCommand == "light_off")
-        return "CMD_LIGHT_OFF";
-    else if (tcpCommand == "door_open")
-        return "CMD_DOOR_OPEN";
-    else if (tcpCommand == "door_close")
-        return "CMD_DOOR_CLOSE";
-    
-    // 기타 명령어들 추가 가능
-    return "";
+    Device* device = findDevice(homeId, deviceName);
+    if (!device || device->remote)
+        return false;
+
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(device->outboundMutex);
+    OutboundCommand* pending = pendingActuatorCommand(*device);
+    state.pending = pending != nullptr;
+    if (pending)
+        state.commanded.assign(pending->bytes, 0, pending->bytes.size() - 1);
+    else
+        state.commanded = device->confirmed;
+    state.confirmed = device->confirmed;
+    state.confirmedAgeMs = device->confirmed.empty() ? -1 :
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - device->confirmedAt).count();
+    return true;
 }
 
-// 문자열 파싱
-std::vector<std::string> BluetoothManager::split(const std::string& str, char delimiter)
+void BluetoothManager::wakeLoop()
 {
-    std::vector<std::string> tokens;
-    std::stringstream ss(str);
-    std::string temp;
-    while (std::getline(ss, temp, delimiter))
-        tokens.push_back(temp);
-    return tokens;
+    if (wakeFd < 0 || outboundPending.exchange(true, std::memory_order_acq_rel))
+        return;
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+// 대기열 앞에서부터 non-blocking write (포트가 막히면 EPOLLOUT을 기다렸다가 이어서)
+void BluetoothManager::flushDevice(Device& device)
+{
+    if (device.fd < 0)
+        return;
+
+    std::vector<std::pair<CommandCompletion, CommandResult>> finished;
+    bool blocked = false;
+    int writeError = 0;
+    auto now = std::chrono::steady_clock::now();
+    device.holding = false;
+    {
+        std::lock_guard<std::mutex> lock(device.outboundMutex);
+        while (!device.outbound.empty())
+        {
+            OutboundCommand& front = device.outbound.front();
+            if (front.written == 0 && front.notBefore > now)
+            {
+                // debounce 간격이 끝나면 processDataLoop가 다시 부름
+                device.holding = true;
+                break;
+            }
+            ssize_t n = write(device.fd, front.bytes.data() + front.written, front.bytes.size() - front.written);
+            if (n > 0)
+            {
+                front.written += static_cast<size_t>(n);
+                if (front.written < front.bytes.size())
+                    continue;
+
+                device.sentCommands.inc();
+                sendLatency.record(std::chrono::steady_clock::now() - front.queuedAt);
+                if (front.actuator)
+                {
+                    device.confirmed.assign(front.bytes, 0, front.bytes.size() - 1);
+                    device.confirmedAt = now;
+                    device.releaseAt = std::max(device.releaseAt, now);
+                }
+                LOG_INFO("[%s] sent: %.*s", device.label.c_str(),
+                         static_cast<int>(front.bytes.size() - 1), front.bytes.data());
+                for (CommandCompletion& waiter : front.waiters)
+                    finished.emplace_back(std::move(waiter), CommandResult::Sent);
+                device.outbound.pop_front();
+                continue;
+            }
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                blocked = true;
+                break;
+            }
+
+            // 포트 오류: 남은 명령도 같은 포트로 나가야 하므로 모두 실패 처리하고 포트를 닫음
+            writeError = errno;
+            LOG_ERROR("블루투스 전송 실패: %s: %s", device.label.c_str(), strerror(writeError));
+            for (OutboundCommand& entry : device.outbound)
+            {
+                sendFailures.inc();
+                for (CommandCompletion& waiter : entry.waiters)
+                    finished.emplace_back(std::move(waiter), CommandResult::Failed);
+            }
+            device.outbound.clear();
+        }
+    }
+
+    if (writeError != 0)
+        markDown(device, strerror(writeError));
+    else
+        watchWritable(device, blocked);
+
+    // 완료 콜백은 락 밖에서 (콜백이 다시 sendCommand를 불러도 되도록)
+    for (auto& entry : finished)
+        entry.first(entry.second);
 }
 
-// 데이터 처리 후 DB 저장 (기존 코드 유지)
-void BluetoothManager::handleData(const std::string& rawData)
+void BluetoothManager::watchWritable(Device& device, bool watch)
 {
-    auto tokens = split(rawData, '_');
-    if (tokens.size() < 2)
+    if (device.writeWatched == watch)
         return;
 
-    std::string type = tokens[1];
+    struct epoll_event ev;
+    ev.events = watch ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    ev.data.ptr = &device;
+    if (epoll_ctl(epollFd, EPOLL_CTL_MOD, device.fd, &ev) == 0)
+        device.writeWatched = watch;
+}
+
+// 기한이 지난 명령을 Timeout으로 완료하고 다음 기한(또는 debounce가 끝나는 시각)까지 남은 시간(ms) 반환
+// 보내기 시작한 명령은 줄이 깨지지 않도록 나머지를 마저 보내고, 기다리던 쪽에만 Timeout을 알림
+int BluetoothManager::expireOutbound(std::chrono::steady_clock::time_point now)
+{
+    std::vector<CommandCompletion> expired;
+    auto next = now + std::chrono::milliseconds(kIdleWaitMs);
 
-    if (type == "fire" && tokens.size() == 4)
+    for (auto& device : devices)
     {
-        int fireData = std::stoi(tokens[2]);
-        float gasData = std::stof(tokens[3]);
+        std::lock_guard<std::mutex> lock(device->outboundMutex);
+        auto it = device->outbound.begin();
+        while (it != device->outbound.end())
+        {
+            if (it->deadline > now)
+            {
+                if (!it->waiters.empty() || it->written == 0)
+                    next = std::min(next, it->deadline);
+                if (it->written == 0 && it->notBefore > now)
+                    next = std::min(next, it->notBefore);
+                ++it;
+                continue;
+            }
 
-        // 조건에 따라 상태값 설정
-        std::string fireState = (fireData >= 150) ? "정상" : "화재";
-        std::string gasState  = (gasData >= 700.0f) ? "위험" : "정상";
+            if (!it->waiters.empty() || it->written == 0)
+            {
+                expiredCommands.inc();
+                LOG_WARN("[%s] 명령 송신 기한 초과: %.*s", device->label.c_str(),
+                         static_cast<int>(it->bytes.size() - 1), it->bytes.data());
+            }
+            for (CommandCompletion& waiter : it->waiters)
+                expired.push_back(std::move(waiter));
+            it->waiters.clear();
 
-        // DB 저장
-        DBManager::instance().insertFireData(fireState, fireData, gasState, gasData);
+            if (it->written == 0)
+                it = device->outbound.erase(it);
+            else
+                ++it;
+        }
     }
-    else if (type == "pet" && tokens.size() == 5)
+
+    for (CommandCompletion& waiter : expired)
+        waiter(CommandResult::Timeout);
+
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count();
+    return static_cast<int>(std::max<int64_t>(remaining + 1, 0));
+}
+
+// home의 모든 로컬 디바이스 대기열에 명령 추가 (원격 디바이스는 명령을 받을 수 없어서 제외)
+bool BluetoothManager::sendToAllDevices(uint32_t homeId, const std::string& command, CommandCompletion done)
+{
+    std::vector<Device*> targets;
+    auto home = homes.find(homeId);
+    if (home != homes.end())
     {
-        int foodVal = std::stoi(tokens[2]);
-        int waterVal = std::stoi(tokens[3]);
-        int toiletVal = std::stoi(tokens[4]);
+        for (auto& entry : home->second)
+        {
+            if (!entry.second->remote)
+                targets.push_back(entry.second);
+        }
+    }
 
-        // 조건에 따라 상태 문자열 변환
-        std::string foodData   = (foodVal == 1) ? "충분" : "부족";
-        std::string waterData  = (waterVal == 1) ? "충분" : "부족";
-        std::string toiletState = (toiletVal == 0) ? "깨끗함" : "청소 필요";
+    if (!done)
+    {
+        bool allQueued = true;
+        for (Device* device : targets)
+        {
+            if (!sendCommand(homeId, device->name, command))
+                allQueued = false;
+        }
+        return allQueued;
+    }
 
-        // DB 저장
-        DBManager::instance().insertPetData(foodData, waterData, toiletState);
+    if (targets.empty())
+    {
+        done(CommandResult::NoDevice);
+        return false;
+    }
+
+    // 디바이스별 결과를 모아서 마지막 결과가 나올 때 한 번 완료 (첫 실패 결과 유지)
+    struct Broadcast
+    {
+        std::atomic<size_t> remaining;
+        std::atomic<int> result;
+        CommandCompletion done;
+    };
+    auto broadcast = std::make_shared<Broadcast>();
+    broadcast->remaining.store(targets.size());
+    broadcast->result.store(static_cast<int>(CommandResult::Sent));
+    broadcast->done = std::move(done);
+
+    bool allQueued = true;
+    for (Device* device : targets)
+    {
+        bool queued = sendCommand(homeId, device->name, command, [broadcast](CommandResult result) {
+            if (result != CommandResult::Sent)
+            {
+                int expected = static_cast<int>(CommandResult::Sent);
+                broadcast->result.compare_exchange_strong(expected, static_cast<int>(result));
+            }
+            if (broadcast->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                broadcast->done(static_cast<CommandResult>(broadcast->result.load()));
+        });
+        if (!queued)
+            allQueued = false;
+    }
+    return allQueued;
+}
+
+// TCP 명령을 블루투스 명령으로 변환하여 전송 (변환 규칙과 대상 모듈은 CommandTable.cpp의 표)
+// done은 블루투스 포트에 기록된 뒤(또는 실패/기한 초과 시) 호출됨
+void BluetoothManager::handleTCPCommand(const Command& command, CommandCompletion done)
+{
+    if (!command.spec || command.spec->btCommand.empty())
+    {
+        LOG_WARN("[TCP->BT] Unknown command: %.*s", static_cast<int>(command.verb.size()), command.verb.data());
+        complete(done, CommandResult::Sent);    // 보낼 명령 없음
+        return;
+    }
+
+    std::string bluetoothCommand(command.spec->btCommand);
+    if (command.spec->device.empty())
+    {
+        // 대상 모듈이 없는 명령은 모든 디바이스에 전송
+        sendToAllDevices(command.homeId, bluetoothCommand, std::move(done));
+        LOG_INFO("[TCP->BT] home %u broadcast command queued: %s", command.homeId, bluetoothCommand.c_str());
     }
-    else if (type == "plant" && tokens.size() == 6)
+    else
     {
-        float soilData = std::stof(tokens[2]);
-        float lightData = std::stof(tokens[3]);
-        float tempData = std::stof(tokens[4]);
-        float humiData = std::stof(tokens[5]);
-        DBManager::instance().insertPlantData(soilData, tempData, humiData, lightData);
-        DBManager::instance().insertHomeData(tempData, humiData, lightData);
+        std::string deviceName(command.spec->device);
+        sendCommand(command.homeId, deviceName, bluetoothCommand, std::move(done));
+        LOG_INFO("[TCP->BT] home %u %s command queued: %s", command.homeId, deviceName.c_str(),
+                 bluetoothCommand.c_str());
     }
-}
\ No newline at end of file
+}
+
+// 원격 gateway의 센서 줄을 로컬 수신과 같은 방식으로 ingest 큐에 넣음 (디바이스별 worker가 순서대로 처리)
+CommandResult BluetoothManager::submitRemoteLine(uint32_t homeId, std::string_view deviceName, std::string_view line)
+{
+    Device* device = findDevice(homeId, deviceName);
+    if (!device || !device->remote)
+        return CommandResult::NoDevice;
+
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+    if (line.empty())
+        return CommandResult::Sent;
+
+    int64_t receivedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    device->lastLineUs.store(receivedUs, std::memory_order_relaxed);
+    device->receivedLines.inc();
+    return ingest.submit(device->index, line, receivedUs) ? CommandResult::Sent : CommandResult::Busy;
+}
+
+// 파싱 후 등록된 sink에 전달 (파싱 실패한 줄은 버리고 원인별로 집계)
+void BluetoothManager::handleData(const Device& device, int64_t timeUs, std::string_view rawData)
+{
+    LatencyHistogram::Timer timer(handleLatency);
+    SensorSample sample;
+    ParseError error = parser.parse(rawData, sample);
+    if (error != ParseError::None)
+    {
+        LOG_SAMPLED(LogLevel::Warn, "잘못된 센서 데이터 (%s): %.*s", parseErrorName(error),
+                    static_cast<int>(rawData.size()), rawData.data());
+        return;
+    }
+
+    for (SensorSink* sink : sinks)
+    {
+        sink->write(device.homeId, device.name, timeUs, sample);
+    }
+}
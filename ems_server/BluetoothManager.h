@@ -4,37 +4,202 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <string_view>
+#include "CommandTable.h"
+#include "SensorParser.h"
+#include "SensorSink.h"
+#include "RingBuffer.h"
+#include "IngestPipeline.h"
+#include "Metrics.h"
+#include "DeviceSupervisor.h"
+
+// 구동기 명령(창문, 조명, 문) 중복 제거와 debounce 설정
+struct ActuatorOptions
+{
+    std::chrono::milliseconds debounce{200};        // 디바이스별로 상태 명령을 이 간격에 한 번까지만 보냄 (0이면 끔)
+    std::chrono::milliseconds stateTtl{10000};      // 이 시간 안에 보낸 것과 같은 상태 명령은 보내지 않음 (0이면 끔)
+};
 
 class BluetoothManager
 {
 public:
-    // 디바이스 경로와 이름 매핑
-    void addDevice(const std::string& name, const std::string& path);
+    BluetoothManager();
+    ~BluetoothManager();
+    BluetoothManager(const BluetoothManager&) = delete;
+    BluetoothManager& operator=(const BluetoothManager&) = delete;
+
+    // 디바이스 경로와 이름 매핑 (이름은 home 안에서만 유일, initializeDevices 전에 호출)
+    void addDevice(const std::string& name, const std::string& path, uint32_t homeId = kDefaultHomeId);
+
+    // 포트 없이 원격 gateway가 TCP sensor 명령으로 센서 줄을 넘겨주는 디바이스 (명령은 보낼 수 없음)
+    void addRemoteDevice(const std::string& name, uint32_t homeId);
+
+    // 파싱된 샘플을 받을 저장소 (MySQL, 로컬 시계열 저장소 등, initializeDevices 전에 호출)
+    void addSink(SensorSink* sink);
+
+    // 파싱/DB 저장 worker 수와 worker별 큐 크기 (initializeDevices 전에 호출, 0이면 자동)
+    void setIngestWorkers(size_t workers, size_t queueCapacity = 4096);
 
-    // 포트 초기화 (open + non-blocking for read, blocking for write)
+    // 송신 대기열에 들어간 명령을 이 시간 안에 보내지 못하면 버리고 Timeout으로 완료
+    // 실행 중에도 바꿀 수 있음 (이후 대기열에 들어가는 명령부터 적용)
+    void setCommandTimeout(std::chrono::milliseconds timeout)
+    {
+        commandTimeoutMs.store(timeout.count(), std::memory_order_relaxed);
+    }
+
+    // 구동기 명령 debounce 간격과 상태 유지 시간 (실행 중에도 바꿀 수 있음)
+    void setActuatorOptions(const ActuatorOptions& options);
+
+    // 끊긴 포트 재연결 간격과 무응답 판정 시간 (initializeDevices 전에 호출)
+    void setSupervisorOptions(const DeviceSupervisorOptions& options) { supervisor.setOptions(options); }
+
+    // 포트 초기화 (open + termios + non-blocking) 후 worker 시작
+    // 열리지 않은 포트는 끊긴 상태로 두고 감시자가 다시 엶 (epoll/eventfd 생성 실패 시에만 false)
     bool initializeDevices();
 
-    // 데이터 수신 처리 (Non-blocking)
+    // 데이터 수신 + 송신 대기열 처리 + 끊긴 포트 감지 (Non-blocking, stop()까지 반환하지 않음)
     void processDataLoop();
 
-    // 데이터 송신 기능 추가
-    bool sendCommand(const std::string& deviceName, const std::string& command);
-    bool sendToAllDevices(const std::string& command);
+    // processDataLoop를 끝내고, 받은 줄을 worker가 모두 sink에 넘길 때까지 기다린 뒤 반환
+    // (대기 중이던 송신 명령은 마지막으로 한 번 보내 봄, 여러 번 불러도 됨)
+    void stop();
+
+    // 포트가 열려 있는 디바이스 수
+    size_t connectedDevices() const;
+
+    // 디바이스가 하나 이상 등록된 home 수
+    size_t homeCount() const { return homes.size(); }
+
+    // homeId의 디바이스 송신 대기열에 명령을 넣고 바로 반환 (실제 write는 processDataLoop가 처리)
+    // done은 포트에 끝까지 기록되거나 실패/기한 초과 시 한 번 호출됨 (false: 대기열에 넣지 못함)
+    // 구동기 명령(isActuatorCommand)은 디바이스별로 상태를 추적해서
+    // - 이미 그 상태이면(stateTtl 안에 같은 명령을 보냈고 대기 중인 상태 명령이 없음) 보내지 않고 바로 Sent
+    // - 마지막 상태 명령을 보낸 뒤 debounce 안에 온 명령은 그 간격이 끝날 때까지 대기열에서 기다리고,
+    //   그 사이 다른 상태 명령이 오면 기다리던 명령을 바꿈 (바뀐 명령의 done은 Superseded)
+    bool sendCommand(uint32_t homeId, const std::string& deviceName, const std::string& command,
+                     CommandCompletion done = nullptr);
+    // homeId의 모든 로컬 디바이스 대기열에 넣음 (done은 모두 끝난 뒤 첫 실패 결과 또는 Sent로 한 번 호출)
+    bool sendToAllDevices(uint32_t homeId, const std::string& command, CommandCompletion done = nullptr);
+
+    // TCP 명령을 명령 표에 따라 블루투스 명령으로 변환하여 command.homeId의 디바이스로 전송
+    void handleTCPCommand(const Command& command, CommandCompletion done = nullptr);
 
-    // TCP 명령을 블루투스 명령으로 변환하여 전송
-    void handleTCPCommand(const std::string& tcpCommand);
+    // 원격 gateway가 넘긴 센서 한 줄을 로컬 포트에서 읽은 줄과 같은 ingest 큐에 넣음
+    // TCP 이벤트 루프 스레드에서 호출 (대기하지 않음, 등록되지 않은 원격 디바이스면 NoDevice, 큐가 차면 Busy)
+    CommandResult submitRemoteLine(uint32_t homeId, std::string_view deviceName, std::string_view line);
+
+    // 디바이스의 구동기 상태 (TCP state 조회, 등록되지 않았거나 원격 디바이스면 false)
+    bool actuatorState(uint32_t homeId, std::string_view deviceName, ActuatorState& state);
+
+    const SensorParser& sensorParser() const { return parser; }
+    const IngestPipeline& ingestPipeline() const { return ingest; }
 
 private:
-    std::map<std::string, std::string> devices;       // 이름 -> 시리얼 경로
-    std::map<std::string, int> deviceFds;            // 이름 -> fd
-    std::mutex sendMutex;                            // 송신용 뮤텍스
+    // 송신 대기 중인 명령 하나
+    struct OutboundCommand
+    {
+        std::string bytes;                              // 명령 + 개행
+        size_t written = 0;                             // 이미 보낸 바이트 (부분 write 이어서 전송)
+        std::chrono::steady_clock::time_point queuedAt;
+        std::chrono::steady_clock::time_point notBefore;    // debounce: 이 시각 전에는 쓰지 않음
+        std::chrono::steady_clock::time_point deadline;
+        bool actuator = false;                          // 구동기 상태 명령
+        std::vector<CommandCompletion> waiters;         // 같은 명령이 합쳐지면 여러 개
+    };
+
+    // 디바이스 하나의 상태 (수신 버퍼도 디바이스가 직접 가짐)
+    struct Device
+    {
+        Device(uint32_t deviceIndex, uint32_t deviceHome, const std::string& deviceName,
+               const std::string& devicePath);
+
+        uint32_t index;             // devices 내 위치 (ingest 큐의 source 번호, 모든 home에서 유일)
+        uint32_t homeId;
+        std::string name;           // home 안에서 유일
+        std::string label;          // 로그용 이름 (기본 home이 아니면 "h<home>/<이름>")
+        std::string path;           // 비어 있으면 원격 디바이스
+        bool remote;                // 원격 gateway가 줄을 넘겨줌 (포트 없음)
+        int fd = -1;
+        RingBuffer input;           // 고정 크기 수신 링 버퍼
+        bool discarding = false;    // 오버플로우 후 다음 개행까지 버리는 중
+        std::string scratch;        // 랩어라운드된 줄 복사용
+        Counter& receivedLines;     // 디바이스별 수신 줄 수 (/metrics)
+        Counter& sentCommands;      // 디바이스별 송신 명령 수 (/metrics)
+        Counter& disconnects;       // 디바이스별 연결 끊김 수 (/metrics)
+
+        // 연결 상태 (fd와 upSince는 processDataLoop 스레드만, 나머지 스레드는 up/lastLineUs만 봄)
+        std::atomic<bool> up{false};
+        std::atomic<int64_t> lastLineUs{0};                 // 마지막으로 센서 줄을 받은 시각 (Unix epoch us)
+        std::chrono::steady_clock::time_point upSince;
+        int64_t upSinceUs = 0;
+
+        // 송신 대기열 (다른 스레드가 넣고 processDataLoop가 non-blocking write로 비움)
+        std::mutex outboundMutex;
+        std::deque<OutboundCommand> outbound;
+        bool writeWatched = false;  // EPOLLOUT 감시 중 (processDataLoop 스레드만 접근)
+        bool holding = false;       // 대기열 앞 명령이 debounce로 기다리는 중 (processDataLoop 스레드만 접근)
+
+        // 구동기 상태 (outboundMutex로 보호)
+        std::string confirmed;                              // 포트에 끝까지 기록된 마지막 상태 명령 (비어 있으면 모름)
+        std::chrono::steady_clock::time_point confirmedAt;
+        std::chrono::steady_clock::time_point releaseAt;    // 마지막 상태 명령을 내보낸 시각 (debounce 기준)
+    };
+
+    std::vector<std::unique_ptr<Device>> devices;    // epoll data.ptr로 Device* 사용
+    // home → 이름 → 디바이스 (initializeDevices 뒤에는 바뀌지 않아서 TCP 스레드에서도 락 없이 조회)
+    std::map<uint32_t, std::map<std::string, Device*, std::less<>>> homes;
+    int epollFd;
+    int wakeFd;                                      // 송신 대기열에 명령이 들어오면 epoll_wait를 깨우는 eventfd
+    std::atomic<bool> outboundPending;               // wakeFd를 이미 깨웠음 (중복 write 방지)
+    std::atomic<std::chrono::milliseconds::rep> commandTimeoutMs;
+    std::atomic<std::chrono::milliseconds::rep> debounceMs;
+    std::atomic<std::chrono::milliseconds::rep> stateTtlMs;
+
+    std::atomic<bool> stopRequested;                 // processDataLoop 종료 요청
+    std::mutex loopMutex;
+    std::condition_variable loopCv;
+    bool loopRunning;                                // processDataLoop 실행 중 (stop이 끝날 때까지 기다림)
+
+    DeviceSupervisor supervisor;                     // 끊긴 포트를 다시 여는 스레드
+    std::mutex openedMutex;
+    std::vector<std::pair<uint32_t, int>> openedPorts;   // 감시자가 새로 연 포트 (processDataLoop가 가져감)
+
+    SensorParser parser;                             // 센서 줄 파서 (거부된 줄 집계 포함)
+    IngestPipeline ingest;                           // 수신 스레드 → 파싱/DB worker
+
+    std::vector<SensorSink*> sinks;                  // 샘플 저장 대상 (소유하지 않음)
+
+    LatencyHistogram& handleLatency;                 // handleData (파싱 + sink 기록)
+    LatencyHistogram& sendLatency;                   // sendCommand ~ 포트에 끝까지 기록 (대기열 대기 포함)
+    Counter& sendFailures;
+    Counter& coalescedCommands;
+    Counter& expiredCommands;
+    Counter& suppressedCommands;
+    Counter& supersededCommands;
+
+    Device* findDevice(uint32_t homeId, std::string_view name);
+    Device* createDevice(const std::string& name, const std::string& path, uint32_t homeId);
+    void readDevice(Device& device);
+    void processCompleteLines(Device& device);
+    void processLine(const RawLine& line);
+    void handleData(const Device& device, int64_t timeUs, std::string_view rawData);
 
-    std::vector<std::string> split(const std::string& str, char delimiter);
-    void handleData(const std::string& rawData);
-    std::string convertTCPToBluetoothCommand(const std::string& tcpCommand);
+    void adoptPort(Device& device, int fd);
+    void adoptOpenedPorts();
+    void markDown(Device& device, const char* reason);
+    void checkLiveness(int64_t nowUs);
 
-    void processCompleteLines(const std::string& deviceName);
+    void wakeLoop();
+    OutboundCommand* pendingActuatorCommand(Device& device);
+    void flushDevice(Device& device);
+    int expireOutbound(std::chrono::steady_clock::time_point now);
+    void watchWritable(Device& device, bool watch);
 };
 
 #endif // BLUETOOTHMANAGER_H
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "CommandTable.h"
+#include "Home.h"
+#include <array>
+
+namespace
+{
+
+// TCP 명령 → {응답, 블루투스 명령, 대상 모듈, 바이너리 opcode}
+// 새 명령/디바이스는 여기에 한 행만 추가하면 됨 (verb 기준 사전순 정렬 유지)
+// Query/Stream 명령의 응답은 TCPServer가 만듦 (최신 값 캐시, 구독 등록)
+constexpr std::array<CommandSpec, 14> kCommands = {{
+    { "door_close",    "OK_COMMAND_RECEIVED\n", "CMD_DOOR_CLOSE", "doorModule",   Opcode::DoorClose    },
+    { "door_open",     "OK_COMMAND_RECEIVED\n", "CMD_DOOR_OPEN",  "doorModule",   Opcode::DoorOpen     },
+    { "get",           "",                      "",               "",             Opcode::Get,          CommandKind::Query },
+    { "home",          "",                      "",               "",             Opcode::Home,         CommandKind::Session },
+    { "light_off",     "OK_COMMAND_RECEIVED\n", "CMD_LIGHT_OFF",  "lightModule",  Opcode::LightOff     },
+    { "light_on",      "OK_COMMAND_RECEIVED\n", "CMD_LIGHT_ON",   "lightModule",  Opcode::LightOn      },
+    { "sensor",        "",                      "",               "",             Opcode::Sensor,       CommandKind::Ingest },
+    { "snapshot",      "",                      "",               "",             Opcode::Snapshot,     CommandKind::Query },
+    { "state",         "",                      "",               "",             Opcode::State,        CommandKind::Query },
+    { "subscribe",     "",                      "",               "",             Opcode::Subscribe,    CommandKind::Stream },
+    { "unsubscribe",   "",                      "",               "",             Opcode::Unsubscribe,  CommandKind::Stream },
+    { "window_close",  "OK_WINDOW_CLOSING\n",   "CLOSE",          "windowModule", Opcode::WindowClose  },
+    { "window_open",   "OK_WINDOW_OPENING\n",   "OPEN",           "windowModule", Opcode::WindowOpen   },
+    { "window_status", "OK_STATUS_REQUESTED\n", "",               "windowModule", Opcode::WindowStatus },
+}};
+
+constexpr bool isSorted()
+{
+    for (size_t i = 1; i < kCommands.size(); ++i)
+    {
+        if (!(kCommands[i - 1].verb < kCommands[i].verb))
+            return false;
+    }
+    return true;
+}
+
+static_assert(isSorted(), "kCommands must be sorted by verb without duplicates");
+
+// opcode → kCommands 번호 (-1: 없음)
+constexpr std::array<int8_t, 256> makeOpcodeIndex()
+{
+    std::array<int8_t, 256> index{};
+    for (size_t i = 0; i < index.size(); ++i)
+        index[i] = -1;
+    for (size_t i = 0; i < kCommands.size(); ++i)
+        index[static_cast<uint8_t>(kCommands[i].opcode)] = static_cast<int8_t>(i);
+    return index;
+}
+
+constexpr bool hasUniqueOpcodes()
+{
+    for (size_t i = 0; i < kCommands.size(); ++i)
+    {
+        if (kCommands[i].opcode == Opcode::None || kCommands[i].opcode == Opcode::Event)
+            return false;
+        for (size_t j = i + 1; j < kCommands.size(); ++j)
+        {
+            if (kCommands[i].opcode == kCommands[j].opcode)
+                return false;
+        }
+    }
+    return true;
+}
+
+static_assert(hasUniqueOpcodes(), "every command needs its own opcode");
+
+constexpr std::array<int8_t, 256> kOpcodeIndex = makeOpcodeIndex();
+
+constexpr bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && isSpace(text.front()))
+        text.remove_prefix(1);
+    while (!text.empty() && isSpace(text.back()))
+        text.remove_suffix(1);
+    return text;
+}
+
+} // namespace
+
+const CommandSpec* findCommand(std::string_view verb)
+{
+    size_t low = 0;
+    size_t high = kCommands.size();
+    while (low < high)
+    {
+        size_t mid = (low + high) / 2;
+        int cmp = kCommands[mid].verb.compare(verb);
+        if (cmp == 0)
+            return &kCommands[mid];
+        if (cmp < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return nullptr;
+}
+
+const CommandSpec* findCommand(Opcode opcode)
+{
+    int index = kOpcodeIndex[static_cast<uint8_t>(opcode)];
+    return index < 0 ? nullptr : &kCommands[index];
+}
+
+const char* commandResultName(CommandResult result)
+{
+    switch (result)
+    {
+    case CommandResult::Sent:     return "OK";
+    case CommandResult::Timeout:  return "ERR_TIMEOUT";
+    case CommandResult::Busy:     return "ERR_BUSY";
+    case CommandResult::NoDevice: return "ERR_NO_DEVICE";
+    case CommandResult::Failed:   return "ERR_SEND_FAILED";
+    case CommandResult::Superseded: return "ERR_SUPERSEDED";
+    }
+    return "ERR_SEND_FAILED";
+}
+
+bool isActuatorCommand(std::string_view btCommand)
+{
+    if (btCommand.empty())
+        return false;
+    for (const CommandSpec& spec : kCommands)
+    {
+        if (spec.kind == CommandKind::Device && !spec.device.empty() && spec.btCommand == btCommand)
+            return true;
+    }
+    return false;
+}
+
+Command parseCommand(std::string_view line)
+{
+    line = trim(line);
+
+    size_t end = 0;
+    while (end < line.size() && !isSpace(line[end]))
+        ++end;
+
+    Command command;
+    command.verb = line.substr(0, end);
+    command.args = trim(line.substr(end));
+    command.spec = findCommand(command.verb);
+    command.homeId = kDefaultHomeId;
+    command.requestId = 0;
+    return command;
+}
@@ -0,0 +1,105 @@
+#ifndef COMMANDTABLE_H
+#define COMMANDTABLE_H
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <cstdint>
+
+// 명령 처리 방식
+enum class CommandKind : uint8_t
+{
+    Device,     // 고정 응답 + 블루투스 명령 전송 (TCPServer 명령 콜백)
+    Query,      // 서버가 가진 값을 조회해서 응답 (블루투스 전송 없음)
+    Stream,     // 연결의 센서 업데이트 구독 시작/해제
+    Session,    // 연결 상태 변경 (명령/조회/구독 대상 home 선택)
+    Ingest      // 원격 gateway가 넘긴 센서 한 줄 (로컬 rfcomm 수신과 같은 ingest 경로)
+};
+
+// 바이너리 프로토콜의 명령 번호 (통신 규약이라 값을 바꾸거나 재사용하면 안 됨)
+enum class Opcode : uint8_t
+{
+    None         = 0x00,
+    WindowOpen   = 0x01,
+    WindowClose  = 0x02,
+    WindowStatus = 0x03,
+    LightOn      = 0x04,
+    LightOff     = 0x05,
+    DoorOpen     = 0x06,
+    DoorClose    = 0x07,
+    Get          = 0x20,
+    Snapshot     = 0x21,
+    State        = 0x22,
+    Subscribe    = 0x30,
+    Unsubscribe  = 0x31,
+    Home         = 0x40,
+    Sensor       = 0x50,
+    Event        = 0x80     // 서버 → 클라이언트 구독 업데이트 (요청에는 쓰지 않음)
+};
+
+// TCP 명령 한 줄에 대한 처리 정보 (CommandTable.cpp의 표에 한 행씩 등록)
+struct CommandSpec
+{
+    std::string_view verb;        // TCP 명령어 (예: "window_open")
+    std::string_view response;    // 클라이언트에 돌려줄 응답
+    std::string_view btCommand;   // 아두이노로 보낼 블루투스 명령 (비어 있으면 전송 안 함)
+    std::string_view device;      // 대상 모듈 이름 (비어 있으면 모든 디바이스로 전송)
+    Opcode opcode = Opcode::None; // 바이너리 프로토콜 명령 번호
+    CommandKind kind = CommandKind::Device;
+};
+
+// 한 번만 파싱된 TCP 명령
+// verb/args는 수신 버퍼를 가리키므로 명령 처리 중에만 유효
+// 바이너리 프레임도 같은 구조로 바꿔서 처리 (verb는 표의 verb, args는 payload)
+struct Command
+{
+    std::string_view verb;        // 첫 번째 토큰
+    std::string_view args;        // 나머지 (앞뒤 공백 제거)
+    const CommandSpec* spec;      // 등록되지 않은 명령이면 nullptr
+    uint32_t homeId;              // 대상 home (TCPServer가 연결에서 선택한 home으로 채움)
+    uint32_t requestId;           // 바이너리 요청 번호 (응답에 그대로 돌려줌, 텍스트 명령은 0)
+};
+
+// 블루투스 명령 전송 결과 (Device 명령은 결과가 나온 뒤에 클라이언트에 응답)
+enum class CommandResult : uint8_t
+{
+    Sent,           // 디바이스 포트에 끝까지 기록됨
+    Timeout,        // 기한 안에 기록하지 못함 (대기 중이던 명령은 보내지 않고 버림)
+    Busy,           // 디바이스 송신 대기열이 가득 참
+    NoDevice,       // 등록되지 않았거나 열리지 않은 디바이스
+    Failed,         // write 오류
+    Superseded      // 보내기 전에(debounce 중에) 같은 디바이스의 다른 상태 명령으로 바뀜
+};
+
+// 전송 결과를 받을 콜백 (정확히 한 번 호출: 바로 실패하면 요청한 스레드, 아니면 블루투스 수신 스레드)
+using CommandCompletion = std::function<void(CommandResult)>;
+
+// 실패 결과의 응답 코드 (예: "ERR_TIMEOUT")
+const char* commandResultName(CommandResult result);
+
+// 디바이스 구동기(창문, 조명, 문)의 상태 (state 조회 응답, BluetoothManager가 송신 대기열과 함께 관리)
+struct ActuatorState
+{
+    std::string commanded;          // 마지막으로 요청된 상태 명령 (대기 중이면 그 명령, 없으면 confirmed)
+    std::string confirmed;          // 포트에 끝까지 기록된 마지막 상태 명령 (비어 있으면 모름)
+    int64_t confirmedAgeMs = -1;    // confirmed를 기록한 뒤 지난 시간 (모르면 -1)
+    bool pending = false;           // 아직 보내지 않은 상태 명령이 대기열에 있음
+};
+
+// 상태를 바꾸는 명령인지 (표에서 대상 모듈이 정해진 블루투스 명령: OPEN, CMD_LIGHT_ON 등)
+// 같은 명령을 다시 보내도 상태가 같으므로 이미 그 상태면 보내지 않아도 됨
+bool isActuatorCommand(std::string_view btCommand);
+
+// 등록되지 않은 명령에 대한 기본 응답
+constexpr std::string_view kDefaultCommandResponse = "OK_COMMAND_RECEIVED\n";
+
+// 표에서 verb 검색 (정렬된 표 이진 탐색, 할당 없음)
+const CommandSpec* findCommand(std::string_view verb);
+
+// 바이너리 opcode로 검색 (256칸 색인, 등록되지 않은 opcode면 nullptr)
+const CommandSpec* findCommand(Opcode opcode);
+
+// 명령 한 줄을 verb/args로 나누고 표에서 찾음 (할당 없음)
+Command parseCommand(std::string_view line);
+
+#endif // COMMANDTABLE_H
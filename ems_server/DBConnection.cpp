@@ -0,0 +1,179 @@
+#include "DBConnection.h"
+#include <mysql/errmsg.h>
+#include "Logger.h"
+#include <cstring>
+
+PreparedInsert::PreparedInsert()
+    : m_stmt(nullptr), m_spec(nullptr), m_rows(0)
+{
+}
+
+PreparedInsert::~PreparedInsert()
+{
+    close();
+}
+
+bool PreparedInsert::prepare(MYSQL* conn, const InsertSpec& spec, size_t rows)
+{
+    close();
+
+    m_stmt = mysql_stmt_init(conn);
+    if (!m_stmt)
+    {
+        return false;
+    }
+    m_spec = &spec;
+    m_rows = rows;
+
+    // INSERT INTO table (columns) VALUES (?, ...), (?, ...), ...
+    std::string sql;
+    sql.reserve(64 + rows * (std::strlen(spec.placeholders) + 2));
+    sql += "INSERT INTO ";
+    sql += spec.table;
+    sql += " (";
+    sql += spec.columns;
+    sql += ") VALUES ";
+    for (size_t i = 0; i < rows; ++i)
+    {
+        if (i > 0)
+            sql += ", ";
+        sql += spec.placeholders;
+    }
+
+    if (mysql_stmt_prepare(m_stmt, sql.data(), sql.size()) != 0)
+    {
+        return false;
+    }
+
+    // staging 행 버퍼와 파라미터 배열은 여기서 한 번만 할당
+    m_staging.assign(rows * spec.rowSize, 0);
+    m_params.assign(rows * spec.paramsPerRow, MYSQL_BIND());
+    for (size_t i = 0; i < rows; ++i)
+    {
+        spec.bindRow(&m_params[i * spec.paramsPerRow], row(i));
+    }
+
+    return mysql_stmt_bind_param(m_stmt, m_params.data()) == 0;
+}
+
+void PreparedInsert::close()
+{
+    if (m_stmt)
+    {
+        mysql_stmt_close(m_stmt);
+        m_stmt = nullptr;
+    }
+}
+
+bool PreparedInsert::execute()
+{
+    return mysql_stmt_execute(m_stmt) == 0;
+}
+
+const char* PreparedInsert::error()
+{
+    return m_stmt ? mysql_stmt_error(m_stmt) : "statement not prepared";
+}
+
+unsigned int PreparedInsert::errorCode()
+{
+    return m_stmt ? mysql_stmt_errno(m_stmt) : 0;
+}
+
+DBConnection::DBConnection(const DBConfig& config)
+    : m_config(config), m_conn(nullptr)
+{
+}
+
+DBConnection::~DBConnection()
+{
+    close();
+}
+
+bool DBConnection::open()
+{
+    close();
+
+    m_conn = mysql_init(nullptr);
+    if (!m_conn)
+    {
+        LOG_ERROR("MySQL init 실패");
+        return false;
+    }
+
+    if (!mysql_real_connect(m_conn, m_config.host.c_str(), m_config.user.c_str(),
+                            m_config.password.c_str(), m_config.db.c_str(),
+                            m_config.port, nullptr, 0))
+    {
+        LOG_ERROR("MySQL 연결 실패: %s", mysql_error(m_conn));
+        mysql_close(m_conn);
+        m_conn = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void DBConnection::close()
+{
+    // statement는 연결보다 먼저 닫아야 함
+    m_statements.clear();
+
+    if (m_conn)
+    {
+        mysql_close(m_conn);
+        m_conn = nullptr;
+    }
+}
+
+bool DBConnection::reconnect()
+{
+    return open();
+}
+
+bool DBConnection::ping()
+{
+    return m_conn && mysql_ping(m_conn) == 0;
+}
+
+PreparedInsert* DBConnection::insertStatement(const InsertSpec& spec, size_t rows, unsigned int* errorCode)
+{
+    if (!m_conn)
+    {
+        if (errorCode)
+            *errorCode = CR_SERVER_GONE_ERROR;
+        return nullptr;
+    }
+
+    for (auto& cached : m_statements)
+    {
+        if (cached.spec == &spec && cached.rows == rows)
+        {
+            return cached.stmt.get();
+        }
+    }
+
+    std::unique_ptr<PreparedInsert> stmt(new PreparedInsert());
+    if (!stmt->prepare(m_conn, spec, rows))
+    {
+        // mysql_stmt_init 자체가 실패하면 statement 에러가 없으므로 연결의 에러를 사용
+        bool stmtError = stmt->errorCode() != 0;
+        unsigned int code = stmtError ? stmt->errorCode() : mysql_errno(m_conn);
+        LOG_ERROR("%s statement 준비 실패 (%u): %s", spec.table, code, stmtError ? stmt->error() : error());
+        if (errorCode)
+            *errorCode = code;
+        return nullptr;
+    }
+
+    m_statements.push_back(CachedStatement{&spec, rows, std::move(stmt)});
+    return m_statements.back().stmt.get();
+}
+
+const char* DBConnection::error()
+{
+    return m_conn ? mysql_error(m_conn) : "not connected";
+}
+
+bool DBConnection::isConnectionError(unsigned int code)
+{
+    return code == CR_SERVER_GONE_ERROR || code == CR_SERVER_LOST;
+}
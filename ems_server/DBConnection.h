@@ -0,0 +1,99 @@
+#ifndef DBCONNECTION_H
+#define DBCONNECTION_H
+
+#include <mysql/mysql.h>
+#include <string>
+#include <vector>
+#include <memory>
+
+// MySQL 접속 정보
+struct DBConfig
+{
+    std::string host;
+    std::string user;
+    std::string password;
+    std::string db;
+    unsigned int port = 3306;
+};
+
+// 다중 행 INSERT 형식 (테이블별로 하나씩 정적으로 정의)
+struct InsertSpec
+{
+    const char* table;
+    const char* columns;        // "a, b, c"
+    const char* placeholders;   // 한 행 분량, 예: "(?, ?, 1)"
+    size_t paramsPerRow;
+    size_t rowSize;             // 행 구조체 크기
+    void (*bindRow)(MYSQL_BIND* params, void* row);   // 행 필드를 파라미터에 연결
+};
+
+// rows개 행을 한 번에 넣는 prepared INSERT
+// 바인딩 버퍼(staging)는 prepare 시 한 번만 할당하고 재사용함
+class PreparedInsert
+{
+public:
+    PreparedInsert();
+    ~PreparedInsert();
+    PreparedInsert(const PreparedInsert&) = delete;
+    PreparedInsert& operator=(const PreparedInsert&) = delete;
+
+    bool prepare(MYSQL* conn, const InsertSpec& spec, size_t rows);
+    void close();
+
+    // staging 영역의 i번째 행 (호출자가 memcpy로 채움)
+    void* row(size_t i) { return m_staging.data() + i * m_spec->rowSize; }
+    size_t rows() const { return m_rows; }
+
+    bool execute();
+    const char* error();
+    unsigned int errorCode();
+
+private:
+    MYSQL_STMT* m_stmt;
+    const InsertSpec* m_spec;
+    size_t m_rows;
+    std::vector<unsigned char> m_staging;
+    std::vector<MYSQL_BIND> m_params;
+};
+
+// MySQL 연결 하나와 그 연결에 속한 prepared statement 캐시
+class DBConnection
+{
+public:
+    explicit DBConnection(const DBConfig& config);
+    ~DBConnection();
+    DBConnection(const DBConnection&) = delete;
+    DBConnection& operator=(const DBConnection&) = delete;
+
+    bool open();
+    void close();
+    bool isOpen() const { return m_conn != nullptr; }
+
+    // 연결을 다시 맺고 statement 캐시를 비움 (다음 사용 시 재준비)
+    bool reconnect();
+
+    // 연결 상태 확인 (mysql_ping)
+    bool ping();
+
+    // rows개 행용 INSERT (처음 요청 시에만 prepare, 실패하면 nullptr와 errorCode에 MySQL 에러 코드)
+    PreparedInsert* insertStatement(const InsertSpec& spec, size_t rows, unsigned int* errorCode = nullptr);
+
+    const char* error();
+
+    // 연결이 끊어져서 재접속이 필요한 에러 코드인지
+    static bool isConnectionError(unsigned int code);
+
+private:
+    struct CachedStatement
+    {
+        const InsertSpec* spec;
+        size_t rows;
+        std::unique_ptr<PreparedInsert> stmt;
+    };
+
+    DBConfig m_config;
+    MYSQL* m_conn;
+    std::vector<CachedStatement> m_statements;
+};
+
+#endif // DBCONNECTION_H
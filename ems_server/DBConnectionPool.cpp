@@ -0,0 +1,304 @@
+#include "DBConnectionPool.h"
+#include "Logger.h"
+#include <algorithm>
+
+DBConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : m_pool(other.m_pool), m_slot(other.m_slot)
+{
+    other.m_pool = nullptr;
+    other.m_slot = nullptr;
+}
+
+DBConnectionPool::Lease& DBConnectionPool::Lease::operator=(Lease&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        m_pool = other.m_pool;
+        m_slot = other.m_slot;
+        other.m_pool = nullptr;
+        other.m_slot = nullptr;
+    }
+    return *this;
+}
+
+DBConnection* DBConnectionPool::Lease::operator->() const
+{
+    return m_slot->conn.get();
+}
+
+void DBConnectionPool::Lease::markBroken()
+{
+    if (m_slot)
+    {
+        m_pool->release(m_slot, true);
+        m_pool = nullptr;
+        m_slot = nullptr;
+    }
+}
+
+void DBConnectionPool::Lease::release()
+{
+    if (m_slot)
+    {
+        m_pool->release(m_slot, false);
+        m_pool = nullptr;
+        m_slot = nullptr;
+    }
+}
+
+DBConnectionPool::DBConnectionPool()
+    : m_stopping(false),
+      m_acquires(0),
+      m_acquireTimeouts(0),
+      m_reconnects(0),
+      m_reconnectFailures(0),
+      m_totalWaitUs(0),
+      m_maxWaitUs(0)
+{
+}
+
+DBConnectionPool::~DBConnectionPool()
+{
+    stop();
+}
+
+bool DBConnectionPool::start(const DBConfig& config, const DBPoolOptions& options)
+{
+    m_options = options;
+    if (m_options.size == 0)
+        m_options.size = 1;
+
+    size_t opened = 0;
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < m_options.size; ++i)
+    {
+        std::unique_ptr<Slot> slot(new Slot());
+        slot->conn.reset(new DBConnection(config));
+        slot->lastUsed = now;
+        slot->healthy = slot->conn->open();
+        if (slot->healthy)
+        {
+            ++opened;
+        }
+        else
+        {
+            scheduleRetry(*slot);
+        }
+        m_slots.push_back(std::move(slot));
+    }
+
+    if (opened == 0 && m_options.requireConnection)
+    {
+        m_slots.clear();
+        return false;
+    }
+
+    m_stopping = false;
+    m_maintenanceThread = std::thread(&DBConnectionPool::maintenanceLoop, this);
+    return true;
+}
+
+void DBConnectionPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_maintenanceCv.notify_all();
+    m_availableCv.notify_all();
+
+    if (m_maintenanceThread.joinable())
+    {
+        m_maintenanceThread.join();
+    }
+}
+
+DBConnectionPool::Lease DBConnectionPool::acquire()
+{
+    auto begin = std::chrono::steady_clock::now();
+    Slot* found = nullptr;
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_availableCv.wait_for(lock, m_options.acquireTimeout, [&] {
+            if (m_stopping)
+                return true;
+            for (auto& slot : m_slots)
+            {
+                if (slot->healthy && !slot->inUse)
+                {
+                    found = slot.get();
+                    return true;
+                }
+            }
+            return false;
+        });
+
+        if (found)
+        {
+            found->inUse = true;
+        }
+    }
+
+    uint64_t waitUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - begin).count();
+    m_totalWaitUs.fetch_add(waitUs, std::memory_order_relaxed);
+    if (waitUs > m_maxWaitUs.load(std::memory_order_relaxed))
+    {
+        m_maxWaitUs.store(waitUs, std::memory_order_relaxed);
+    }
+
+    if (!found)
+    {
+        m_acquireTimeouts.fetch_add(1, std::memory_order_relaxed);
+        return Lease();
+    }
+
+    m_acquires.fetch_add(1, std::memory_order_relaxed);
+    return Lease(this, found);
+}
+
+void DBConnectionPool::release(Slot* slot, bool broken)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        slot->inUse = false;
+        slot->lastUsed = std::chrono::steady_clock::now();
+        if (broken)
+        {
+            slot->healthy = false;
+            slot->backoff = std::chrono::milliseconds(0);
+            scheduleRetry(*slot);
+        }
+    }
+
+    if (broken)
+        m_maintenanceCv.notify_one();
+    else
+        m_availableCv.notify_one();
+}
+
+// 재접속 시도 시각 계산 (실패할 때마다 대기 시간 2배, 최대값 제한)
+void DBConnectionPool::scheduleRetry(Slot& slot)
+{
+    if (slot.backoff.count() == 0)
+        slot.backoff = m_options.reconnectBackoffMin;
+    else
+        slot.backoff = std::min(slot.backoff * 2, m_options.reconnectBackoffMax);
+
+    slot.nextRetry = std::chrono::steady_clock::now() + slot.backoff;
+}
+
+// 끊어진 연결 재접속 + 유휴 연결 health check
+void DBConnectionPool::maintenanceLoop()
+{
+    // 관리 스레드도 연결을 직접 사용하므로 스레드별 초기화 필요
+    mysql_thread_init();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping)
+    {
+        auto now = std::chrono::steady_clock::now();
+        auto wakeAt = now + m_options.healthCheckInterval;
+
+        for (auto& slotPtr : m_slots)
+        {
+            Slot& slot = *slotPtr;
+            if (slot.inUse)
+                continue;
+
+            if (!slot.healthy)
+            {
+                if (slot.nextRetry > now)
+                {
+                    wakeAt = std::min(wakeAt, slot.nextRetry);
+                    continue;
+                }
+
+                // 재접속 중에는 다른 스레드가 가져가지 못하게 예약
+                slot.inUse = true;
+                lock.unlock();
+                bool ok = slot.conn->reconnect();
+                lock.lock();
+                slot.inUse = false;
+
+                if (ok)
+                {
+                    slot.healthy = true;
+                    slot.backoff = std::chrono::milliseconds(0);
+                    slot.lastUsed = std::chrono::steady_clock::now();
+                    m_reconnects.fetch_add(1, std::memory_order_relaxed);
+                    LOG_INFO("MySQL 재연결 성공");
+                    m_availableCv.notify_all();
+                }
+                else
+                {
+                    m_reconnectFailures.fetch_add(1, std::memory_order_relaxed);
+                    scheduleRetry(slot);
+                    wakeAt = std::min(wakeAt, slot.nextRetry);
+                }
+            }
+            else if (now - slot.lastUsed >= m_options.healthCheckInterval)
+            {
+                slot.inUse = true;
+                lock.unlock();
+                bool alive = slot.conn->ping();
+                lock.lock();
+                slot.inUse = false;
+                slot.lastUsed = std::chrono::steady_clock::now();
+
+                if (!alive)
+                {
+                    LOG_WARN("MySQL 연결 끊김 감지: %s", slot.conn->error());
+                    slot.healthy = false;
+                    slot.backoff = std::chrono::milliseconds(0);
+                    scheduleRetry(slot);
+                    wakeAt = std::min(wakeAt, slot.nextRetry);
+                }
+                else
+                {
+                    m_availableCv.notify_one();
+                }
+            }
+            else
+            {
+                wakeAt = std::min(wakeAt, slot.lastUsed + m_options.healthCheckInterval);
+            }
+        }
+
+        m_maintenanceCv.wait_until(lock, wakeAt);
+    }
+
+    lock.unlock();
+    mysql_thread_end();
+}
+
+DBPoolStats DBConnectionPool::stats() const
+{
+    DBPoolStats s;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        s.size = m_slots.size();
+        for (auto& slot : m_slots)
+        {
+            if (slot->inUse)
+                ++s.inUse;
+            else if (slot->healthy)
+                ++s.idle;
+            else
+                ++s.broken;
+        }
+    }
+    s.acquires          = m_acquires.load(std::memory_order_relaxed);
+    s.acquireTimeouts   = m_acquireTimeouts.load(std::memory_order_relaxed);
+    s.reconnects        = m_reconnects.load(std::memory_order_relaxed);
+    s.reconnectFailures = m_reconnectFailures.load(std::memory_order_relaxed);
+    uint64_t attempts = s.acquires + s.acquireTimeouts;
+    if (attempts > 0)
+    {
+        s.avgWaitMs = m_totalWaitUs.load(std::memory_order_relaxed) / 1000.0 / attempts;
+    }
+    s.maxWaitMs = m_maxWaitUs.load(std::memory_order_relaxed) / 1000.0;
+    return s;
+}
@@ -0,0 +1,116 @@
+#ifndef DBCONNECTIONPOOL_H
+#define DBCONNECTIONPOOL_H
+
+#include "DBConnection.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// 커넥션 풀 설정
+struct DBPoolOptions
+{
+    size_t size = 5;                                        // 연결 수 (테이블 수만큼이면 모든 테이블 병렬 기록)
+    std::chrono::milliseconds acquireTimeout{2000};         // 빈 연결을 기다리는 최대 시간
+    std::chrono::milliseconds healthCheckInterval{30000};   // 유휴 연결 ping 주기
+    std::chrono::milliseconds reconnectBackoffMin{200};     // 재접속 대기 시작값
+    std::chrono::milliseconds reconnectBackoffMax{30000};   // 재접속 대기 최대값 (지수 증가)
+    bool requireConnection = true;                          // false면 연결을 하나도 열지 못해도 시작 (관리 스레드가 재접속)
+};
+
+// 커넥션 풀 상태 (모니터링용)
+struct DBPoolStats
+{
+    size_t size = 0;
+    size_t idle = 0;                    // 사용 가능한 연결 수
+    size_t inUse = 0;                   // 사용 중인 연결 수
+    size_t broken = 0;                  // 재접속 대기 중인 연결 수
+    uint64_t acquires = 0;              // 연결 획득 횟수
+    uint64_t acquireTimeouts = 0;       // 시간 초과로 획득 실패한 횟수
+    uint64_t reconnects = 0;            // 재접속 성공 횟수
+    uint64_t reconnectFailures = 0;     // 재접속 실패 횟수
+    double avgWaitMs = 0.0;             // 평균 획득 대기 시간
+    double maxWaitMs = 0.0;             // 최대 획득 대기 시간
+};
+
+// 고정 크기 MySQL 커넥션 풀
+// 끊어진 연결은 백그라운드 스레드가 지수 백오프로 재접속하고, 유휴 연결은 주기적으로 ping
+class DBConnectionPool
+{
+private:
+    struct Slot;
+
+public:
+    // 획득한 연결 (소멸 시 풀에 반납)
+    class Lease
+    {
+    public:
+        Lease() : m_pool(nullptr), m_slot(nullptr) {}
+        Lease(DBConnectionPool* pool, Slot* slot) : m_pool(pool), m_slot(slot) {}
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease() { release(); }
+
+        explicit operator bool() const { return m_slot != nullptr; }
+        DBConnection* operator->() const;
+
+        // 연결 에러 발생 시 호출하면 반납 후 재접속 대상이 됨
+        void markBroken();
+        void release();
+
+    private:
+        DBConnectionPool* m_pool;
+        Slot* m_slot;
+    };
+
+    DBConnectionPool();
+    ~DBConnectionPool();
+    DBConnectionPool(const DBConnectionPool&) = delete;
+    DBConnectionPool& operator=(const DBConnectionPool&) = delete;
+
+    // 연결을 모두 열고 관리 스레드 시작 (하나도 열지 못하면 false, requireConnection이 false면 계속 재접속)
+    bool start(const DBConfig& config, const DBPoolOptions& options);
+    void stop();
+
+    // 사용 가능한 연결을 acquireTimeout까지 기다려서 획득
+    Lease acquire();
+
+    DBPoolStats stats() const;
+
+private:
+    struct Slot
+    {
+        std::unique_ptr<DBConnection> conn;
+        bool inUse = false;
+        bool healthy = false;
+        std::chrono::steady_clock::time_point lastUsed;
+        std::chrono::steady_clock::time_point nextRetry;
+        std::chrono::milliseconds backoff{0};
+    };
+
+    void release(Slot* slot, bool broken);
+    void maintenanceLoop();
+    void scheduleRetry(Slot& slot);
+
+    DBPoolOptions m_options;
+    std::vector<std::unique_ptr<Slot>> m_slots;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_availableCv;      // 연결 반납/복구 알림
+    std::condition_variable m_maintenanceCv;    // 관리 스레드 깨우기
+    bool m_stopping;
+    std::thread m_maintenanceThread;
+
+    std::atomic<uint64_t> m_acquires;
+    std::atomic<uint64_t> m_acquireTimeouts;
+    std::atomic<uint64_t> m_reconnects;
+    std::atomic<uint64_t> m_reconnectFailures;
+    std::atomic<uint64_t> m_totalWaitUs;
+    std::atomic<uint64_t> m_maxWaitUs;
+};
+
+#endif // DBCONNECTIONPOOL_H
@@ -1,18 +1,153 @@
 #include "DBManager.h"
+#include "Logger.h"
+#include "ServerConfig.h"
 #include <iostream>
-#include <sstream>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+
+void bindParam(MYSQL_BIND& param, enum_field_types type, void* buffer)
+{
+    std::memset(&param, 0, sizeof(param));
+    param.buffer_type = type;
+    param.buffer = buffer;
+}
+
+void bindText(MYSQL_BIND& param, char* buffer, unsigned long* length)
+{
+    bindParam(param, MYSQL_TYPE_STRING, buffer);
+    param.buffer_length = kRowTextSize;
+    param.length = length;
+}
+
+void bindHomeRow(MYSQL_BIND* params, void* ptr)
+{
+    HomeRow* row = static_cast<HomeRow*>(ptr);
+    bindParam(params[0], MYSQL_TYPE_FLOAT, &row->temperature);
+    bindParam(params[1], MYSQL_TYPE_FLOAT, &row->humidity);
+    bindParam(params[2], MYSQL_TYPE_FLOAT, &row->illumination);
+    bindParam(params[3], MYSQL_TYPE_LONG, &row->homeId);
+}
+
+void bindFireRow(MYSQL_BIND* params, void* ptr)
+{
+    FireRow* row = static_cast<FireRow*>(ptr);
+    bindParam(params[0], MYSQL_TYPE_LONG, &row->fireData);
+    bindText(params[1], row->fireState, &row->fireStateLen);
+    bindParam(params[2], MYSQL_TYPE_FLOAT, &row->gasData);
+    bindText(params[3], row->gasState, &row->gasStateLen);
+    bindParam(params[4], MYSQL_TYPE_LONG, &row->homeId);
+}
+
+void bindPetRow(MYSQL_BIND* params, void* ptr)
+{
+    PetRow* row = static_cast<PetRow*>(ptr);
+    bindText(params[0], row->food, &row->foodLen);
+    bindText(params[1], row->water, &row->waterLen);
+    bindText(params[2], row->toilet, &row->toiletLen);
+    bindParam(params[3], MYSQL_TYPE_LONG, &row->homeId);
+}
+
+void bindPlantRow(MYSQL_BIND* params, void* ptr)
+{
+    PlantRow* row = static_cast<PlantRow*>(ptr);
+    bindParam(params[0], MYSQL_TYPE_FLOAT, &row->temp);
+    bindParam(params[1], MYSQL_TYPE_FLOAT, &row->soil);
+    bindParam(params[2], MYSQL_TYPE_FLOAT, &row->light);
+    bindParam(params[3], MYSQL_TYPE_FLOAT, &row->humi);
+    bindParam(params[4], MYSQL_TYPE_LONG, &row->homeId);
+}
+
+void bindAggregateRow(MYSQL_BIND* params, void* ptr)
+{
+    AggregateRow* row = static_cast<AggregateRow*>(ptr);
+    bindText(params[0], row->device, &row->deviceLen);
+    bindText(params[1], row->field, &row->fieldLen);
+    bindParam(params[2], MYSQL_TYPE_LONGLONG, &row->windowSeconds);
+    bindParam(params[3], MYSQL_TYPE_LONGLONG, &row->windowStartMs);
+    bindParam(params[4], MYSQL_TYPE_LONG, &row->sampleCount);
+    bindParam(params[5], MYSQL_TYPE_DOUBLE, &row->minValue);
+    bindParam(params[6], MYSQL_TYPE_DOUBLE, &row->maxValue);
+    bindParam(params[7], MYSQL_TYPE_DOUBLE, &row->meanValue);
+    bindParam(params[8], MYSQL_TYPE_DOUBLE, &row->lastValue);
+    bindParam(params[9], MYSQL_TYPE_LONG, &row->homeId);
+}
+
+const InsertSpec kHomeInsert = {
+    "home_env", "temperature, humidity, illumination, home_id",
+    "(?, ?, ?, ?)", 4, sizeof(HomeRow), &bindHomeRow
+};
+
+const InsertSpec kFireInsert = {
+    "fire_events", "fire_level, fire_status, level, level_status, home_id",
+    "(?, ?, ?, ?, ?)", 5, sizeof(FireRow), &bindFireRow
+};
+
+const InsertSpec kPetInsert = {
+    "pet_status", "food, water, toilet, home_id",
+    "(?, ?, ?, ?)", 4, sizeof(PetRow), &bindPetRow
+};
+
+const InsertSpec kPlantInsert = {
+    "plant_env", "temperature, soil_moisture, illumination, humidity, home_id",
+    "(?, ?, ?, ?, ?)", 5, sizeof(PlantRow), &bindPlantRow
+};
+
+const InsertSpec kAggregateInsert = {
+    "sensor_aggregates",
+    "device, metric, window_sec, window_start_ms, sample_count, min_value, max_value, mean_value, last_value, home_id",
+    "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", 10, sizeof(AggregateRow), &bindAggregateRow
+};
+
+// n 이하의 가장 큰 2의 거듭제곱
+size_t floorPowerOfTwo(size_t n)
+{
+    size_t p = 1;
+    while (p * 2 <= n)
+        p *= 2;
+    return p;
+}
+
+} // namespace
 
 DBManager::DBManager()
-    : m_conn(nullptr)
+    : m_stopping(false),
+      m_homeQueue(kHomeInsert),
+      m_fireQueue(kFireInsert),
+      m_petQueue(kPetInsert),
+      m_plantQueue(kPlantInsert),
+      m_aggregateQueue(kAggregateInsert),
+      m_enqueuedRows(0),
+      m_droppedRows(0),
+      m_writtenRows(0),
+      m_failedRows(0),
+      m_flushCount(0),
+      m_lastFlushUs(0),
+      m_maxFlushUs(0),
+      m_totalFlushUs(0)
 {
+    registerMetrics();
 }
 
 DBManager::~DBManager()
 {
-    if (m_conn)
-    {
-        mysql_close(m_conn);
-    }
+    shutdown();
+}
+
+void DBManager::configure(const DBWriteOptions& options)
+{
+    m_options = options;
+    if (m_options.batchSize == 0)
+        m_options.batchSize = 1;
+    if (m_options.queueCapacity == 0)
+        m_options.queueCapacity = 1;
+}
+
+void DBManager::configurePool(const DBPoolOptions& options)
+{
+    m_poolOptions = options;
 }
 
 bool DBManager::connect(const std::string& host,
@@ -21,77 +156,662 @@ bool DBManager::connect(const std::string& host,
                         const std::string& db,
                         unsigned int port)
 {
-    m_conn = mysql_init(nullptr);
-    if (!m_conn)
+    DBConfig config;
+    config.host = host;
+    config.user = user;
+    config.password = password;
+    config.db = db;
+    config.port = port;
+
+    // spool을 쓰면 MySQL이 꺼져 있어도 시작 (행은 spool에 쌓였다가 재접속되면 기록됨)
+    DBPoolOptions poolOptions = m_poolOptions;
+    if (!m_options.spool.directory.empty())
+        poolOptions.requireConnection = false;
+
+    if (!m_pool.start(config, poolOptions))
     {
-        std::cerr << "MySQL init 실패" << std::endl;
         return false;
     }
 
-    if (!mysql_real_connect(m_conn, host.c_str(), user.c_str(), password.c_str(),
-                            db.c_str(), port, nullptr, 0))
-    {
-        std::cerr << "MySQL 연결 실패: " << mysql_error(m_conn) << std::endl;
+    DBPoolStats pool = m_pool.stats();
+    if (pool.idle == 0)
+        LOG_WARN("MySQL 연결 실패 - spool에 기록하고 재접속되면 이어서 기록");
+    else
+        std::cout << "MySQL 연결 성공 (커넥션 풀 " << pool.idle << "/" << pool.size << ")" << std::endl;
+
+    // 테이블별 배치 쓰기 스레드 시작
+    startFlushers();
+    return true;
+}
+
+bool DBManager::connect(std::shared_ptr<BatchWriter> writer)
+{
+    if (!writer)
         return false;
-    }
 
-    std::cout << "MySQL 연결 성공" << std::endl;
+    m_writer = std::move(writer);
+    startFlushers();
     return true;
 }
 
-void DBManager::insertHomeData(float temperature, float humidity, float illumination)
+void DBManager::startFlushers()
+{
+    openSpools();
+    startFlusher(m_homeQueue);
+    startFlusher(m_fireQueue);
+    startFlusher(m_petQueue);
+    startFlusher(m_plantQueue);
+    startFlusher(m_aggregateQueue);
+
+    if (!m_options.spool.directory.empty() && !m_syncThread.joinable())
+        m_syncThread = std::thread(&DBManager::syncLoop, this);
+}
+
+// 테이블마다 spool을 열고 지난 실행에서 남은 행을 찾음 (열지 못한 테이블은 메모리 큐 사용)
+void DBManager::openSpools()
 {
-    std::lock_guard<std::mutex> lock(mtx);
-    std::ostringstream oss;
-    oss << "INSERT INTO home_env (temperature, humidity, illumination, home_id) VALUES ("
-        << temperature << ", " << humidity << ", " << illumination << ", 1);";
+    if (m_options.spool.directory.empty())
+        return;
+
+    forEachQueue([this](auto& queue) {
+        if (queue.spool)
+            return;
+        queue.spool.reset(new RowSpool(queue.spec.table, queue.spec.rowSize));
+        if (!queue.spool->open(m_options.spool))
+        {
+            LOG_ERROR("%s spool을 열지 못해 메모리 큐로 기록", queue.spec.table);
+            queue.spool.reset();
+            return;
+        }
+        queue.firstPending = std::chrono::steady_clock::now();
+    });
+}
 
-    if (mysql_query(m_conn, oss.str().c_str()))
+// group commit: syncInterval 동안 추가된 레코드를 테이블마다 msync 한 번으로 디스크에 내림
+// 기록된 위치(ack)도 여기서 파일에 남기고 다 기록된 세그먼트를 지움
+void DBManager::syncLoop()
+{
+    std::unique_lock<std::mutex> lock(m_syncMutex);
+    while (!m_stopping)
     {
-        std::cerr << "insertHomeData 실패: " << mysql_error(m_conn) << std::endl;
+        m_syncCv.wait_for(lock, m_options.spool.syncInterval, [this] { return m_stopping.load(); });
+        lock.unlock();
+        forEachQueue([](auto& queue) {
+            if (queue.spool)
+                queue.spool->sync();
+        });
+        lock.lock();
     }
 }
 
-void DBManager::insertFireData(const std::string& fireState, int fireData,
-                               const std::string& gasState, float gasData)
+void DBManager::shutdown(std::chrono::milliseconds timeout)
 {
-    std::lock_guard<std::mutex> lock(mtx);
-    std::ostringstream oss;
-    oss << "INSERT INTO fire_events (fire_level, fire_status, level, level_status, home_id) VALUES ("
-        << fireData << ", '" << fireState << "', "
-        << gasData << ", '" << gasState << "', 1);";
+    if (m_stopping)
+        return;
+    m_shutdownDeadline = std::chrono::steady_clock::now() + timeout;
+    m_stopping = true;
+
+    // 모든 flush 스레드를 먼저 깨워서 남은 행을 테이블끼리 병렬로 기록
+    forEachQueue([](auto& queue) {
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+        }
+        queue.cv.notify_all();
+    });
+
+    stopFlusher(m_homeQueue);
+    stopFlusher(m_fireQueue);
+    stopFlusher(m_petQueue);
+    stopFlusher(m_plantQueue);
+    stopFlusher(m_aggregateQueue);
 
-    if (mysql_query(m_conn, oss.str().c_str()))
     {
-        std::cerr << "insertFireData 실패: " << mysql_error(m_conn) << std::endl;
+        std::lock_guard<std::mutex> lock(m_syncMutex);
     }
+    m_syncCv.notify_all();
+    if (m_syncThread.joinable())
+        m_syncThread.join();
+
+    // 마지막 msync와 ack 기록 (기록하지 못한 행은 다음 시작 때 spool에서 다시 읽음)
+    forEachQueue([](auto& queue) {
+        if (queue.spool)
+            queue.spool->close();
+    });
+
+    m_pool.stop();
+}
+
+void DBManager::insertHomeData(float temperature, float humidity, float illumination, uint32_t homeId)
+{
+    enqueue(m_homeQueue, HomeRow{temperature, humidity, illumination, static_cast<int>(homeId)});
+}
+
+void DBManager::insertFireData(const std::string& fireState, int fireData,
+                               const std::string& gasState, float gasData, uint32_t homeId)
+{
+    FireRow row;
+    row.fireData = fireData;
+    row.gasData = gasData;
+    copyRowText(row.fireState, row.fireStateLen, fireState);
+    copyRowText(row.gasState, row.gasStateLen, gasState);
+    row.homeId = static_cast<int>(homeId);
+    enqueue(m_fireQueue, row);
 }
 
 void DBManager::insertPetData(const std::string& foodData,
                               const std::string& waterData,
-                              const std::string& toiletState)
+                              const std::string& toiletState, uint32_t homeId)
+{
+    PetRow row;
+    copyRowText(row.food, row.foodLen, foodData);
+    copyRowText(row.water, row.waterLen, waterData);
+    copyRowText(row.toilet, row.toiletLen, toiletState);
+    row.homeId = static_cast<int>(homeId);
+    enqueue(m_petQueue, row);
+}
+
+void DBManager::insertPlantData(float soilData, float tempData, float humiData, float lightData, uint32_t homeId)
+{
+    enqueue(m_plantQueue, PlantRow{soilData, tempData, humiData, lightData, static_cast<int>(homeId)});
+}
+
+void DBManager::write(uint32_t homeId, std::string_view device, int64_t timeUs, const SensorSample& sample)
+{
+    (void)device;
+    (void)timeUs;       // 테이블의 기록 시각은 DB 기본값 사용
+
+    if (const FireSample* fire = std::get_if<FireSample>(&sample))
+    {
+        // 조건에 따라 상태값 설정 (기준은 설정 파일의 alarm.*)
+        const AlarmThresholds& alarm = RuntimeConfig::instance().current().alarm;
+        std::string fireState = alarm.isFire(fire->fireData) ? "화재" : "정상";
+        std::string gasState  = alarm.isGas(fire->gasData) ? "위험" : "정상";
+
+        insertFireData(fireState, fire->fireData, gasState, fire->gasData, homeId);
+    }
+    else if (const PetSample* pet = std::get_if<PetSample>(&sample))
+    {
+        // 조건에 따라 상태 문자열 변환
+        std::string foodData    = (pet->food == 1) ? "충분" : "부족";
+        std::string waterData   = (pet->water == 1) ? "충분" : "부족";
+        std::string toiletState = (pet->toilet == 0) ? "깨끗함" : "청소 필요";
+
+        insertPetData(foodData, waterData, toiletState, homeId);
+    }
+    else if (const PlantSample* plant = std::get_if<PlantSample>(&sample))
+    {
+        insertPlantData(plant->soil, plant->temp, plant->humi, plant->light, homeId);
+        insertHomeData(plant->temp, plant->humi, plant->light, homeId);
+    }
+}
+
+void DBManager::writeAggregate(const WindowAggregate& aggregate)
+{
+    AggregateRow row;
+    copyRowText(row.device, row.deviceLen, aggregate.device);
+    copyRowText(row.field, row.fieldLen, aggregate.field);
+    row.windowSeconds = aggregate.windowSeconds;
+    row.windowStartMs = aggregate.startUs / 1000;
+    row.sampleCount = static_cast<int>(aggregate.count);
+    row.minValue = aggregate.min;
+    row.maxValue = aggregate.max;
+    row.meanValue = aggregate.mean;
+    row.lastValue = aggregate.last;
+    row.homeId = static_cast<int>(aggregate.homeId);
+    enqueue(m_aggregateQueue, row);
+}
+
+DBWriteStats DBManager::stats() const
+{
+    DBWriteStats s;
+    s.queueDepth   = queueDepth(m_homeQueue) + queueDepth(m_fireQueue) +
+                     queueDepth(m_petQueue) + queueDepth(m_plantQueue) + queueDepth(m_aggregateQueue);
+    s.enqueuedRows = m_enqueuedRows.load(std::memory_order_relaxed);
+    s.droppedRows  = m_droppedRows.load(std::memory_order_relaxed);
+    s.writtenRows  = m_writtenRows.load(std::memory_order_relaxed);
+    s.failedRows   = m_failedRows.load(std::memory_order_relaxed);
+    s.flushCount   = m_flushCount.load(std::memory_order_relaxed);
+    s.lastFlushMs  = m_lastFlushUs.load(std::memory_order_relaxed) / 1000.0;
+    s.maxFlushMs   = m_maxFlushUs.load(std::memory_order_relaxed) / 1000.0;
+    if (s.flushCount > 0)
+    {
+        s.avgFlushMs = m_totalFlushUs.load(std::memory_order_relaxed) / 1000.0 / s.flushCount;
+    }
+    forEachQueue([&s](auto& queue) {
+        if (!queue.spool)
+            return;
+        SpoolStats spool = queue.spool->stats();
+        s.spoolBacklog += spool.backlogRows;
+        s.spoolBytes += spool.bytes;
+        s.droppedRows += spool.droppedRows;
+    });
+    return s;
+}
+
+DBPoolStats DBManager::poolStats() const
+{
+    return m_pool.stats();
+}
+
+// 쓰기 큐/커넥션 풀 통계를 /metrics에 노출 (수집할 때만 읽음)
+void DBManager::registerMetrics()
+{
+    Metrics& metrics = Metrics::instance();
+    auto relaxed = [](const std::atomic<uint64_t>& value) {
+        return [&value] { return static_cast<double>(value.load(std::memory_order_relaxed)); };
+    };
+
+    metrics.counterFn("ems_db_enqueued_rows_total", "쓰기 큐에 들어온 행 수", "", relaxed(m_enqueuedRows));
+    metrics.counterFn("ems_db_dropped_rows_total", "백프레셔로 버려진 행 수", "", relaxed(m_droppedRows));
+    metrics.counterFn("ems_db_written_rows_total", "DB에 기록된 행 수", "", relaxed(m_writtenRows));
+    metrics.counterFn("ems_db_failed_rows_total", "INSERT 실패로 잃은 행 수", "", relaxed(m_failedRows));
+    metrics.counterFn("ems_db_flushes_total", "실행된 배치 INSERT 수", "", relaxed(m_flushCount));
+
+    metrics.gauge("ems_db_queue_depth", "테이블 큐(또는 spool)에 대기 중인 행 수", "table=\"home_env\"",
+                  [this] { return static_cast<double>(queueDepth(m_homeQueue)); });
+    metrics.gauge("ems_db_queue_depth", "테이블 큐(또는 spool)에 대기 중인 행 수", "table=\"fire_events\"",
+                  [this] { return static_cast<double>(queueDepth(m_fireQueue)); });
+    metrics.gauge("ems_db_queue_depth", "테이블 큐(또는 spool)에 대기 중인 행 수", "table=\"pet_status\"",
+                  [this] { return static_cast<double>(queueDepth(m_petQueue)); });
+    metrics.gauge("ems_db_queue_depth", "테이블 큐(또는 spool)에 대기 중인 행 수", "table=\"plant_env\"",
+                  [this] { return static_cast<double>(queueDepth(m_plantQueue)); });
+    metrics.gauge("ems_db_queue_depth", "테이블 큐(또는 spool)에 대기 중인 행 수", "table=\"sensor_aggregates\"",
+                  [this] { return static_cast<double>(queueDepth(m_aggregateQueue)); });
+
+    // spool은 connect에서 열리므로 수집할 때 확인
+    forEachQueue([&metrics](auto& queue) {
+        metrics.gauge("ems_db_spool_bytes", "spool 세그먼트 파일 크기",
+                      std::string("table=\"") + queue.spec.table + "\"",
+                      [&queue] { return queue.spool ? static_cast<double>(queue.spool->stats().bytes) : 0.0; });
+        metrics.counterFn("ems_db_spool_dropped_rows_total", "spool 보관량 초과로 버려진 행 수",
+                          std::string("table=\"") + queue.spec.table + "\"",
+                          [&queue] { return queue.spool ? static_cast<double>(queue.spool->stats().droppedRows) : 0.0; });
+    });
+
+    metrics.gauge("ems_db_pool_connections", "커넥션 풀 연결 수", "state=\"idle\"",
+                  [this] { return static_cast<double>(m_pool.stats().idle); });
+    metrics.gauge("ems_db_pool_connections", "커넥션 풀 연결 수", "state=\"in_use\"",
+                  [this] { return static_cast<double>(m_pool.stats().inUse); });
+    metrics.gauge("ems_db_pool_connections", "커넥션 풀 연결 수", "state=\"broken\"",
+                  [this] { return static_cast<double>(m_pool.stats().broken); });
+    metrics.counterFn("ems_db_pool_acquire_timeouts_total", "연결 획득 시간 초과 횟수", "",
+                      [this] { return static_cast<double>(m_pool.stats().acquireTimeouts); });
+    metrics.counterFn("ems_db_pool_reconnects_total", "재접속 성공 횟수", "",
+                      [this] { return static_cast<double>(m_pool.stats().reconnects); });
+}
+
+template <typename Row>
+size_t DBManager::queueDepth(const TableQueue<Row>& queue) const
+{
+    if (queue.spool)
+        return static_cast<size_t>(queue.spool->backlog());
+
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    return queue.rows.size();
+}
+
+template <typename Row>
+void DBManager::startFlusher(TableQueue<Row>& queue)
+{
+    if (!queue.flusher.joinable())
+    {
+        queue.flusher = std::thread(&DBManager::flushLoop<Row>, this, std::ref(queue));
+    }
+}
+
+template <typename Row>
+void DBManager::stopFlusher(TableQueue<Row>& queue)
+{
+    {
+        // 대기 중인 flush 스레드가 m_stopping 변경을 놓치지 않도록 락을 거쳐서 알림
+        std::lock_guard<std::mutex> lock(queue.mutex);
+    }
+    queue.cv.notify_all();
+    queue.notFull.notify_all();
+
+    if (queue.flusher.joinable())
+    {
+        queue.flusher.join();
+    }
+}
+
+// 행을 테이블 큐에 넣고, 가득 찼으면 백프레셔 정책 적용
+template <typename Row>
+void DBManager::enqueue(TableQueue<Row>& queue, const Row& row)
+{
+    LatencyHistogram::Timer timer(queue.enqueueLatency);
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    if (m_stopping)
+    {
+        m_droppedRows.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // spool: mmap 세그먼트에 복사만 하고 반환 (디스크 동기화와 DB 기록을 기다리지 않음)
+    // 보관량을 넘으면 spool이 가장 오래된 세그먼트를 버리므로 백프레셔 정책은 쓰지 않음
+    if (queue.spool)
+    {
+        uint64_t backlog = queue.spool->append(&row);
+        if (backlog == 0)
+        {
+            m_droppedRows.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        m_enqueuedRows.fetch_add(1, std::memory_order_relaxed);
+        if (backlog == 1)
+        {
+            queue.firstPending = std::chrono::steady_clock::now();
+        }
+
+        // 밀린 행이 있으면 flush 스레드가 쉬지 않고 기록하므로 경계에서만 깨움
+        if (backlog == 1 || backlog == m_options.batchSize)
+        {
+            lock.unlock();
+            queue.cv.notify_one();
+        }
+        return;
+    }
+
+    if (queue.rows.size() >= m_options.queueCapacity)
+    {
+        switch (m_options.policy)
+        {
+        case BackpressurePolicy::Block:
+            if (!queue.notFull.wait_for(lock, m_options.blockTimeout, [&] {
+                    return queue.rows.size() < m_options.queueCapacity || m_stopping;
+                }) || m_stopping)
+            {
+                m_droppedRows.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            break;
+        case BackpressurePolicy::DropNewest:
+            m_droppedRows.fetch_add(1, std::memory_order_relaxed);
+            return;
+        case BackpressurePolicy::DropOldest:
+            queue.rows.pop_front();
+            m_droppedRows.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+    }
+
+    bool wasEmpty = queue.rows.empty();
+    if (wasEmpty)
+    {
+        queue.firstPending = std::chrono::steady_clock::now();
+    }
+    queue.rows.push_back(row);
+    m_enqueuedRows.fetch_add(1, std::memory_order_relaxed);
+
+    // 첫 행(deadline 시작) 또는 배치 크기 도달 시 flush 스레드 깨움
+    if (wasEmpty || queue.rows.size() >= m_options.batchSize)
+    {
+        lock.unlock();
+        queue.cv.notify_one();
+    }
+}
+
+// 배치 크기 또는 deadline 도달 시 테이블 큐를 통째로 가져와서 기록
+template <typename Row>
+void DBManager::flushLoop(TableQueue<Row>& queue)
+{
+    mysql_thread_init();
+
+    if (queue.spool)
+    {
+        spoolLoop(queue);
+        mysql_thread_end();
+        return;
+    }
+
+    std::deque<Row> rows;
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    while (true)
+    {
+        while (!m_stopping)
+        {
+            if (queue.rows.empty())
+            {
+                queue.cv.wait(lock);
+                continue;
+            }
+
+            if (queue.rows.size() >= m_options.batchSize)
+            {
+                break;
+            }
+
+            if (queue.cv.wait_until(lock, queue.firstPending + m_options.flushInterval) ==
+                std::cv_status::timeout)
+            {
+                break;
+            }
+        }
+
+        bool stopping = m_stopping;
+        rows.swap(queue.rows);
+        lock.unlock();
+        queue.notFull.notify_all();
+
+        writeRows(queue, rows);
+
+        lock.lock();
+        if (stopping && queue.rows.empty())
+        {
+            break;
+        }
+    }
+
+    lock.unlock();
+    mysql_thread_end();
+}
+
+// rows를 배치로 나눠서 기록하고 비움
+// 행 수는 2의 거듭제곱 단위로 나눠서 테이블당 statement 수를 log2(batchSize)개로 제한
+template <typename Row>
+void DBManager::writeRows(TableQueue<Row>& queue, std::deque<Row>& rows)
+{
+    if (rows.empty())
+        return;
+
+    const InsertSpec& spec = queue.spec;
+    size_t index = 0;
+    while (index < rows.size())
+    {
+        // 종료 기한이 지나면 남은 행은 버림 (m_shutdownDeadline은 m_stopping보다 먼저 설정됨)
+        if (m_stopping && std::chrono::steady_clock::now() >= m_shutdownDeadline)
+        {
+            size_t lost = rows.size() - index;
+            m_failedRows.fetch_add(lost, std::memory_order_relaxed);
+            LOG_WARN("%s 종료 기한 초과 - %zu행 기록하지 못함", spec.table, lost);
+            break;
+        }
+
+        size_t count = floorPowerOfTwo(std::min(m_options.batchSize, rows.size() - index));
+        queue.staging.assign(rows.begin() + index, rows.begin() + index + count);
+        if (writeBatch(queue, queue.staging.data(), count) != BatchResult::Written)
+        {
+            m_failedRows.fetch_add(count, std::memory_order_relaxed);
+        }
+        index += count;
+    }
+
+    rows.clear();
+}
+
+// spool에 쌓인 행을 배치 크기 또는 deadline마다 기록
+// MySQL에 연결할 수 없으면 행을 spool에 그대로 두고 retryInterval 뒤에 같은 행부터 다시 시도
+template <typename Row>
+void DBManager::spoolLoop(TableQueue<Row>& queue)
 {
-    std::lock_guard<std::mutex> lock(mtx);
-    std::ostringstream oss;
-    oss << "INSERT INTO pet_status (food, water, toilet, home_id) VALUES ('"
-        << foodData << "', '" << waterData << "', '"
-        << toiletState << "', 1);";
+    RowSpool& spool = *queue.spool;
+    queue.staging.resize(m_options.batchSize);
+
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    while (true)
+    {
+        while (!m_stopping)
+        {
+            uint64_t backlog = spool.backlog();
+            if (backlog == 0)
+            {
+                queue.cv.wait(lock);
+                continue;
+            }
+
+            if (backlog >= m_options.batchSize)
+            {
+                break;
+            }
+
+            if (queue.cv.wait_until(lock, queue.firstPending + m_options.flushInterval) ==
+                std::cv_status::timeout)
+            {
+                break;
+            }
+        }
+
+        bool stopping = m_stopping;
+        lock.unlock();
+        bool available = replaySpool(queue);
+        lock.lock();
+        if (stopping)
+        {
+            break;
+        }
+
+        // 기록하는 동안 들어온 행은 지금부터 flushInterval 안에 기록
+        queue.firstPending = std::chrono::steady_clock::now();
+        if (!available)
+        {
+            queue.cv.wait_for(lock, m_options.spool.retryInterval, [this] { return m_stopping.load(); });
+        }
+    }
+}
 
-    if (mysql_query(m_conn, oss.str().c_str()))
+// spool의 밀린 행을 배치 크기씩 쉬지 않고 기록하고 기록된 만큼 ack
+// MySQL에 연결할 수 없으면 false (MySQL이 거부한 배치는 실패 행으로 집계하고 건너뜀)
+template <typename Row>
+bool DBManager::replaySpool(TableQueue<Row>& queue)
+{
+    RowSpool& spool = *queue.spool;
+    while (true)
     {
-        std::cerr << "insertPetData 실패: " << mysql_error(m_conn) << std::endl;
+        uint64_t backlog = spool.backlog();
+        if (backlog == 0)
+        {
+            return true;
+        }
+
+        if (m_stopping && std::chrono::steady_clock::now() >= m_shutdownDeadline)
+        {
+            LOG_WARN("%s 종료 기한 초과 - %llu행은 spool에 남겨 다음 시작 때 기록", queue.spec.table,
+                     static_cast<unsigned long long>(backlog));
+            return true;
+        }
+
+        uint64_t first;
+        size_t count = floorPowerOfTwo(static_cast<size_t>(std::min<uint64_t>(m_options.batchSize, backlog)));
+        count = spool.read(queue.staging.data(), count, first);
+
+        BatchResult result = writeBatch(queue, queue.staging.data(), count);
+        if (result == BatchResult::Retry)
+        {
+            if (m_stopping)
+            {
+                LOG_WARN("%s MySQL에 기록하지 못함 - %llu행은 spool에 남겨 다음 시작 때 기록", queue.spec.table,
+                         static_cast<unsigned long long>(backlog));
+            }
+            return false;
+        }
+        if (result == BatchResult::Rejected)
+        {
+            m_failedRows.fetch_add(count, std::memory_order_relaxed);
+        }
+        spool.ack(first, count);
     }
 }
 
-void DBManager::insertPlantData(float soilData, float tempData, float humiData, float lightData)
+// 풀에서 빌린 연결의 cached prepared statement(또는 교체된 BatchWriter)로 배치 하나를 기록하고 통계 갱신
+template <typename Row>
+DBManager::BatchResult DBManager::writeBatch(TableQueue<Row>& queue, const Row* rows, size_t count)
 {
-    std::lock_guard<std::mutex> lock(mtx);
-    std::ostringstream oss;
-    oss << "INSERT INTO plant_env (temperature, soil_moisture, illumination, humidity, home_id) VALUES ("
-        << tempData << ", " << soilData << ", " << lightData << ", " << humiData << ", 1);";
+    auto begin = std::chrono::steady_clock::now();
+    BatchResult result;
+    if (m_writer)
+    {
+        result = m_writer->writeBatch(queue.spec, rows, count) ? BatchResult::Written : BatchResult::Retry;
+    }
+    else
+    {
+        result = insertBatch(queue.spec, rows, count);
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+    auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    queue.insertLatency.record(elapsed);
+
+    if (result == BatchResult::Written)
+    {
+        m_writtenRows.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    uint64_t us = static_cast<uint64_t>(elapsedUs);
+    m_flushCount.fetch_add(1, std::memory_order_relaxed);
+    m_lastFlushUs.store(us, std::memory_order_relaxed);
+    m_totalFlushUs.fetch_add(us, std::memory_order_relaxed);
+    if (us > m_maxFlushUs.load(std::memory_order_relaxed))
+    {
+        m_maxFlushUs.store(us, std::memory_order_relaxed);
+    }
+    return result;
+}
 
-    if (mysql_query(m_conn, oss.str().c_str()))
+// 풀에서 빌린 연결로 rows[0, count)를 INSERT (연결이 끊겼으면 다른 연결로 한 번 재시도)
+template <typename Row>
+DBManager::BatchResult DBManager::insertBatch(const InsertSpec& spec, const Row* rows, size_t count)
+{
+    for (int attempt = 0; attempt < 2; ++attempt)
     {
-        std::cerr << "insertPlantData 실패: " << mysql_error(m_conn) << std::endl;
+        DBConnectionPool::Lease conn = m_pool.acquire();
+        if (!conn)
+        {
+            LOG_SAMPLED(LogLevel::Error, "%s 기록 실패: 사용 가능한 MySQL 연결 없음", spec.table);
+            break;
+        }
+
+        unsigned int prepareError = 0;
+        PreparedInsert* stmt = conn->insertStatement(spec, count, &prepareError);
+        if (!stmt)
+        {
+            // 테이블/컬럼이 없거나 권한이 없는 경우는 다시 시도해도 같으므로 연결을 버리지 않고 거부
+            if (!DBConnection::isConnectionError(prepareError))
+            {
+                return BatchResult::Rejected;
+            }
+            conn.markBroken();
+            continue;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::memcpy(stmt->row(i), &rows[i], sizeof(Row));
+        }
+
+        if (stmt->execute())
+        {
+            return BatchResult::Written;
+        }
+
+        LOG_SAMPLED(LogLevel::Error, "%s 배치 INSERT 실패 (%zu행): %s",
+                    spec.table, count, stmt->error());
+
+        // 연결이 끊긴 경우 풀에서 재접속 대상으로 돌리고 다른 연결로 한 번 재시도
+        if (!DBConnection::isConnectionError(stmt->errorCode()))
+        {
+            return BatchResult::Rejected;
+        }
+        conn.markBroken();
     }
+    return BatchResult::Retry;
 }
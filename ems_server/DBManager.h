@@ -1,11 +1,71 @@
 #ifndef DBMANAGER_H
 #define DBMANAGER_H
 
-#include <mysql/mysql.h>
+#include "DBConnectionPool.h"
+#include "DBRows.h"
+#include "Metrics.h"
+#include "RowSpool.h"
+#include "SensorSink.h"
 #include <string>
+#include <memory>
 #include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 
-class DBManager
+// 쓰기 큐가 가득 찼을 때의 처리 정책
+enum class BackpressurePolicy
+{
+    Block,        // 공간이 생길 때까지 호출 스레드 대기 (blockTimeout 후 버림)
+    DropNewest,   // 새로 들어온 행을 버림
+    DropOldest    // 가장 오래된 행을 버리고 새 행을 넣음
+};
+
+// 배치 쓰기 설정
+struct DBWriteOptions
+{
+    size_t queueCapacity = 4096;                      // 테이블별 최대 대기 행 수
+    size_t batchSize = 256;                           // INSERT 한 번에 묶을 최대 행 수
+    std::chrono::milliseconds flushInterval{200};     // 첫 행이 들어온 뒤 최대 대기 시간
+    BackpressurePolicy policy = BackpressurePolicy::DropOldest;
+    std::chrono::milliseconds blockTimeout{50};       // Block 정책에서 최대 대기 시간
+    SpoolOptions spool;                               // directory를 정하면 메모리 큐 대신 디스크 spool을 거쳐 기록
+};
+
+// 쓰기 큐 상태 (모니터링용)
+struct DBWriteStats
+{
+    size_t queueDepth = 0;          // 현재 대기 중인 행 수
+    uint64_t enqueuedRows = 0;      // 큐에 들어온 전체 행 수
+    uint64_t droppedRows = 0;       // 백프레셔(spool은 보관량 초과)로 버려진 행 수
+    uint64_t writtenRows = 0;       // DB에 기록된 행 수
+    uint64_t failedRows = 0;        // INSERT 실패로 잃은 행 수 (spool은 MySQL이 거부한 행만)
+    uint64_t flushCount = 0;        // 실행된 배치 INSERT 수
+    double lastFlushMs = 0.0;       // 마지막 배치 INSERT 소요 시간
+    double maxFlushMs = 0.0;        // 최대 배치 INSERT 소요 시간
+    double avgFlushMs = 0.0;        // 평균 배치 INSERT 소요 시간
+    uint64_t spoolBacklog = 0;      // spool에 남아 있는 (DB에 기록되지 않은) 행 수
+    uint64_t spoolBytes = 0;        // spool 세그먼트 파일 크기 합
+};
+
+// 배치 INSERT 대상 교체용 (기본은 MySQL 커넥션 풀, 벤치마크에서는 메모리 sink 사용)
+class BatchWriter
+{
+public:
+    virtual ~BatchWriter() = default;
+
+    // rows: spec.rowSize 크기의 행(DBRows.h 구조체) count개가 연속으로 들어 있음
+    // flush 스레드(테이블마다 하나)에서 동시에 호출될 수 있음
+    // false면 기록하지 못함 (spool을 쓰면 같은 행부터 retryInterval 뒤에 다시 호출됨)
+    virtual bool writeBatch(const InsertSpec& spec, const void* rows, size_t count) = 0;
+};
+
+// MySQL 저장 sink (샘플을 모듈별 테이블 행으로 바꿔서 배치 INSERT 큐에 넣음)
+class DBManager : public SensorSink
 {
 public:
     static DBManager& instance()
@@ -14,19 +74,44 @@ public:
         return instance;
     }
 
+    // connect 전에 호출해야 적용됨
+    void configure(const DBWriteOptions& options);
+    void configurePool(const DBPoolOptions& options);
+
     bool connect(const std::string& host,
                  const std::string& user,
                  const std::string& password,
                  const std::string& db,
                  unsigned int port);
 
-    void insertHomeData(float temperature, float humidity, float illumination);
+    // MySQL 대신 writer로 기록 (connect 대신 호출)
+    bool connect(std::shared_ptr<BatchWriter> writer);
+
+    // 남은 행을 기록하고 flush 스레드 종료
+    // timeout이 지나면 남은 배치는 기록하지 않고 실패 행으로 집계 (MySQL이 죽어 있어도 종료가 늦어지지 않도록)
+    // spool을 쓰면 남은 행은 spool에 두고 다음 시작 때 기록
+    void shutdown(std::chrono::milliseconds timeout = std::chrono::milliseconds(5000));
+
+    // insert* 함수는 큐(또는 spool)에 넣기만 하고 즉시 반환 (실제 쓰기는 flush 스레드)
+    // 모든 home의 행이 같은 테이블 큐와 커넥션 풀을 함께 씀 (home_id 컬럼으로 구분)
+    void insertHomeData(float temperature, float humidity, float illumination,
+                        uint32_t homeId = kDefaultHomeId);
     void insertFireData(const std::string& fireState, int fireData,
-                        const std::string& gasState, float gasData);
+                        const std::string& gasState, float gasData, uint32_t homeId = kDefaultHomeId);
     void insertPetData(const std::string& foodData,
                        const std::string& waterData,
-                       const std::string& toiletState);
-    void insertPlantData(float soilData, float tempData, float humiData, float lightData);
+                       const std::string& toiletState, uint32_t homeId = kDefaultHomeId);
+    void insertPlantData(float soilData, float tempData, float humiData, float lightData,
+                         uint32_t homeId = kDefaultHomeId);
+
+    // SensorSink: 샘플 종류에 맞는 insert* 호출 (plant 샘플은 home_env에도 기록)
+    void write(uint32_t homeId, std::string_view device, int64_t timeUs, const SensorSample& sample) override;
+
+    // SensorSink: 집계 구간 결과를 sensor_aggregates 테이블 큐에 넣음
+    void writeAggregate(const WindowAggregate& aggregate) override;
+
+    DBWriteStats stats() const;
+    DBPoolStats poolStats() const;
 
 private:
     DBManager();
@@ -34,8 +119,124 @@ private:
     DBManager(const DBManager&) = delete;
     DBManager& operator=(const DBManager&) = delete;
 
-    MYSQL* m_conn;
-    std::mutex mtx;
+    // 테이블 하나의 대기 큐와 전용 flush 스레드 (테이블끼리는 서로 다른 연결로 병렬 기록)
+    template <typename Row>
+    struct TableQueue
+    {
+        explicit TableQueue(const InsertSpec& insertSpec)
+            : spec(insertSpec),
+              enqueueLatency(Metrics::instance().histogram(
+                  "ems_db_enqueue_seconds", "insert* 호출 (큐 적재) 소요 시간",
+                  std::string("table=\"") + insertSpec.table + "\"")),
+              insertLatency(Metrics::instance().histogram(
+                  "ems_db_batch_insert_seconds", "배치 INSERT 실행 시간 (연결 획득 포함)",
+                  std::string("table=\"") + insertSpec.table + "\""))
+        {
+        }
+
+        const InsertSpec& spec;
+        LatencyHistogram& enqueueLatency;
+        LatencyHistogram& insertLatency;
+        mutable std::mutex mutex;
+        std::condition_variable cv;         // flush 스레드 깨우기
+        std::condition_variable notFull;    // Block 정책 대기
+        std::deque<Row> rows;
+        std::vector<Row> staging;           // BatchWriter로 넘길 연속 행 (flush 스레드 전용)
+        std::chrono::steady_clock::time_point firstPending;
+        std::thread flusher;
+        std::unique_ptr<RowSpool> spool;    // 있으면 rows 대신 사용 (connect에서 열고 shutdown에서 닫음)
+    };
+
+    // 배치 하나의 기록 결과
+    enum class BatchResult
+    {
+        Written,
+        Retry,          // MySQL에 연결할 수 없음 (spool은 같은 행을 다시 시도)
+        Rejected        // MySQL이 배치를 거부함 (다시 보내도 같은 결과)
+    };
+
+    template <typename F>
+    void forEachQueue(F&& f)
+    {
+        f(m_homeQueue);
+        f(m_fireQueue);
+        f(m_petQueue);
+        f(m_plantQueue);
+        f(m_aggregateQueue);
+    }
+
+    template <typename F>
+    void forEachQueue(F&& f) const
+    {
+        f(m_homeQueue);
+        f(m_fireQueue);
+        f(m_petQueue);
+        f(m_plantQueue);
+        f(m_aggregateQueue);
+    }
+
+    template <typename Row>
+    void enqueue(TableQueue<Row>& queue, const Row& row);
+
+    template <typename Row>
+    void flushLoop(TableQueue<Row>& queue);
+
+    template <typename Row>
+    void spoolLoop(TableQueue<Row>& queue);
+
+    template <typename Row>
+    void writeRows(TableQueue<Row>& queue, std::deque<Row>& rows);
+
+    template <typename Row>
+    bool replaySpool(TableQueue<Row>& queue);
+
+    template <typename Row>
+    BatchResult writeBatch(TableQueue<Row>& queue, const Row* rows, size_t count);
+
+    template <typename Row>
+    BatchResult insertBatch(const InsertSpec& spec, const Row* rows, size_t count);
+
+    template <typename Row>
+    size_t queueDepth(const TableQueue<Row>& queue) const;
+
+    void registerMetrics();
+    void openSpools();
+    void syncLoop();
+
+    template <typename Row>
+    void startFlusher(TableQueue<Row>& queue);
+    void startFlushers();
+
+    template <typename Row>
+    void stopFlusher(TableQueue<Row>& queue);
+
+    DBConnectionPool m_pool;
+    std::shared_ptr<BatchWriter> m_writer;      // 있으면 풀 대신 사용
+    DBPoolOptions m_poolOptions;
+    DBWriteOptions m_options;
+    std::atomic<bool> m_stopping;
+    std::chrono::steady_clock::time_point m_shutdownDeadline;   // m_stopping 전에 설정
+
+    TableQueue<HomeRow> m_homeQueue;
+    TableQueue<FireRow> m_fireQueue;
+    TableQueue<PetRow> m_petQueue;
+    TableQueue<PlantRow> m_plantQueue;
+    TableQueue<AggregateRow> m_aggregateQueue;
+
+    // spool group commit 스레드 (모든 테이블의 spool을 syncInterval마다 msync)
+    std::thread m_syncThread;
+    std::mutex m_syncMutex;
+    std::condition_variable m_syncCv;
+
+    // 통계
+    std::atomic<uint64_t> m_enqueuedRows;
+    std::atomic<uint64_t> m_droppedRows;
+    std::atomic<uint64_t> m_writtenRows;
+    std::atomic<uint64_t> m_failedRows;
+    std::atomic<uint64_t> m_flushCount;
+    std::atomic<uint64_t> m_lastFlushUs;
+    std::atomic<uint64_t> m_maxFlushUs;
+    std::atomic<uint64_t> m_totalFlushUs;
 };
 
 #endif // DBMANAGER_H
@@ -0,0 +1,77 @@
+#ifndef DBROWS_H
+#define DBROWS_H
+
+#include <string>
+#include <string_view>
+#include <cstring>
+
+// 테이블별 한 행 데이터 (prepared statement에 그대로 바인딩되는 고정 크기 구조체)
+// 문자열은 고정 길이 배열에 복사해서 큐/바인딩 과정에서 힙 할당이 없도록 함
+// 모든 행은 마지막 컬럼으로 home_id를 가짐
+
+constexpr size_t kRowTextSize = 32;   // 상태 문자열 최대 바이트 수 (UTF-8)
+
+struct HomeRow
+{
+    float temperature;
+    float humidity;
+    float illumination;
+    int homeId;
+};
+
+struct FireRow
+{
+    int fireData;
+    float gasData;
+    char fireState[kRowTextSize];
+    unsigned long fireStateLen;
+    char gasState[kRowTextSize];
+    unsigned long gasStateLen;
+    int homeId;
+};
+
+struct PetRow
+{
+    char food[kRowTextSize];
+    unsigned long foodLen;
+    char water[kRowTextSize];
+    unsigned long waterLen;
+    char toilet[kRowTextSize];
+    unsigned long toiletLen;
+    int homeId;
+};
+
+struct PlantRow
+{
+    float soil;
+    float temp;
+    float humi;
+    float light;
+    int homeId;
+};
+
+// 집계 구간 하나의 필드 통계 (sensor_aggregates)
+struct AggregateRow
+{
+    char device[kRowTextSize];
+    unsigned long deviceLen;
+    char field[kRowTextSize];
+    unsigned long fieldLen;
+    long long windowSeconds;
+    long long windowStartMs;        // 구간 시작 (Unix epoch 밀리초)
+    int sampleCount;
+    double minValue;
+    double maxValue;
+    double meanValue;
+    double lastValue;
+    int homeId;
+};
+
+// 문자열을 고정 길이 필드에 복사 (넘치면 잘라냄)
+inline void copyRowText(char (&dst)[kRowTextSize], unsigned long& len, std::string_view src)
+{
+    len = src.size() < kRowTextSize ? src.size() : kRowTextSize;
+    std::memcpy(dst, src.data(), len);
+}
+
+#endif // DBROWS_H
@@ -0,0 +1,250 @@
+#include "DeviceSupervisor.h"
+#include "Logger.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+
+constexpr int kIdlePollMs = 1000;
+
+} // namespace
+
+DeviceSupervisor::DeviceSupervisor()
+    : m_running(false),
+      m_inotifyFd(-1),
+      m_wakeFd(-1)
+{
+}
+
+DeviceSupervisor::~DeviceSupervisor()
+{
+    stop();
+}
+
+// raw 8N1, 흐름 제어 없음, 모뎀 제어선 무시 (rfcomm tty는 baud 설정과 무관)
+int DeviceSupervisor::openPort(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+
+    struct termios tty;
+    if (tcgetattr(fd, &tty) == 0)
+    {
+        cfmakeraw(&tty);
+        tty.c_cflag |= CLOCAL | CREAD;
+        tty.c_cflag &= ~CRTSCTS;
+        tty.c_cc[VMIN] = 1;         // 데이터가 없으면 EAGAIN, 0은 hangup일 때만
+        tty.c_cc[VTIME] = 0;
+        if (tcsetattr(fd, TCSANOW, &tty) != 0)
+            LOG_WARN("termios 설정 실패: %s: %s", path.c_str(), strerror(errno));
+    }
+    return fd;
+}
+
+void DeviceSupervisor::start(const std::vector<std::string>& paths, OpenedCallback opened)
+{
+    if (m_running)
+        return;
+
+    m_opened = std::move(opened);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0)
+        LOG_WARN("inotify 사용 불가 - 주기적 재시도만 사용: %s", strerror(errno));
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+        for (const std::string& path : paths)
+        {
+            Entry entry;
+            if (path.empty())
+            {
+                m_entries.push_back(std::move(entry));
+                continue;
+            }
+            entry.path = path;
+            size_t slash = path.rfind('/');
+            entry.directory = (slash == std::string::npos) ? "." : path.substr(0, slash == 0 ? 1 : slash);
+            entry.fileName = (slash == std::string::npos) ? path : path.substr(slash + 1);
+
+            // 같은 디렉터리는 같은 watch descriptor가 나옴
+            if (m_inotifyFd >= 0)
+                entry.watch = inotify_add_watch(m_inotifyFd, entry.directory.c_str(), IN_CREATE | IN_ATTRIB);
+            m_entries.push_back(std::move(entry));
+        }
+    }
+
+    m_running = true;
+    m_thread = std::thread(&DeviceSupervisor::run, this);
+}
+
+void DeviceSupervisor::stop()
+{
+    if (!m_running)
+        return;
+
+    m_running = false;
+    wake();
+    if (m_thread.joinable())
+        m_thread.join();
+
+    if (m_inotifyFd >= 0)
+        close(m_inotifyFd);
+    if (m_wakeFd >= 0)
+        close(m_wakeFd);
+    m_inotifyFd = m_wakeFd = -1;
+}
+
+void DeviceSupervisor::wake()
+{
+    if (m_wakeFd < 0)
+        return;
+    uint64_t one = 1;
+    ssize_t ignored = write(m_wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+void DeviceSupervisor::reportDown(uint32_t device, std::chrono::steady_clock::duration upFor)
+{
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (device >= m_entries.size() || m_entries[device].path.empty())
+            return;
+
+        Entry& entry = m_entries[device];
+        if (upFor >= m_options.stableTime)
+            entry.backoff = std::chrono::milliseconds(0);
+        entry.down = true;
+        scheduleRetry(entry, now);
+    }
+    wake();
+}
+
+// 재시도 대기를 두 배로 늘려서 예약 (처음이면 reconnectMin)
+void DeviceSupervisor::scheduleRetry(Entry& entry, std::chrono::steady_clock::time_point now)
+{
+    if (entry.backoff.count() == 0)
+        entry.backoff = m_options.reconnectMin;
+    else
+        entry.backoff = std::min(entry.backoff * 2, m_options.reconnectMax);
+    entry.retryAt = now + entry.backoff;
+}
+
+// 감시 중인 디렉터리에 포트 노드가 생기거나 권한이 바뀌면 (udev) 기다리지 않고 바로 재시도
+void DeviceSupervisor::readNotifications(std::chrono::steady_clock::time_point now)
+{
+    alignas(struct inotify_event) char buffer[4096];
+    while (true)
+    {
+        ssize_t length = read(m_inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (ssize_t offset = 0; offset < length;)
+        {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+            offset += sizeof(struct inotify_event) + event->len;
+            if (event->len == 0)
+                continue;
+
+            for (Entry& entry : m_entries)
+            {
+                if (entry.down && entry.watch == event->wd && entry.fileName == event->name)
+                {
+                    LOG_INFO("%s 생김 - 바로 다시 연결 시도", entry.path.c_str());
+                    entry.retryAt = now;
+                }
+            }
+        }
+    }
+}
+
+void DeviceSupervisor::run()
+{
+    while (m_running)
+    {
+        // 가장 이른 재시도 시각까지만 대기
+        auto now = std::chrono::steady_clock::now();
+        int timeoutMs = kIdlePollMs;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const Entry& entry : m_entries)
+            {
+                if (!entry.down)
+                    continue;
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(entry.retryAt - now).count();
+                timeoutMs = std::min<int>(timeoutMs, static_cast<int>(std::max<int64_t>(wait + 1, 0)));
+            }
+        }
+
+        struct pollfd fds[2];
+        fds[0].fd = m_wakeFd;
+        fds[0].events = POLLIN;
+        fds[1].fd = m_inotifyFd;
+        fds[1].events = POLLIN;
+        int ret = poll(fds, m_inotifyFd >= 0 ? 2 : 1, timeoutMs);
+        if (ret < 0 && errno != EINTR)
+        {
+            LOG_ERROR("디바이스 감시 poll 오류: %s", strerror(errno));
+            return;
+        }
+        if (!m_running)
+            return;
+
+        now = std::chrono::steady_clock::now();
+        if (fds[0].revents & POLLIN)
+        {
+            uint64_t value;
+            ssize_t ignored = read(m_wakeFd, &value, sizeof(value));
+            (void)ignored;
+        }
+        if (m_inotifyFd >= 0 && (fds[1].revents & POLLIN))
+            readNotifications(now);
+
+        // 재시도 시각이 된 디바이스를 하나씩 열어봄 (open은 락 밖에서)
+        for (uint32_t index = 0;; ++index)
+        {
+            std::string path;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (index >= m_entries.size())
+                    break;
+                const Entry& entry = m_entries[index];
+                if (!entry.down || entry.retryAt > now)
+                    continue;
+                path = entry.path;
+            }
+
+            int fd = openPort(path);
+            int error = errno;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                Entry& entry = m_entries[index];
+                if (fd < 0)
+                {
+                    scheduleRetry(entry, std::chrono::steady_clock::now());
+                    LOG_WARN("블루투스 포트 다시 열기 실패: %s: %s (%lld ms 후 재시도)", path.c_str(),
+                             strerror(error), static_cast<long long>(entry.backoff.count()));
+                    continue;
+                }
+                entry.down = false;
+            }
+
+            LOG_INFO("블루투스 포트 다시 열림: %s", path.c_str());
+            m_opened(index, fd);
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef DEVICESUPERVISOR_H
+#define DEVICESUPERVISOR_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+struct DeviceSupervisorOptions
+{
+    std::chrono::milliseconds reconnectMin{500};        // 첫 재시도 대기 (실패할 때마다 두 배)
+    std::chrono::milliseconds reconnectMax{30000};      // 재시도 대기 상한
+    std::chrono::milliseconds stableTime{10000};        // 이보다 오래 연결돼 있다 끊기면 대기를 처음부터
+    std::chrono::milliseconds staleTimeout{30000};      // 센서 줄을 보내던 디바이스가 이만큼 조용하면 끊긴 것으로 봄 (0이면 끔)
+};
+
+// 끊긴 블루투스 포트를 별도 스레드에서 다시 여는 감시자
+// - 재시도 간격은 reconnectMin부터 두 배씩 reconnectMax까지 (연결 직후 다시 끊기는 모듈도 같은 규칙)
+// - 포트 경로가 있는 디렉터리(/dev)를 inotify로 감시해서 rfcomm 노드가 생기면 바로 재시도
+// open은 블루투스 연결을 기다리며 오래 걸릴 수 있어서 수신 루프가 아닌 이 스레드에서 함
+class DeviceSupervisor
+{
+public:
+    // 포트를 새로 열었을 때 감시 스레드에서 호출 (fd 소유권을 넘김)
+    using OpenedCallback = std::function<void(uint32_t device, int fd)>;
+
+    DeviceSupervisor();
+    ~DeviceSupervisor();
+    DeviceSupervisor(const DeviceSupervisor&) = delete;
+    DeviceSupervisor& operator=(const DeviceSupervisor&) = delete;
+
+    void setOptions(const DeviceSupervisorOptions& options) { m_options = options; }
+    const DeviceSupervisorOptions& options() const { return m_options; }
+
+    // paths[i]가 디바이스 i의 포트 (처음에는 모두 연결된 것으로 보고 reportDown된 것만 다시 엶)
+    // 빈 경로는 포트가 없는 원격 디바이스라서 감시하지 않음
+    void start(const std::vector<std::string>& paths, OpenedCallback opened);
+    void stop();
+
+    // 디바이스 포트가 닫혔음 (upFor: 끊기기 전까지 연결돼 있던 시간, 짧으면 재시도 대기를 늘림)
+    void reportDown(uint32_t device, std::chrono::steady_clock::duration upFor);
+
+    // 포트 열기 + termios 설정 (raw, non-blocking, 실패하면 -1)
+    static int openPort(const std::string& path);
+
+private:
+    struct Entry
+    {
+        std::string path;
+        std::string directory;
+        std::string fileName;
+        int watch = -1;                                 // inotify watch descriptor
+        bool down = false;
+        std::chrono::milliseconds backoff{0};
+        std::chrono::steady_clock::time_point retryAt;
+    };
+
+    void run();
+    void readNotifications(std::chrono::steady_clock::time_point now);
+    void scheduleRetry(Entry& entry, std::chrono::steady_clock::time_point now);
+    void wake();
+
+    DeviceSupervisorOptions m_options;
+    OpenedCallback m_opened;
+
+    std::mutex m_mutex;                                 // m_entries
+    std::vector<Entry> m_entries;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    int m_inotifyFd;
+    int m_wakeFd;                                       // reportDown/stop 시 poll을 깨우는 eventfd
+};
+
+#endif // DEVICESUPERVISOR_H
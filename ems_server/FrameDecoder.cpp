@@ -0,0 +1,103 @@
+#include "FrameDecoder.h"
+#include "BinaryProtocol.h"
+#include <cstdint>
+
+namespace
+{
+
+constexpr size_t kLengthHeaderSize = 4;
+
+} // namespace
+
+FrameStatus nextFrame(const RingBuffer& buffer, FrameMode mode, size_t maxFrameSize,
+                      std::string& scratch, std::string_view& frame, size_t& consumed)
+{
+    if (mode == FrameMode::Binary)
+    {
+        consumed = 0;
+        if (buffer.size() < kBinaryHeaderSize)
+            return FrameStatus::NeedMore;
+
+        unsigned char header[2];
+        buffer.copyOut(0, reinterpret_cast<char*>(header), sizeof(header));
+        size_t length = kBinaryHeaderSize + ((size_t(header[0]) << 8) | size_t(header[1]));
+
+        if (length > maxFrameSize)
+            return FrameStatus::TooLarge;
+        if (buffer.size() < length)
+            return FrameStatus::NeedMore;
+
+        // 헤더와 payload를 수신 버퍼 위에서 그대로 해석 (랩어라운드된 프레임만 scratch로 복사)
+        frame = std::string_view(buffer.contiguous(0, length, scratch), length);
+        consumed = length;
+        return FrameStatus::Frame;
+    }
+
+    if (mode == FrameMode::LengthPrefixed)
+    {
+        consumed = 0;
+        if (buffer.size() < kLengthHeaderSize)
+            return FrameStatus::NeedMore;
+
+        unsigned char header[kLengthHeaderSize];
+        buffer.copyOut(0, reinterpret_cast<char*>(header), kLengthHeaderSize);
+        uint32_t length = (uint32_t(header[0]) << 24) | (uint32_t(header[1]) << 16) |
+                          (uint32_t(header[2]) << 8) | uint32_t(header[3]);
+
+        if (length > maxFrameSize)
+            return FrameStatus::TooLarge;
+        if (buffer.size() < kLengthHeaderSize + length)
+            return FrameStatus::NeedMore;
+
+        frame = std::string_view(buffer.contiguous(kLengthHeaderSize, length, scratch), length);
+        consumed = kLengthHeaderSize + length;
+        return FrameStatus::Frame;
+    }
+
+    // Newline: 빈 줄은 건너뛰면서 다음 줄을 찾음
+    size_t start = 0;
+    while (true)
+    {
+        size_t newline = buffer.find('\n', start);
+        if (newline == RingBuffer::npos)
+        {
+            // 앞쪽의 빈 줄은 버려도 됨
+            consumed = start;
+            return (buffer.size() - start > maxFrameSize) ? FrameStatus::TooLarge
+                                                          : FrameStatus::NeedMore;
+        }
+
+        size_t length = newline - start;
+        if (length > 0 && buffer.at(newline - 1) == '\r')
+            --length;
+
+        if (length == 0)
+        {
+            start = newline + 1;
+            continue;
+        }
+        if (length > maxFrameSize)
+            return FrameStatus::TooLarge;
+
+        frame = std::string_view(buffer.contiguous(start, length, scratch), length);
+        consumed = newline + 1;
+        return FrameStatus::Frame;
+    }
+}
+
+bool appendFrame(RingBuffer& out, FrameMode mode, std::string_view payload)
+{
+    if (mode == FrameMode::LengthPrefixed)
+    {
+        if (!out.reserve(kLengthHeaderSize + payload.size()))
+            return false;
+
+        uint32_t length = static_cast<uint32_t>(payload.size());
+        char header[kLengthHeaderSize] = {
+            static_cast<char>(length >> 24), static_cast<char>(length >> 16),
+            static_cast<char>(length >> 8), static_cast<char>(length)
+        };
+        out.append(header, kLengthHeaderSize);
+    }
+    return out.append(payload.data(), payload.size());
+}
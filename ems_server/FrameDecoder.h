@@ -0,0 +1,33 @@
+#ifndef FRAMEDECODER_H
+#define FRAMEDECODER_H
+
+#include "RingBuffer.h"
+#include <string>
+#include <string_view>
+
+// TCP 스트림에서 명령 경계를 나누는 방식
+enum class FrameMode
+{
+    Newline,          // "window_open\n" ("\r\n"도 허용, 빈 줄은 무시)
+    LengthPrefixed,   // 4바이트 big-endian 길이 + payload
+    Binary            // 12바이트 바이너리 헤더 + payload (BinaryProtocol.h, 연결마다 협상)
+};
+
+enum class FrameStatus
+{
+    Frame,      // 프레임 하나를 꺼냄
+    NeedMore,   // 아직 완전한 프레임이 없음
+    TooLarge    // maxFrameSize를 넘는 프레임 (연결 종료 대상)
+};
+
+// 버퍼 앞에서 프레임 하나를 찾음 (버퍼는 수정하지 않음)
+// Frame이면 frame은 payload(Binary는 헤더 포함)를 가리키고, 처리 후 consumed만큼 consume해야 함
+// NeedMore일 때도 consumed(건너뛴 빈 줄)만큼은 버려도 됨
+// 랩어라운드된 프레임은 scratch에 복사되므로 frame은 다음 호출 전까지만 유효
+FrameStatus nextFrame(const RingBuffer& buffer, FrameMode mode, size_t maxFrameSize,
+                      std::string& scratch, std::string_view& frame, size_t& consumed);
+
+// 길이 헤더를 붙여서 out에 추가 (LengthPrefixed 응답용, Binary는 이미 헤더가 있는 프레임을 그대로 추가)
+bool appendFrame(RingBuffer& out, FrameMode mode, std::string_view payload);
+
+#endif // FRAMEDECODER_H
@@ -0,0 +1,25 @@
+#ifndef HOME_H
+#define HOME_H
+
+#include <string_view>
+#include <charconv>
+#include <cstdint>
+
+// 한 서버 프로세스가 여러 집(home)의 디바이스를 함께 처리
+// - 모든 디바이스와 샘플에 home_id가 붙고 DB 행에도 그대로 기록됨
+// - 디바이스 이름은 home 안에서만 유일 (home마다 fireModule이 따로 있을 수 있음)
+// home을 지정하지 않은 디바이스와 TCP 연결은 kDefaultHomeId
+constexpr uint32_t kDefaultHomeId = 1;
+
+// "12" → 12 (0, 음수, 숫자가 아닌 문자가 있으면 false)
+inline bool parseHomeId(std::string_view text, uint32_t& homeId)
+{
+    uint32_t value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != std::errc() || result.ptr != text.data() + text.size() || value == 0)
+        return false;
+    homeId = value;
+    return true;
+}
+
+#endif // HOME_H
@@ -0,0 +1,162 @@
+#include "IngestPipeline.h"
+#include <cstring>
+#include <chrono>
+
+namespace
+{
+
+constexpr int kSpinCount = 64;                                  // 잠들기 전 재시도 횟수
+constexpr std::chrono::milliseconds kIdleWait(100);             // 깨우기를 놓쳐도 이 시간 안에 재확인
+
+} // namespace
+
+IngestPipeline::IngestPipeline()
+    : m_workerCount(0),
+      m_queueCapacity(4096),
+      m_running(false),
+      m_submitted(0),
+      m_dropped(0),
+      m_processed(0)
+{
+}
+
+IngestPipeline::~IngestPipeline()
+{
+    stop();
+    m_workers.clear();
+}
+
+void IngestPipeline::configure(size_t workers, size_t queueCapacity)
+{
+    m_workerCount = workers;
+    m_queueCapacity = queueCapacity;
+}
+
+void IngestPipeline::start(Handler handler)
+{
+    if (m_running)
+        return;
+
+    size_t count = m_workerCount;
+    if (count == 0)
+    {
+        unsigned int cores = std::thread::hardware_concurrency();
+        count = (cores <= 1) ? 1 : cores - 1;   // 수신 스레드 몫 하나는 남김
+    }
+
+    // Worker는 start에서 한 번만 만들고 소멸자까지 유지 (메트릭 스레드가 queueDepth로 읽음)
+    m_handler = std::move(handler);
+    if (m_workers.empty())
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            m_workers.emplace_back(new Worker(m_queueCapacity));
+        }
+    }
+    m_running = true;
+    for (auto& worker : m_workers)
+    {
+        worker->thread = std::thread(&IngestPipeline::workerLoop, this, std::ref(*worker));
+    }
+}
+
+void IngestPipeline::stop()
+{
+    if (!m_running)
+        return;
+
+    m_running = false;
+    for (auto& worker : m_workers)
+    {
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+        }
+        worker->cv.notify_all();
+    }
+    for (auto& worker : m_workers)
+    {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+}
+
+bool IngestPipeline::submit(uint32_t source, std::string_view line, int64_t receivedUs)
+{
+    if (!m_running.load(std::memory_order_acquire) || line.size() > RawLine::kMaxLength)
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // 같은 디바이스는 항상 같은 worker로 보내서 디바이스별 순서 유지
+    Worker& worker = *m_workers[source % m_workers.size()];
+    bool pushed = worker.queue.tryEmplace([&](RawLine& slot) {
+        slot.source = source;
+        slot.length = static_cast<uint32_t>(line.size());
+        slot.receivedUs = receivedUs;
+        std::memcpy(slot.data, line.data(), line.size());
+    });
+
+    if (!pushed)
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_submitted.fetch_add(1, std::memory_order_relaxed);
+
+    // worker가 잠들어 있을 때만 깨움 (평소에는 락 없음)
+    if (worker.sleeping.load())
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.cv.notify_one();
+    }
+    return true;
+}
+
+size_t IngestPipeline::queueDepth() const
+{
+    size_t depth = 0;
+    for (auto& worker : m_workers)
+        depth += worker->queue.sizeApprox();
+    return depth;
+}
+
+void IngestPipeline::workerLoop(Worker& worker)
+{
+    auto handle = [this](const RawLine& line) {
+        m_handler(line);
+        m_processed.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    int idle = 0;
+    while (true)
+    {
+        if (worker.queue.tryConsume(handle))
+        {
+            idle = 0;
+            continue;
+        }
+
+        if (!m_running)
+        {
+            // 종료 요청 후 큐가 비었으면 끝
+            break;
+        }
+
+        if (++idle < kSpinCount)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // 잠들기 전에 sleeping을 먼저 알리고 큐를 다시 확인 (깨우기 누락 방지)
+        std::unique_lock<std::mutex> lock(worker.mutex);
+        worker.sleeping.store(true);
+        if (worker.queue.sizeApprox() == 0 && m_running)
+        {
+            worker.cv.wait_for(lock, kIdleWait);
+        }
+        worker.sleeping.store(false);
+        idle = 0;
+    }
+}
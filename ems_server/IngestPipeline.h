@@ -0,0 +1,83 @@
+#ifndef INGESTPIPELINE_H
+#define INGESTPIPELINE_H
+
+#include "MpmcQueue.h"
+#include <string_view>
+#include <functional>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+// 수신 스레드가 넘겨주는 센서 한 줄 (큐 칸에 그대로 들어가는 고정 크기)
+struct RawLine
+{
+    static constexpr size_t kMaxLength = 240;
+
+    uint32_t source;        // 보낸 디바이스 번호 (같은 source는 같은 worker가 순서대로 처리)
+    uint32_t length;
+    int64_t receivedUs;     // 수신 시각 (Unix epoch 마이크로초)
+    char data[kMaxLength];
+
+    std::string_view text() const { return std::string_view(data, length); }
+};
+
+// 센서 수신과 파싱/DB 저장을 분리하는 worker 풀
+// 수신 스레드는 submit으로 lock-free 큐에 복사만 하고 바로 돌아감 (큐가 가득 차면 버림)
+class IngestPipeline
+{
+public:
+    using Handler = std::function<void(const RawLine& line)>;
+
+    IngestPipeline();
+    ~IngestPipeline();
+    IngestPipeline(const IngestPipeline&) = delete;
+    IngestPipeline& operator=(const IngestPipeline&) = delete;
+
+    // start 전에 호출 (workers가 0이면 CPU 수에 맞춤)
+    void configure(size_t workers, size_t queueCapacity);
+
+    void start(Handler handler);
+
+    // 큐에 남은 줄을 모두 처리한 뒤 worker 스레드 종료
+    // (Worker 객체는 소멸자까지 남겨서 종료 중에도 queueDepth를 안전하게 읽을 수 있음)
+    void stop();
+
+    // 수신 스레드에서 호출 (절대 대기하지 않음, 버려지면 false)
+    bool submit(uint32_t source, std::string_view line, int64_t receivedUs);
+
+    size_t workerCount() const { return m_workers.size(); }
+    size_t queueDepth() const;
+    uint64_t submittedLines() const { return m_submitted.load(std::memory_order_relaxed); }
+    uint64_t droppedLines() const { return m_dropped.load(std::memory_order_relaxed); }
+    uint64_t processedLines() const { return m_processed.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker
+    {
+        explicit Worker(size_t capacity) : queue(capacity) {}
+
+        MpmcQueue<RawLine> queue;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::atomic<bool> sleeping{false};
+        std::thread thread;
+    };
+
+    void workerLoop(Worker& worker);
+
+    size_t m_workerCount;
+    size_t m_queueCapacity;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    Handler m_handler;
+    std::atomic<bool> m_running;
+
+    std::atomic<uint64_t> m_submitted;
+    std::atomic<uint64_t> m_dropped;
+    std::atomic<uint64_t> m_processed;
+};
+
+#endif // INGESTPIPELINE_H
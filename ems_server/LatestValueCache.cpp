@@ -0,0 +1,266 @@
+#include "LatestValueCache.h"
+#include "BinaryProtocol.h"
+#include <cstring>
+#include <cstdio>
+#include <type_traits>
+
+namespace
+{
+
+static_assert(std::is_trivially_copyable<SensorSample>::value,
+              "SensorSample is copied word by word through the seqlock");
+
+static_assert((LatestValueCache::kMaxDevices * 2 & (LatestValueCache::kMaxDevices * 2 - 1)) == 0,
+              "index size must be a power of two");
+
+// FNV-1a (home 번호로 시작값을 섞음)
+size_t slotHash(uint32_t homeId, std::string_view name)
+{
+    uint64_t hash = 14695981039346656037ull ^ homeId;
+    for (char c : name)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return static_cast<size_t>(hash);
+}
+
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+} // namespace
+
+LatestValueCache::LatestValueCache()
+    : m_count(0)
+{
+    for (Slot& slot : m_slots)
+    {
+        for (auto& word : slot.words)
+            word.store(0, std::memory_order_relaxed);
+        slot.name[0] = '\0';
+    }
+    for (auto& entry : m_index)
+        entry.store(-1, std::memory_order_relaxed);
+}
+
+// 해시 색인에서 (home, 이름)이 같은 슬롯 검색 (빈 칸을 만나면 없음)
+int LatestValueCache::findSlot(uint32_t homeId, std::string_view device) const
+{
+    size_t mask = kIndexSize - 1;
+    for (size_t probe = slotHash(homeId, device) & mask;; probe = (probe + 1) & mask)
+    {
+        int index = m_index[probe].load(std::memory_order_acquire);
+        if (index < 0)
+            return -1;
+        const Slot& slot = m_slots[index];
+        if (slot.homeId == homeId && std::string_view(slot.name, slot.nameLength) == device)
+            return index;
+    }
+}
+
+int LatestValueCache::claimSlot(uint32_t homeId, std::string_view device)
+{
+    if (device.size() > kMaxNameLength)
+        device = device.substr(0, kMaxNameLength);
+
+    std::lock_guard<std::mutex> lock(m_claimMutex);
+    int index = findSlot(homeId, device);
+    if (index >= 0)
+        return index;
+
+    size_t count = m_count.load(std::memory_order_relaxed);
+    if (count == kMaxDevices)
+        return -1;
+
+    Slot& slot = m_slots[count];
+    slot.homeId = homeId;
+    std::memcpy(slot.name, device.data(), device.size());
+    slot.name[device.size()] = '\0';
+    slot.nameLength = device.size();
+    m_count.store(count + 1, std::memory_order_release);
+
+    // 슬롯을 채운 뒤에 색인에 공개 (읽는 쪽은 acquire로 색인을 읽고 슬롯 이름 비교)
+    size_t mask = kIndexSize - 1;
+    size_t probe = slotHash(homeId, device) & mask;
+    while (m_index[probe].load(std::memory_order_relaxed) >= 0)
+        probe = (probe + 1) & mask;
+    m_index[probe].store(static_cast<int16_t>(count), std::memory_order_release);
+    return static_cast<int>(count);
+}
+
+void LatestValueCache::write(uint32_t homeId, std::string_view device, int64_t timeUs, const SensorSample& sample)
+{
+    int index = findSlot(homeId, device.substr(0, kMaxNameLength));
+    if (index < 0)
+        index = claimSlot(homeId, device);
+    if (index < 0)
+        return;
+
+    store(m_slots[index], timeUs, sample);
+}
+
+// 같은 종류의 디바이스가 서로 다른 worker에서 들어올 수 있으므로 짝수→홀수 CAS로 기록자끼리도 배제
+void LatestValueCache::store(Slot& slot, int64_t timeUs, const SensorSample& sample)
+{
+    Payload payload{timeUs, sample};
+    uint64_t words[kWords] = {};
+    std::memcpy(words, &payload, sizeof(payload));
+
+    uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    while (true)
+    {
+        if ((sequence & 1) == 0 &&
+            slot.sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_relaxed))
+            break;
+        cpuRelax();
+        sequence = slot.sequence.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < kWords; ++i)
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool LatestValueCache::load(const Slot& slot, LatestValue& value) const
+{
+    uint64_t words[kWords];
+    while (true)
+    {
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before == 0)
+            return false;           // 아직 기록된 적 없음
+        if (before & 1)
+        {
+            cpuRelax();
+            continue;
+        }
+
+        for (size_t i = 0; i < kWords; ++i)
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before)
+        {
+            Payload payload;
+            std::memcpy(&payload, words, sizeof(payload));
+            value.timeUs = payload.timeUs;
+            value.updates = before / 2;
+            value.sample = payload.sample;
+            return true;
+        }
+    }
+}
+
+bool LatestValueCache::read(uint32_t homeId, std::string_view name, std::string& device, LatestValue& value) const
+{
+    int index = findSlot(homeId, name);
+    if (index >= 0)
+    {
+        if (!load(m_slots[index], value))
+            return false;
+        device.assign(m_slots[index].name, m_slots[index].nameLength);
+        return true;
+    }
+
+    int type = findSampleType(name);
+    if (type < 0)
+        return false;
+
+    // 같은 종류 중 가장 최근 값
+    bool found = false;
+    size_t count = m_count.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i)
+    {
+        LatestValue candidate;
+        if (m_slots[i].homeId != homeId || !load(m_slots[i], candidate) || static_cast<int>(candidate.sample.index()) != type)
+            continue;
+        if (!found || candidate.timeUs > value.timeUs)
+        {
+            value = candidate;
+            device.assign(m_slots[i].name, m_slots[i].nameLength);
+            found = true;
+        }
+    }
+    return found;
+}
+
+// "device=fireModule type=fire time_us=... age_ms=... updates=... fireData=150 gasData=650.5"
+void LatestValueCache::formatValue(std::string_view device, const LatestValue& value, int64_t nowUs, std::string& out)
+{
+    char buffer[256];
+    int length = std::snprintf(buffer, sizeof(buffer), "device=%.*s type=%s time_us=%lld age_ms=%lld updates=%llu",
+                               static_cast<int>(device.size()), device.data(),
+                               sampleTypeName(value.sample),
+                               static_cast<long long>(value.timeUs),
+                               static_cast<long long>((nowUs - value.timeUs) / 1000),
+                               static_cast<unsigned long long>(value.updates));
+    out.append(buffer, static_cast<size_t>(length));
+    appendSampleFields(out, value.sample);
+    out += '\n';
+}
+
+void LatestValueCache::formatGet(uint32_t homeId, std::string_view name, int64_t nowUs, std::string& out) const
+{
+    std::string device;
+    LatestValue value;
+    if (!read(homeId, name, device, value))
+    {
+        out += "ERR_NO_DATA ";
+        out.append(name.data(), name.size());
+        out += '\n';
+        return;
+    }
+
+    out += "OK_VALUE ";
+    formatValue(device, value, nowUs, out);
+}
+
+void LatestValueCache::formatSnapshot(uint32_t homeId, int64_t nowUs, std::string& out) const
+{
+    // 줄 수를 먼저 알려야 하므로 값부터 모두 읽음 (기록된 적 없는 디바이스와 다른 home은 제외)
+    size_t count = m_count.load(std::memory_order_acquire);
+    LatestValue values[kMaxDevices];
+    bool present[kMaxDevices];
+    size_t lines = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        present[i] = m_slots[i].homeId == homeId && load(m_slots[i], values[i]);
+        if (present[i])
+            ++lines;
+    }
+
+    out += "OK_SNAPSHOT count=";
+    out += std::to_string(lines);
+    out += '\n';
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (present[i])
+            formatValue(std::string_view(m_slots[i].name, m_slots[i].nameLength), values[i], nowUs, out);
+    }
+}
+
+void LatestValueCache::encodeSnapshot(uint32_t homeId, std::string& out) const
+{
+    size_t countOffset = out.size();
+    out.append(2, '\0');
+
+    size_t count = m_count.load(std::memory_order_acquire);
+    uint16_t records = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        LatestValue value;
+        if (m_slots[i].homeId != homeId || !load(m_slots[i], value))
+            continue;
+        appendSampleRecord(out, std::string_view(m_slots[i].name, m_slots[i].nameLength),
+                           value.timeUs, value.updates, value.sample);
+        ++records;
+    }
+    out[countOffset] = static_cast<char>(records >> 8);
+    out[countOffset + 1] = static_cast<char>(records);
+}
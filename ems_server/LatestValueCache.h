@@ -0,0 +1,84 @@
+#ifndef LATESTVALUECACHE_H
+#define LATESTVALUECACHE_H
+
+#include "SensorSink.h"
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+
+// 디바이스 하나의 마지막 샘플 (읽기 쪽 복사본)
+struct LatestValue
+{
+    int64_t timeUs;             // 수신 시각 (Unix epoch 마이크로초)
+    uint64_t updates;           // 지금까지 갱신된 횟수 (seqlock sequence에서 계산)
+    SensorSample sample;
+};
+
+// 디바이스별 최신 센서 값 표 (TCP get/snapshot 명령으로 조회)
+// 디바이스마다 캐시 라인 경계에 정렬된 슬롯을 따로 두고 seqlock으로 기록하므로
+// 읽기는 락 없이 동작하고 ingest worker의 기록을 막지 않음 (기록 중이면 다시 읽음)
+// 슬롯은 (home, 디바이스 이름)으로 구분하고, 조회는 해시 색인으로 해서 home이 많아도 선형 검색하지 않음
+class LatestValueCache : public SensorSink
+{
+public:
+    static constexpr size_t kMaxDevices = 256;
+    static constexpr size_t kMaxNameLength = 31;
+
+    LatestValueCache();
+    LatestValueCache(const LatestValueCache&) = delete;
+    LatestValueCache& operator=(const LatestValueCache&) = delete;
+
+    // SensorSink: 디바이스 슬롯 갱신 (처음 보는 디바이스면 슬롯 할당, 표가 가득 차면 버림)
+    void write(uint32_t homeId, std::string_view device, int64_t timeUs, const SensorSample& sample) override;
+
+    // name이 디바이스 이름이면 그 디바이스, 모듈 종류("fire", "pet", "plant")면
+    // 그 종류 중 가장 최근에 갱신된 디바이스의 값을 읽음 (homeId의 디바이스만)
+    bool read(uint32_t homeId, std::string_view name, std::string& device, LatestValue& value) const;
+
+    // TCP 응답 형식으로 out 뒤에 추가 (한 줄: OK_VALUE ... / ERR_NO_DATA ...)
+    void formatGet(uint32_t homeId, std::string_view name, int64_t nowUs, std::string& out) const;
+
+    // homeId의 모든 디바이스: "OK_SNAPSHOT count=N" 다음에 디바이스마다 한 줄
+    void formatSnapshot(uint32_t homeId, int64_t nowUs, std::string& out) const;
+
+    // 바이너리 Snapshot payload: u16 개수 다음에 디바이스마다 샘플 레코드 (BinaryProtocol.h)
+    void encodeSnapshot(uint32_t homeId, std::string& out) const;
+
+    size_t deviceCount() const { return m_count.load(std::memory_order_acquire); }
+
+private:
+    // 기록 중에는 sequence가 홀수, 읽는 쪽은 앞뒤 sequence가 같은 짝수일 때만 값을 사용
+    // 값은 relaxed 원자 단어로 복사해서 데이터 경쟁 없이 seqlock 구현
+    struct Payload
+    {
+        int64_t timeUs;
+        SensorSample sample;
+    };
+    static constexpr size_t kWords = (sizeof(Payload) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    static constexpr size_t kIndexSize = kMaxDevices * 2;      // 2의 거듭제곱, 항상 빈 칸이 남음
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<uint64_t> words[kWords];
+        uint32_t homeId = 0;                 // 슬롯이 공개된 뒤에는 바뀌지 않음
+        char name[kMaxNameLength + 1];
+        size_t nameLength = 0;
+    };
+
+    int findSlot(uint32_t homeId, std::string_view device) const;
+    int claimSlot(uint32_t homeId, std::string_view device);
+    void store(Slot& slot, int64_t timeUs, const SensorSample& sample);
+    bool load(const Slot& slot, LatestValue& value) const;
+    static void formatValue(std::string_view device, const LatestValue& value, int64_t nowUs, std::string& out);
+
+    Slot m_slots[kMaxDevices];
+    std::atomic<size_t> m_count;        // 공개된 슬롯 수 (이름이 채워진 뒤 증가)
+    std::atomic<int16_t> m_index[kIndexSize];   // (home, 이름) 해시 → 슬롯 번호 (-1: 빈 칸, 채우면 바뀌지 않음)
+    std::mutex m_claimMutex;            // 새 디바이스 슬롯 할당만 직렬화
+};
+
+#endif // LATESTVALUECACHE_H
@@ -0,0 +1,132 @@
+#include "Lifecycle.h"
+#include "Logger.h"
+
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/signalfd.h>
+#include <sys/eventfd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+
+Lifecycle::Lifecycle()
+    : m_signalFd(-1),
+      m_wakeFd(-1),
+      m_stopRequested(false)
+{
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGHUP);
+    if (pthread_sigmask(SIG_BLOCK, &mask, nullptr) != 0)
+        perror("시그널 마스크 설정 실패");
+
+    m_signalFd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_signalFd < 0 || m_wakeFd < 0)
+        perror("signalfd/eventfd 생성 실패");
+}
+
+Lifecycle::~Lifecycle()
+{
+    if (m_signalFd >= 0)
+        close(m_signalFd);
+    if (m_wakeFd >= 0)
+        close(m_wakeFd);
+}
+
+void Lifecycle::requestStop()
+{
+    m_stopRequested.store(true, std::memory_order_release);
+    uint64_t one = 1;
+    ssize_t ignored = write(m_wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+int Lifecycle::waitForStop()
+{
+    while (true)
+    {
+        struct pollfd fds[2];
+        fds[0].fd = m_signalFd;
+        fds[0].events = POLLIN;
+        fds[1].fd = m_wakeFd;
+        fds[1].events = POLLIN;
+        int ret = poll(fds, 2, -1);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("종료 신호 대기 실패");
+            return 0;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            struct signalfd_siginfo info;
+            if (read(m_signalFd, &info, sizeof(info)) == static_cast<ssize_t>(sizeof(info)))
+            {
+                // SIGHUP: 설정 다시 읽기 (종료하지 않고 계속 대기)
+                if (info.ssi_signo == SIGHUP)
+                {
+                    LOG_INFO("SIGHUP 받음, 설정 다시 읽기");
+                    if (m_reloadHandler)
+                        m_reloadHandler();
+                    continue;
+                }
+                m_stopRequested.store(true, std::memory_order_release);
+                return static_cast<int>(info.ssi_signo);
+            }
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            uint64_t value;
+            ssize_t ignored = read(m_wakeFd, &value, sizeof(value));
+            (void)ignored;
+            if (stopRequested())
+                return 0;
+        }
+    }
+}
+
+void Lifecycle::setReloadHandler(std::function<void()> handler)
+{
+    m_reloadHandler = std::move(handler);
+}
+
+void Lifecycle::addStage(const std::string& name, Stage stage)
+{
+    m_stages.push_back(Entry{name, std::move(stage)});
+}
+
+bool Lifecycle::shutdown(std::chrono::milliseconds budget)
+{
+    m_stopRequested.store(true, std::memory_order_release);
+
+    auto begin = Clock::now();
+    auto deadline = begin + budget;
+    for (Entry& entry : m_stages)
+    {
+        auto stageBegin = Clock::now();
+        entry.stage(deadline);
+        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - stageBegin).count();
+        LOG_INFO("종료 단계 완료: %s (%lld ms)", entry.name.c_str(), static_cast<long long>(elapsedMs));
+    }
+
+    auto totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - begin).count();
+    bool inTime = Clock::now() <= deadline;
+    if (inTime)
+        LOG_INFO("종료 완료 (%lld ms)", static_cast<long long>(totalMs));
+    else
+        LOG_WARN("종료 기한 초과 (%lld ms, 기한 %lld ms)", static_cast<long long>(totalMs),
+                 static_cast<long long>(budget.count()));
+    return inTime;
+}
+
+std::chrono::milliseconds remainingUntil(Lifecycle::Clock::time_point deadline)
+{
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Lifecycle::Clock::now());
+    return remaining.count() > 0 ? remaining : std::chrono::milliseconds(0);
+}
@@ -0,0 +1,61 @@
+#ifndef LIFECYCLE_H
+#define LIFECYCLE_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <chrono>
+
+// 종료 신호 대기와 종료 순서 관리
+// - 생성할 때 SIGINT/SIGTERM/SIGHUP을 막아서 이후 만든 모든 스레드가 상속 → 신호는 signalfd로만 받음
+//   (시그널 핸들러에서 async-signal-safe하지 않은 함수를 부를 일이 없음)
+// - SIGHUP은 종료하지 않고 waitForStop 안에서 reload 핸들러를 부름 (main 스레드)
+// - 종료 단계는 등록한 순서대로 main 스레드에서 실행 (단계마다 걸린 시간 로그, 전체 기한을 인자로 받음)
+// 다른 스레드를 만들기 전에 main 맨 앞에서 생성해야 함
+class Lifecycle
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Stage = std::function<void(Clock::time_point deadline)>;
+
+    Lifecycle();
+    ~Lifecycle();
+    Lifecycle(const Lifecycle&) = delete;
+    Lifecycle& operator=(const Lifecycle&) = delete;
+
+    // 종료 신호나 requestStop까지 대기 (받은 신호 번호, requestStop이면 0)
+    int waitForStop();
+
+    // 아무 스레드에서나 호출 가능 (eventfd로 waitForStop을 깨움)
+    void requestStop();
+    bool stopRequested() const { return m_stopRequested.load(std::memory_order_acquire); }
+
+    // SIGHUP을 받았을 때 부를 함수 (waitForStop 전에 설정, 없으면 SIGHUP은 무시)
+    void setReloadHandler(std::function<void()> handler);
+
+    // 종료 단계 등록 (등록한 순서대로 실행)
+    void addStage(const std::string& name, Stage stage);
+
+    // 모든 단계를 실행 (budget: 전체 기한, 넘겨도 나머지 단계는 실행해서 스레드를 모두 정리)
+    // 기한 안에 끝났으면 true
+    bool shutdown(std::chrono::milliseconds budget);
+
+private:
+    struct Entry
+    {
+        std::string name;
+        Stage stage;
+    };
+
+    int m_signalFd;
+    int m_wakeFd;
+    std::atomic<bool> m_stopRequested;
+    std::function<void()> m_reloadHandler;
+    std::vector<Entry> m_stages;
+};
+
+// deadline까지 남은 시간 (지났으면 0)
+std::chrono::milliseconds remainingUntil(Lifecycle::Clock::time_point deadline);
+
+#endif // LIFECYCLE_H
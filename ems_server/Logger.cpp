@@ -0,0 +1,296 @@
+#include "Logger.h"
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <algorithm>
+
+namespace
+{
+
+constexpr size_t kThreadBufferRecords = 512;        // 스레드별 대기 레코드 수 (2의 거듭제곱)
+constexpr size_t kRecordTextSize = 236;
+constexpr std::chrono::milliseconds kWriterInterval(10);
+
+const char* levelTag(LogLevel level)
+{
+    switch (level)
+    {
+    case LogLevel::Trace: return "T";
+    case LogLevel::Debug: return "D";
+    case LogLevel::Info:  return "I";
+    case LogLevel::Warn:  return "W";
+    case LogLevel::Error: return "E";
+    case LogLevel::Off:   break;
+    }
+    return "?";
+}
+
+int64_t nowMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void appendRecord(std::string& out, int64_t timeUs, LogLevel level, const char* text, size_t length)
+{
+    time_t seconds = static_cast<time_t>(timeUs / 1000000);
+    struct tm local;
+    localtime_r(&seconds, &local);
+
+    char prefix[32];
+    int n = snprintf(prefix, sizeof(prefix), "%02d:%02d:%02d.%03d [%s] ",
+                     local.tm_hour, local.tm_min, local.tm_sec,
+                     static_cast<int>((timeUs / 1000) % 1000), levelTag(level));
+    out.append(prefix, n);
+    out.append(text, length);
+    out += '\n';
+}
+
+} // namespace
+
+// 스레드 하나의 SPSC 레코드 링 (소유 스레드만 쓰고 writer 스레드만 읽음)
+struct Logger::ThreadBuffer
+{
+    struct Record
+    {
+        int64_t timeUs;
+        LogLevel level;
+        uint32_t length;
+        char text[kRecordTextSize];
+    };
+
+    Record records[kThreadBufferRecords];
+    alignas(64) std::atomic<size_t> head{0};     // writer가 읽을 위치
+    alignas(64) std::atomic<size_t> tail{0};     // 소유 스레드가 쓸 위치
+    std::atomic<bool> orphaned{false};           // 소유 스레드 종료됨 (비우고 나면 제거)
+};
+
+namespace
+{
+
+// 스레드 종료 시 버퍼를 writer에게 넘김 (남은 레코드는 writer가 출력 후 정리)
+struct ThreadBufferHolder
+{
+    std::shared_ptr<Logger::ThreadBuffer> buffer;
+
+    ~ThreadBufferHolder()
+    {
+        if (buffer)
+            buffer->orphaned.store(true, std::memory_order_release);
+    }
+};
+
+thread_local ThreadBufferHolder t_buffer;
+
+} // namespace
+
+// 다른 싱글톤의 소멸자에서도 로그를 남길 수 있도록 소멸시키지 않음 (종료 시 shutdown 호출)
+Logger& Logger::instance()
+{
+    static Logger* instance = new Logger();
+    return *instance;
+}
+
+Logger::Logger()
+    : m_level(static_cast<int>(LogLevel::Info)),
+      m_sampleEvery(1),
+      m_maxPerSecond(50),
+      m_dropped(0),
+      m_running(true),
+      m_flushRequests(0),
+      m_flushesDone(0)
+{
+    m_writer = std::thread(&Logger::writerLoop, this);
+}
+
+Logger::~Logger()
+{
+    shutdown();
+}
+
+void Logger::setSampling(uint32_t sampleEvery, uint32_t maxPerSecond)
+{
+    m_sampleEvery.store(sampleEvery == 0 ? 1 : sampleEvery, std::memory_order_relaxed);
+    m_maxPerSecond.store(maxPerSecond, std::memory_order_relaxed);
+}
+
+Logger::ThreadBuffer* Logger::threadBuffer()
+{
+    if (!t_buffer.buffer)
+    {
+        t_buffer.buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_buffers.push_back(t_buffer.buffer);
+    }
+    return t_buffer.buffer.get();
+}
+
+void Logger::write(LogLevel level, const char* format, ...)
+{
+    if (!m_running.load(std::memory_order_acquire))
+    {
+        // writer 종료 후에는 동기 출력 (종료 과정의 에러 메시지 보존)
+        char text[kRecordTextSize];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(text, sizeof(text), format, args);
+        va_end(args);
+        fprintf(level >= LogLevel::Warn ? stderr : stdout, "[%s] %s\n", levelTag(level), text);
+        return;
+    }
+
+    ThreadBuffer* buffer = threadBuffer();
+    size_t tail = buffer->tail.load(std::memory_order_relaxed);
+    size_t head = buffer->head.load(std::memory_order_acquire);
+    if (tail - head >= kThreadBufferRecords)
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ThreadBuffer::Record& record = buffer->records[tail & (kThreadBufferRecords - 1)];
+    record.timeUs = nowMicros();
+    record.level = level;
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(record.text, sizeof(record.text), format, args);
+    va_end(args);
+
+    if (length < 0)
+        length = 0;
+    record.length = static_cast<uint32_t>(std::min<size_t>(length, sizeof(record.text) - 1));
+
+    buffer->tail.store(tail + 1, std::memory_order_release);
+}
+
+void Logger::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_running)
+        return;
+
+    uint64_t request = ++m_flushRequests;
+    m_cv.notify_one();
+    m_flushedCv.wait(lock, [&] { return m_flushesDone >= request || !m_running; });
+}
+
+void Logger::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running)
+            return;
+        m_running = false;
+    }
+    m_cv.notify_one();
+
+    if (m_writer.joinable())
+        m_writer.join();
+}
+
+void Logger::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_cv.wait_for(lock, kWriterInterval);
+
+        bool running = m_running;
+        uint64_t requested = m_flushRequests;
+        drainAll();
+
+        m_flushesDone = requested;
+        m_flushedCv.notify_all();
+
+        if (!running)
+            break;
+    }
+}
+
+// 모든 스레드 버퍼를 비워서 출력 (m_mutex를 잡은 상태에서 호출)
+bool Logger::drainAll()
+{
+    std::string out;
+    std::string err;
+
+    for (auto it = m_buffers.begin(); it != m_buffers.end();)
+    {
+        ThreadBuffer& buffer = **it;
+        bool orphaned = buffer.orphaned.load(std::memory_order_acquire);
+
+        size_t head = buffer.head.load(std::memory_order_relaxed);
+        size_t tail = buffer.tail.load(std::memory_order_acquire);
+        for (; head != tail; ++head)
+        {
+            const ThreadBuffer::Record& record = buffer.records[head & (kThreadBufferRecords - 1)];
+            appendRecord(record.level >= LogLevel::Warn ? err : out,
+                         record.timeUs, record.level, record.text, record.length);
+        }
+        buffer.head.store(head, std::memory_order_release);
+
+        if (orphaned)
+            it = m_buffers.erase(it);
+        else
+            ++it;
+    }
+
+    uint64_t dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0)
+    {
+        char text[64];
+        int n = snprintf(text, sizeof(text), "로그 버퍼 가득 참 - %llu개 버림",
+                         static_cast<unsigned long long>(dropped));
+        appendRecord(err, nowMicros(), LogLevel::Warn, text, n);
+    }
+
+    if (!out.empty())
+    {
+        fwrite(out.data(), 1, out.size(), stdout);
+        fflush(stdout);
+    }
+    if (!err.empty())
+    {
+        fwrite(err.data(), 1, err.size(), stderr);
+        fflush(stderr);
+    }
+    return !out.empty() || !err.empty();
+}
+
+bool LogSampler::allow(uint64_t& suppressed)
+{
+    Logger& logger = Logger::instance();
+
+    // N개 중 1개만
+    uint32_t every = logger.sampleEvery();
+    uint64_t count = m_count.fetch_add(1, std::memory_order_relaxed);
+    if (every > 1 && count % every != 0)
+    {
+        m_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // 1초 구간마다 최대 개수
+    uint32_t limit = logger.maxPerSecond();
+    if (limit > 0)
+    {
+        int64_t second = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t windowStart = m_windowStart.load(std::memory_order_relaxed);
+        if (second != windowStart &&
+            m_windowStart.compare_exchange_strong(windowStart, second, std::memory_order_relaxed))
+        {
+            m_windowCount.store(0, std::memory_order_relaxed);
+        }
+        if (m_windowCount.fetch_add(1, std::memory_order_relaxed) >= limit)
+        {
+            m_suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
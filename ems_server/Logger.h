@@ -0,0 +1,133 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+enum class LogLevel : int
+{
+    Trace = 0,
+    Debug = 1,
+    Info = 2,
+    Warn = 3,
+    Error = 4,
+    Off = 5
+};
+
+// 이 값보다 낮은 레벨의 LOG_* 호출은 컴파일 단계에서 제거됨
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 1
+#endif
+
+// 비동기 로거
+// 스레드마다 lock-free 링 버퍼에 포맷된 레코드를 넣고, 백그라운드 스레드가 모아서 출력함
+// 호출 스레드는 I/O를 하지 않으며, 버퍼가 가득 차면 레코드를 버리고 집계함
+class Logger
+{
+public:
+    static Logger& instance();
+
+    // 런타임 레벨 (이 값보다 낮은 레벨은 포맷하지 않고 바로 반환)
+    void setLevel(LogLevel level) { m_level.store(static_cast<int>(level), std::memory_order_relaxed); }
+    LogLevel level() const { return static_cast<LogLevel>(m_level.load(std::memory_order_relaxed)); }
+    bool enabled(LogLevel level) const
+    {
+        return static_cast<int>(level) >= m_level.load(std::memory_order_relaxed);
+    }
+
+    // LOG_SAMPLED 호출 위치마다 적용: N개 중 1개만 기록, 초당 최대 개수 제한 (0이면 제한 없음)
+    void setSampling(uint32_t sampleEvery, uint32_t maxPerSecond);
+    uint32_t sampleEvery() const { return m_sampleEvery.load(std::memory_order_relaxed); }
+    uint32_t maxPerSecond() const { return m_maxPerSecond.load(std::memory_order_relaxed); }
+
+    // printf 형식으로 포맷해서 현재 스레드 버퍼에 넣음
+    void write(LogLevel level, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+    // 지금까지 쌓인 레코드를 모두 출력할 때까지 대기
+    void flush();
+
+    // 남은 레코드를 출력하고 백그라운드 스레드 종료 (이후 write는 바로 출력됨)
+    void shutdown();
+
+    uint64_t droppedRecords() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    struct ThreadBuffer;
+
+private:
+    Logger();
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    ThreadBuffer* threadBuffer();
+    void writerLoop();
+    bool drainAll();
+
+    std::atomic<int> m_level;
+    std::atomic<uint32_t> m_sampleEvery;
+    std::atomic<uint32_t> m_maxPerSecond;
+    std::atomic<uint64_t> m_dropped;
+    std::atomic<bool> m_running;
+
+    std::mutex m_mutex;                 // 버퍼 목록 등록/정리용 (기록 경로에서는 사용 안 함)
+    std::condition_variable m_cv;
+    std::condition_variable m_flushedCv;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+    uint64_t m_flushRequests;
+    uint64_t m_flushesDone;
+    std::thread m_writer;
+};
+
+// 호출 위치별 샘플링/속도 제한 상태 (LOG_SAMPLED에서 정적 변수로 사용)
+class LogSampler
+{
+public:
+    // 기록해도 되면 true, 그동안 버려진 개수는 suppressed에 담김
+    bool allow(uint64_t& suppressed);
+
+private:
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_suppressed{0};
+    std::atomic<int64_t> m_windowStart{0};
+    std::atomic<uint32_t> m_windowCount{0};
+};
+
+#define LOG_AT(level, ...)                                                              \
+    do                                                                                  \
+    {                                                                                   \
+        if (static_cast<int>(level) >= LOG_COMPILE_LEVEL && Logger::instance().enabled(level)) \
+            Logger::instance().write(level, __VA_ARGS__);                               \
+    } while (0)
+
+#define LOG_TRACE(...) LOG_AT(LogLevel::Trace, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT(LogLevel::Warn, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogLevel::Error, __VA_ARGS__)
+
+// 샘플 단위로 반복되는 로그용 (Logger::setSampling 설정을 따름)
+#define LOG_SAMPLED(level, format, ...)                                                 \
+    do                                                                                  \
+    {                                                                                   \
+        if (static_cast<int>(level) >= LOG_COMPILE_LEVEL && Logger::instance().enabled(level)) \
+        {                                                                               \
+            static LogSampler logSampler_;                                              \
+            uint64_t logSuppressed_ = 0;                                                \
+            if (logSampler_.allow(logSuppressed_))                                      \
+            {                                                                           \
+                if (logSuppressed_ > 0)                                                 \
+                    Logger::instance().write(level, format " (+%llu suppressed)",       \
+                                             ##__VA_ARGS__,                             \
+                                             static_cast<unsigned long long>(logSuppressed_)); \
+                else                                                                    \
+                    Logger::instance().write(level, format, ##__VA_ARGS__);             \
+            }                                                                           \
+        }                                                                               \
+    } while (0)
+
+#endif // LOGGER_H
@@ -0,0 +1,256 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+
+constexpr double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+void appendNumber(std::string& out, double value)
+{
+    char text[32];
+    int n = snprintf(text, sizeof(text), "%.9g", value);
+    out.append(text, n);
+}
+
+void appendSeries(std::string& out, const std::string& name, const std::string& labels,
+                  const char* extraLabel, double value)
+{
+    out += name;
+    if (!labels.empty() || extraLabel)
+    {
+        out += '{';
+        out += labels;
+        if (extraLabel)
+        {
+            if (!labels.empty())
+                out += ',';
+            out += extraLabel;
+        }
+        out += '}';
+    }
+    out += ' ';
+    appendNumber(out, value);
+    out += '\n';
+}
+
+} // namespace
+
+size_t LatencyHistogram::bucketIndex(uint64_t nanos)
+{
+    if (nanos < static_cast<uint64_t>(kSubBuckets))
+        return static_cast<size_t>(nanos);
+
+    int exponent = 63 - __builtin_clzll(nanos);
+    if (exponent > kMaxExponent)
+        return kBucketCount - 1;
+
+    size_t sub = (nanos >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return static_cast<size_t>(exponent - kSubBucketBits + 1) * kSubBuckets + sub;
+}
+
+// 구간의 대표값 (구간 중간)
+uint64_t LatencyHistogram::bucketValue(size_t index)
+{
+    if (index < static_cast<size_t>(kSubBuckets))
+        return index;
+
+    int exponent = static_cast<int>(index / kSubBuckets) + kSubBucketBits - 1;
+    uint64_t sub = index % kSubBuckets;
+    uint64_t width = 1ULL << (exponent - kSubBucketBits);
+    return ((kSubBuckets + sub) << (exponent - kSubBucketBits)) + width / 2;
+}
+
+void LatencyHistogram::record(uint64_t nanos)
+{
+    m_buckets[bucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(nanos, std::memory_order_relaxed);
+
+    uint64_t current = m_max.load(std::memory_order_relaxed);
+    while (nanos > current &&
+           !m_max.compare_exchange_weak(current, nanos, std::memory_order_relaxed))
+    {
+    }
+}
+
+uint64_t LatencyHistogram::percentile(double q) const
+{
+    // 구간별 값을 한 번씩만 읽어서 합계와 누적값이 같은 스냅샷을 보도록 함
+    uint64_t counts[kBucketCount];
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBucketCount; ++i)
+    {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0)
+        return 0;
+
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total));
+    if (rank >= total)
+        rank = total - 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i)
+    {
+        seen += counts[i];
+        if (seen > rank)
+            return std::min(bucketValue(i), maxNanos());
+    }
+    return maxNanos();
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto& bucket : m_buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+Metrics& Metrics::instance()
+{
+    static Metrics instance;
+    return instance;
+}
+
+Metrics::Entry* Metrics::find(const std::string& name, const std::string& labels, Kind kind)
+{
+    for (auto& entry : m_entries)
+    {
+        if (entry->kind == kind && entry->name == name && entry->labels == labels)
+            return entry.get();
+    }
+    return nullptr;
+}
+
+Counter& Metrics::counter(const std::string& name, const std::string& help,
+                          const std::string& labels)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (Entry* existing = find(name, labels, Kind::Counter))
+        return *existing->counter;
+
+    std::unique_ptr<Entry> entry(new Entry{name, help, labels, Kind::Counter, {}, {}, {}, nullptr});
+    entry->counter.reset(new Counter());
+    Counter& result = *entry->counter;
+    m_entries.push_back(std::move(entry));
+    return result;
+}
+
+LatencyHistogram& Metrics::histogram(const std::string& name, const std::string& help,
+                                     const std::string& labels)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (Entry* existing = find(name, labels, Kind::Histogram))
+        return *existing->histogram;
+
+    std::unique_ptr<Entry> entry(new Entry{name, help, labels, Kind::Histogram, {}, {}, {}, nullptr});
+    entry->histogram.reset(new LatencyHistogram());
+    LatencyHistogram& result = *entry->histogram;
+    m_entries.push_back(std::move(entry));
+    return result;
+}
+
+void Metrics::addCallback(const std::string& name, const std::string& help,
+                          const std::string& labels, Kind kind, ValueFn fn, const void* owner)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (Entry* existing = find(name, labels, kind))
+    {
+        existing->fn = std::move(fn);
+        existing->owner = owner;
+        return;
+    }
+    m_entries.emplace_back(new Entry{name, help, labels, kind, {}, {}, std::move(fn), owner});
+}
+
+void Metrics::gauge(const std::string& name, const std::string& help, const std::string& labels,
+                    ValueFn fn, const void* owner)
+{
+    addCallback(name, help, labels, Kind::Gauge, std::move(fn), owner);
+}
+
+void Metrics::counterFn(const std::string& name, const std::string& help,
+                        const std::string& labels, ValueFn fn, const void* owner)
+{
+    addCallback(name, help, labels, Kind::CounterFn, std::move(fn), owner);
+}
+
+void Metrics::removeOwner(const void* owner)
+{
+    if (!owner)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(),
+                                   [owner](const std::unique_ptr<Entry>& entry) {
+                                       return entry->owner == owner;
+                                   }),
+                    m_entries.end());
+}
+
+std::string Metrics::render() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // 같은 이름의 시계열을 묶어서 HELP/TYPE을 한 번만 출력
+    std::vector<const Entry*> sorted;
+    sorted.reserve(m_entries.size());
+    for (auto& entry : m_entries)
+        sorted.push_back(entry.get());
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const Entry* a, const Entry* b) { return a->name < b->name; });
+
+    std::string out;
+    out.reserve(sorted.size() * 128);
+    const std::string* lastName = nullptr;
+    for (const Entry* entry : sorted)
+    {
+        if (!lastName || *lastName != entry->name)
+        {
+            const char* type = "gauge";
+            if (entry->kind == Kind::Counter || entry->kind == Kind::CounterFn)
+                type = "counter";
+            else if (entry->kind == Kind::Histogram)
+                type = "summary";
+
+            out += "# HELP " + entry->name + ' ' + entry->help + '\n';
+            out += "# TYPE " + entry->name + ' ' + type + '\n';
+            lastName = &entry->name;
+        }
+
+        switch (entry->kind)
+        {
+        case Kind::Counter:
+            appendSeries(out, entry->name, entry->labels, nullptr,
+                         static_cast<double>(entry->counter->value()));
+            break;
+        case Kind::CounterFn:
+        case Kind::Gauge:
+            appendSeries(out, entry->name, entry->labels, nullptr, entry->fn ? entry->fn() : 0.0);
+            break;
+        case Kind::Histogram:
+        {
+            // 누적 값 기준 분위수 (초 단위)
+            const LatencyHistogram& histogram = *entry->histogram;
+            for (double q : kQuantiles)
+            {
+                char label[32];
+                snprintf(label, sizeof(label), "quantile=\"%g\"", q);
+                appendSeries(out, entry->name, entry->labels, label,
+                             histogram.percentile(q) / 1e9);
+            }
+            appendSeries(out, entry->name + "_sum", entry->labels, nullptr,
+                         histogram.sumNanos() / 1e9);
+            appendSeries(out, entry->name + "_count", entry->labels, nullptr,
+                         static_cast<double>(histogram.count()));
+            break;
+        }
+        }
+    }
+    return out;
+}
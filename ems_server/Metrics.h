@@ -0,0 +1,133 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// 단조 증가 카운터 (relaxed 원자 덧셈 한 번)
+class Counter
+{
+public:
+    void inc(uint64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<uint64_t> m_value{0};
+};
+
+// HDR 방식 지연 시간 히스토그램 (나노초 단위 기록)
+// 2의 거듭제곱 구간마다 16개 하위 구간으로 나눠 상대 오차 약 6%로 1ns ~ 약 18분 범위를 기록
+// 기록은 구간 계산 + relaxed 원자 덧셈 세 번이라 락이 없음
+class LatencyHistogram
+{
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxExponent = 40;
+    static constexpr size_t kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+    void record(uint64_t nanos);
+    void record(std::chrono::steady_clock::duration elapsed)
+    {
+        record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t sumNanos() const { return m_sum.load(std::memory_order_relaxed); }
+    uint64_t maxNanos() const { return m_max.load(std::memory_order_relaxed); }
+
+    // q(0~1) 분위수 추정값 (나노초, 기록이 없으면 0)
+    uint64_t percentile(double q) const;
+
+    void reset();
+
+    // 범위 안에서 측정해서 소멸 시 기록
+    class Timer
+    {
+    public:
+        explicit Timer(LatencyHistogram& histogram)
+            : m_histogram(histogram), m_start(std::chrono::steady_clock::now()) {}
+        ~Timer() { m_histogram.record(std::chrono::steady_clock::now() - m_start); }
+
+    private:
+        LatencyHistogram& m_histogram;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+private:
+    static size_t bucketIndex(uint64_t nanos);
+    static uint64_t bucketValue(size_t index);
+
+    std::atomic<uint64_t> m_buckets[kBucketCount] = {};
+    alignas(64) std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+// 메트릭 등록소 (Prometheus 텍스트 형식으로 출력)
+// 카운터/히스토그램은 등록 시 한 번만 만들고 기록 경로에서는 참조만 사용
+// 이미 다른 모듈이 집계하는 값(큐 깊이, 풀 상태 등)은 콜백으로 등록해서 출력할 때 읽음
+class Metrics
+{
+public:
+    using ValueFn = std::function<double()>;
+
+    static Metrics& instance();
+
+    // labels는 Prometheus 형식 문자열 (예: "device=\"fireModule\""), 같은 이름+labels는 같은 객체 반환
+    Counter& counter(const std::string& name, const std::string& help,
+                     const std::string& labels = "");
+    LatencyHistogram& histogram(const std::string& name, const std::string& help,
+                                const std::string& labels = "");
+
+    // owner가 있으면 removeOwner로 함께 해제 (수명이 짧은 객체의 콜백용)
+    void gauge(const std::string& name, const std::string& help, const std::string& labels,
+               ValueFn fn, const void* owner = nullptr);
+    void counterFn(const std::string& name, const std::string& help, const std::string& labels,
+                   ValueFn fn, const void* owner = nullptr);
+    void removeOwner(const void* owner);
+
+    // 텍스트 노출 형식 (text/plain; version=0.0.4)
+    std::string render() const;
+
+private:
+    Metrics() = default;
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    enum class Kind
+    {
+        Counter,
+        CounterFn,
+        Gauge,
+        Histogram
+    };
+
+    struct Entry
+    {
+        std::string name;
+        std::string help;
+        std::string labels;
+        Kind kind;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<LatencyHistogram> histogram;
+        ValueFn fn;
+        const void* owner = nullptr;
+    };
+
+    Entry* find(const std::string& name, const std::string& labels, Kind kind);
+    void addCallback(const std::string& name, const std::string& help, const std::string& labels,
+                     Kind kind, ValueFn fn, const void* owner);
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Entry>> m_entries;
+};
+
+#endif // METRICS_H
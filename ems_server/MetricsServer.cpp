@@ -0,0 +1,190 @@
+#include "MetricsServer.h"
+#include "Metrics.h"
+#include "Logger.h"
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <iostream>
+
+namespace
+{
+
+constexpr size_t kMaxRequestSize = 4096;
+constexpr int kClientTimeoutSec = 2;
+
+bool sendAll(int fd, const char* data, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+void sendResponse(int fd, const char* status, const char* contentType, const std::string& body)
+{
+    char header[256];
+    int n = snprintf(header, sizeof(header),
+                     "HTTP/1.1 %s\r\n"
+                     "Content-Type: %s\r\n"
+                     "Content-Length: %zu\r\n"
+                     "Connection: close\r\n\r\n",
+                     status, contentType, body.size());
+    if (sendAll(fd, header, n))
+        sendAll(fd, body.data(), body.size());
+}
+
+} // namespace
+
+MetricsServer::MetricsServer(int port)
+    : m_port(port), m_listenFd(-1), m_wakeFd(-1), m_running(false)
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+bool MetricsServer::start()
+{
+    if (m_running)
+        return true;
+
+    m_listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_listenFd < 0 || m_wakeFd < 0)
+    {
+        perror("metrics 소켓 생성 실패");
+        stop();
+        return false;
+    }
+
+    int opt = 1;
+    setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(m_port);
+
+    if (bind(m_listenFd, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+        listen(m_listenFd, 16) < 0)
+    {
+        std::cerr << "metrics 바인드 실패: 포트 " << m_port << std::endl;
+        close(m_listenFd);
+        close(m_wakeFd);
+        m_listenFd = m_wakeFd = -1;
+        return false;
+    }
+
+    m_running = true;
+    m_thread = std::thread(&MetricsServer::serveLoop, this);
+
+    std::cout << "metrics 엔드포인트 시작됨 - http://0.0.0.0:" << m_port << "/metrics" << std::endl;
+    return true;
+}
+
+void MetricsServer::stop()
+{
+    if (m_running)
+    {
+        m_running = false;
+        uint64_t one = 1;
+        ssize_t ignored = write(m_wakeFd, &one, sizeof(one));
+        (void)ignored;
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    if (m_listenFd >= 0)
+        close(m_listenFd);
+    if (m_wakeFd >= 0)
+        close(m_wakeFd);
+    m_listenFd = m_wakeFd = -1;
+}
+
+void MetricsServer::serveLoop()
+{
+    struct pollfd fds[2];
+    fds[0].fd = m_listenFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_wakeFd;
+    fds[1].events = POLLIN;
+
+    while (m_running)
+    {
+        int ready = poll(fds, 2, -1);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            LOG_ERROR("metrics poll 오류: %s", strerror(errno));
+            break;
+        }
+        if (fds[1].revents)
+            break;
+        if (!(fds[0].revents & POLLIN))
+            continue;
+
+        int clientSocket = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (clientSocket < 0)
+            continue;
+
+        handleClient(clientSocket);
+        close(clientSocket);
+    }
+}
+
+// 요청 줄만 확인해서 GET /metrics에만 응답
+void MetricsServer::handleClient(int clientSocket)
+{
+    struct timeval timeout;
+    timeout.tv_sec = kClientTimeoutSec;
+    timeout.tv_usec = 0;
+    setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(clientSocket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < kMaxRequestSize)
+    {
+        ssize_t received = recv(clientSocket, buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received <= 0)
+            break;
+        request.append(buffer, received);
+    }
+
+    size_t lineEnd = request.find("\r\n");
+    std::string line = request.substr(0, lineEnd);
+    if (line.compare(0, 13, "GET /metrics ") == 0 || line.compare(0, 13, "GET /metrics?") == 0)
+    {
+        sendResponse(clientSocket, "200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                     Metrics::instance().render());
+    }
+    else if (line.compare(0, 4, "GET ") == 0)
+    {
+        sendResponse(clientSocket, "404 Not Found", "text/plain", "not found\n");
+    }
+    else
+    {
+        sendResponse(clientSocket, "405 Method Not Allowed", "text/plain", "method not allowed\n");
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <thread>
+#include <atomic>
+
+// /metrics HTTP 엔드포인트 (Prometheus 수집용, 명령 포트와 분리)
+// 수집 요청은 몇 초에 한 번이므로 스레드 하나에서 요청을 하나씩 처리하고 응답 후 연결을 닫음
+class MetricsServer
+{
+public:
+    explicit MetricsServer(int port);
+    ~MetricsServer();
+
+    bool start();
+    void stop();
+
+private:
+    void serveLoop();
+    void handleClient(int clientSocket);
+
+    int m_port;
+    int m_listenFd;
+    int m_wakeFd;           // stop() 시 poll을 깨우는 eventfd
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+};
+
+#endif // METRICSSERVER_H
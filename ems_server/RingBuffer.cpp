@@ -0,0 +1,161 @@
+#include "RingBuffer.h"
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+
+size_t roundUpPowerOfTwo(size_t n)
+{
+    size_t p = 1;
+    while (p < n)
+        p *= 2;
+    return p;
+}
+
+} // namespace
+
+RingBuffer::RingBuffer(size_t initialCapacity, size_t maxCapacity)
+    : m_data(roundUpPowerOfTwo(std::max<size_t>(initialCapacity, 16))),
+      m_head(0),
+      m_tail(0),
+      m_maxCapacity(roundUpPowerOfTwo(std::max(maxCapacity, initialCapacity)))
+{
+    m_mask = m_data.size() - 1;
+}
+
+bool RingBuffer::reserve(size_t bytes)
+{
+    if (available() >= bytes)
+        return true;
+
+    size_t needed = size() + bytes;
+    size_t newCapacity = std::min(roundUpPowerOfTwo(needed), m_maxCapacity);
+    if (newCapacity > capacity())
+        grow(newCapacity);
+
+    return available() >= bytes;
+}
+
+// 데이터를 새 버퍼 앞쪽으로 펼쳐서 복사
+void RingBuffer::grow(size_t newCapacity)
+{
+    std::vector<char> data(newCapacity);
+    size_t count = size();
+    copyOut(0, data.data(), count);
+
+    m_data.swap(data);
+    m_mask = m_data.size() - 1;
+    m_head = 0;
+    m_tail = count;
+}
+
+size_t RingBuffer::writableSpans(struct iovec* iov)
+{
+    size_t free = available();
+    if (free == 0)
+        return 0;
+
+    size_t start = m_tail & m_mask;
+    size_t first = std::min(free, capacity() - start);
+    iov[0].iov_base = &m_data[start];
+    iov[0].iov_len = first;
+    if (first == free)
+        return 1;
+
+    iov[1].iov_base = &m_data[0];
+    iov[1].iov_len = free - first;
+    return 2;
+}
+
+void RingBuffer::commitWrite(size_t bytes)
+{
+    m_tail += bytes;
+}
+
+size_t RingBuffer::readableSpans(struct iovec* iov) const
+{
+    size_t count = size();
+    if (count == 0)
+        return 0;
+
+    size_t start = m_head & m_mask;
+    size_t first = std::min(count, capacity() - start);
+    iov[0].iov_base = const_cast<char*>(&m_data[start]);
+    iov[0].iov_len = first;
+    if (first == count)
+        return 1;
+
+    iov[1].iov_base = const_cast<char*>(&m_data[0]);
+    iov[1].iov_len = count - first;
+    return 2;
+}
+
+void RingBuffer::consume(size_t bytes)
+{
+    m_head += std::min(bytes, size());
+    if (m_head == m_tail)
+    {
+        // 비었으면 처음부터 쓰도록 해서 랩어라운드 빈도를 줄임
+        m_head = m_tail = 0;
+    }
+}
+
+bool RingBuffer::append(const char* data, size_t bytes)
+{
+    if (!reserve(bytes))
+        return false;
+
+    size_t start = m_tail & m_mask;
+    size_t first = std::min(bytes, capacity() - start);
+    std::memcpy(&m_data[start], data, first);
+    std::memcpy(&m_data[0], data + first, bytes - first);
+    m_tail += bytes;
+    return true;
+}
+
+size_t RingBuffer::find(char c, size_t offset) const
+{
+    size_t count = size();
+    if (offset >= count)
+        return npos;
+
+    // 최대 두 구간에 대해 memchr
+    size_t start = (m_head + offset) & m_mask;
+    size_t remain = count - offset;
+    size_t first = std::min(remain, capacity() - start);
+
+    const void* hit = std::memchr(&m_data[start], c, first);
+    if (hit)
+        return offset + (static_cast<const char*>(hit) - &m_data[start]);
+
+    if (first < remain)
+    {
+        hit = std::memchr(&m_data[0], c, remain - first);
+        if (hit)
+            return offset + first + (static_cast<const char*>(hit) - &m_data[0]);
+    }
+    return npos;
+}
+
+const char* RingBuffer::contiguous(size_t offset, size_t bytes, std::string& scratch) const
+{
+    size_t start = (m_head + offset) & m_mask;
+    if (start + bytes <= capacity())
+        return &m_data[start];
+
+    scratch.resize(bytes);
+    copyOut(offset, &scratch[0], bytes);
+    return scratch.data();
+}
+
+void RingBuffer::copyOut(size_t offset, char* dst, size_t bytes) const
+{
+    if (bytes == 0)
+        return;
+
+    size_t start = (m_head + offset) & m_mask;
+    size_t first = std::min(bytes, capacity() - start);
+    std::memcpy(dst, &m_data[start], first);
+    std::memcpy(dst + first, &m_data[0], bytes - first);
+}
@@ -0,0 +1,60 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <sys/uio.h>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// 바이트 링 버퍼 (용량은 2의 거듭제곱, maxCapacity까지 2배씩 증가)
+// readv/writev에 바로 넘길 수 있도록 최대 2개의 연속 구간(iovec)으로 노출
+class RingBuffer
+{
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // maxCapacity == initialCapacity이면 고정 크기 버퍼
+    explicit RingBuffer(size_t initialCapacity = 4096, size_t maxCapacity = 64 * 1024);
+
+    size_t size() const { return m_tail - m_head; }
+    size_t capacity() const { return m_data.size(); }
+    size_t available() const { return capacity() - size(); }
+    bool empty() const { return m_head == m_tail; }
+
+    // available() >= bytes가 되도록 확장 (maxCapacity 초과 시 false, 가능한 만큼은 확장됨)
+    bool reserve(size_t bytes);
+
+    // 쓰기 가능한 빈 구간 (readv용), 반환값은 iovec 개수 (0~2)
+    size_t writableSpans(struct iovec* iov);
+    void commitWrite(size_t bytes);
+
+    // 읽을 수 있는 데이터 구간 (writev용), 반환값은 iovec 개수 (0~2)
+    size_t readableSpans(struct iovec* iov) const;
+    void consume(size_t bytes);
+
+    // 데이터 추가 (공간이 부족하면 false, 아무것도 쓰지 않음)
+    bool append(const char* data, size_t bytes);
+
+    // offset 이후 처음 나오는 c의 위치 (head 기준 offset, 없으면 npos)
+    size_t find(char c, size_t offset = 0) const;
+
+    // offset부터 bytes만큼을 연속된 메모리로 반환 (랩어라운드 구간이면 scratch에 복사)
+    const char* contiguous(size_t offset, size_t bytes, std::string& scratch) const;
+    void copyOut(size_t offset, char* dst, size_t bytes) const;
+
+    // offset 위치의 바이트
+    char at(size_t offset) const { return m_data[(m_head + offset) & m_mask]; }
+
+    void clear() { m_head = m_tail = 0; }
+
+private:
+    void grow(size_t newCapacity);
+
+    std::vector<char> m_data;
+    size_t m_mask;
+    size_t m_head;      // 읽기 위치 (단조 증가, m_mask로 인덱싱)
+    size_t m_tail;      // 쓰기 위치
+    size_t m_maxCapacity;
+};
+
+#endif // RINGBUFFER_H
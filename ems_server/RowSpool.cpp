@@ -0,0 +1,649 @@
+#include "RowSpool.h"
+#include "Logger.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace
+{
+
+constexpr uint32_t kSegmentMagic = 0x31505345;      // "ESP1"
+constexpr const char* kSegmentSuffix = ".wal";
+constexpr size_t kRecordHeaderSize = 16;            // crc + 0 + 번호
+constexpr size_t kMinSegmentBytes = 64 << 10;
+constexpr unsigned kPartialPageSyncs = 5;           // 쓰는 중인 마지막 페이지는 최대 이 sync 횟수마다 msync
+
+// 세그먼트 파일 머리 (뒤에 레코드가 capacity개 이어짐)
+struct SegmentHeader
+{
+    uint32_t magic;
+    uint32_t recordSize;
+    uint32_t rowSize;
+    uint32_t reserved;
+    uint64_t firstSeq;
+    uint64_t capacity;
+};
+static_assert(sizeof(SegmentHeader) == 32, "SegmentHeader 크기는 32바이트");
+
+// CRC-32 (IEEE 802.3, 반사 다항식 0xEDB88320)
+struct Crc32Table
+{
+    uint32_t values[256];
+
+    constexpr Crc32Table() : values()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+            values[i] = crc;
+        }
+    }
+};
+
+constexpr Crc32Table kCrcTable;
+
+uint32_t crc32(const void* data, size_t length)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; ++i)
+        crc = kCrcTable.values[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// 레코드의 번호와 행에 대한 crc
+uint32_t recordChecksum(const char* record, size_t rowSize)
+{
+    return crc32(record + 8, 8 + rowSize);
+}
+
+} // namespace
+
+struct RowSpool::Segment
+{
+    std::string path;
+    int fd = -1;
+    char* base = nullptr;
+    size_t size = 0;
+    uint64_t firstSeq = 0;
+    uint64_t capacity = 0;
+
+    ~Segment()
+    {
+        if (base)
+            munmap(base, size);
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    uint64_t endSeq() const { return firstSeq + capacity; }
+
+    char* record(uint64_t seq, size_t recordSize) const
+    {
+        return base + sizeof(SegmentHeader) + (seq - firstSeq) * recordSize;
+    }
+
+    // seq 위치에 번호와 crc가 맞는 레코드가 있으면 true
+    bool valid(uint64_t seq, size_t recordSize, size_t rowSize) const
+    {
+        const char* p = record(seq, recordSize);
+        uint32_t crc;
+        uint64_t stored;
+        std::memcpy(&crc, p, sizeof(crc));
+        std::memcpy(&stored, p + 8, sizeof(stored));
+        return stored == seq && crc == recordChecksum(p, rowSize);
+    }
+};
+
+RowSpool::RowSpool(const char* table, size_t rowSize)
+    : m_table(table),
+      m_rowSize(rowSize),
+      m_recordSize((kRecordHeaderSize + rowSize + 7) & ~size_t(7)),
+      m_open(false),
+      m_ackFd(-1),
+      m_dirFd(-1),
+      m_tail(0),
+      m_ack(0),
+      m_synced(0),
+      m_persistedAck(0),
+      m_lastTail(0),
+      m_partialSyncs(0),
+      m_dropped(0),
+      m_dirDirty(false)
+{
+}
+
+RowSpool::~RowSpool()
+{
+    close();
+}
+
+bool RowSpool::open(const SpoolOptions& options)
+{
+    close();
+    m_options = options;
+    if (m_options.segmentBytes < kMinSegmentBytes)
+        m_options.segmentBytes = kMinSegmentBytes;
+    if (m_options.maxBytes < m_options.segmentBytes)
+        m_options.maxBytes = m_options.segmentBytes;
+
+    if (mkdir(m_options.directory.c_str(), 0755) < 0 && errno != EEXIST)
+    {
+        LOG_ERROR("spool 디렉터리 생성 실패: %s: %s", m_options.directory.c_str(), strerror(errno));
+        return false;
+    }
+
+    m_dirFd = ::open(m_options.directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (m_dirFd < 0)
+    {
+        LOG_ERROR("spool 디렉터리 열기 실패: %s: %s", m_options.directory.c_str(), strerror(errno));
+        return false;
+    }
+
+    std::string ackPath = m_options.directory + "/" + m_table + ".ack";
+    m_ackFd = ::open(ackPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m_ackFd < 0)
+    {
+        LOG_ERROR("spool ack 파일 열기 실패: %s: %s", ackPath.c_str(), strerror(errno));
+        ::close(m_dirFd);
+        m_dirFd = -1;
+        return false;
+    }
+
+    // ack 파일 = 번호 + 비트 반전한 번호 (둘이 맞지 않으면 남은 세그먼트를 처음부터 다시 기록)
+    uint64_t stored[2] = {0, 0};
+    bool hasAck = pread(m_ackFd, stored, sizeof(stored), 0) == static_cast<ssize_t>(sizeof(stored)) &&
+                  stored[1] == ~stored[0];
+    uint64_t ack = hasAck ? stored[0] : 0;
+
+    DIR* dir = opendir(m_options.directory.c_str());
+    if (!dir)
+    {
+        LOG_ERROR("spool 디렉터리 열기 실패: %s: %s", m_options.directory.c_str(), strerror(errno));
+        ::close(m_ackFd);
+        m_ackFd = -1;
+        ::close(m_dirFd);
+        m_dirFd = -1;
+        return false;
+    }
+
+    // "<테이블>-<번호>.wal"을 번호 순서로
+    std::map<uint64_t, std::string> files;
+    std::string prefix = std::string(m_table) + "-";
+    size_t suffixLength = std::strlen(kSegmentSuffix);
+    while (struct dirent* entry = readdir(dir))
+    {
+        std::string fileName = entry->d_name;
+        if (fileName.size() <= prefix.size() + suffixLength ||
+            fileName.compare(0, prefix.size(), prefix) != 0 ||
+            fileName.compare(fileName.size() - suffixLength, suffixLength, kSegmentSuffix) != 0)
+        {
+            continue;
+        }
+        std::string digits = fileName.substr(prefix.size(), fileName.size() - prefix.size() - suffixLength);
+        char* end = nullptr;
+        uint64_t seq = std::strtoull(digits.c_str(), &end, 10);
+        if (!digits.empty() && *end == '\0')
+            files.emplace(seq, m_options.directory + "/" + fileName);
+    }
+    closedir(dir);
+
+    unlink(sparePath().c_str());
+
+    std::deque<std::unique_ptr<Segment>> segments;
+    for (auto& file : files)
+    {
+        std::unique_ptr<Segment> segment = openSegment(file.second);
+        if (!segment)
+        {
+            // 행 구조가 바뀐 이전 버전의 세그먼트 등 (지우지 않고 따로 보관)
+            LOG_WARN("형식이 맞지 않는 spool 세그먼트 제외: %s", file.second.c_str());
+            std::rename(file.second.c_str(), (file.second + ".bad").c_str());
+            continue;
+        }
+        segments.push_back(std::move(segment));
+    }
+
+    if (!segments.empty() && (!hasAck || ack < segments.front()->firstSeq))
+        ack = segments.front()->firstSeq;
+
+    // ack 위치부터 번호가 이어지고 crc가 맞는 레코드까지가 다시 기록할 행
+    // 끊긴 곳 뒤의 세그먼트는 이어 쓸 수 없으므로 지움 (전원이 꺼지며 msync되지 않은 레코드 등)
+    uint64_t tail = ack;
+    bool broken = false;
+    for (auto it = segments.begin(); it != segments.end();)
+    {
+        Segment& segment = **it;
+        if (!broken && segment.endSeq() <= ack)
+        {
+            ++it;       // 이미 기록된 세그먼트 (첫 sync에서 지움)
+            continue;
+        }
+
+        uint64_t start = std::max(ack, segment.firstSeq);
+        if (broken || start != tail)
+        {
+            if (segment.valid(segment.firstSeq, m_recordSize, m_rowSize))
+                LOG_WARN("spool 레코드가 이어지지 않아 세그먼트 삭제: %s", segment.path.c_str());
+            unlink(segment.path.c_str());
+            it = segments.erase(it);
+            broken = true;
+            continue;
+        }
+
+        while (tail < segment.endSeq() && segment.valid(tail, m_recordSize, m_rowSize))
+            ++tail;
+        if (tail < segment.endSeq())
+            broken = true;
+        ++it;
+    }
+
+    // 처음 쓸 세그먼트를 미리 만들어 둠 (없으면 첫 append가 파일을 만들어야 함)
+    if (segments.empty() || tail >= segments.back()->endSeq())
+    {
+        std::unique_ptr<Segment> segment = createSegment(segmentPath(tail), tail);
+        if (segment)
+        {
+            prefault(*segment);
+            segments.push_back(std::move(segment));
+        }
+    }
+
+    // ack 파일, 첫 세그먼트 생성과 복구 중 지운 파일을 디스크에 남김
+    syncDirectory();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_segments = std::move(segments);
+    m_tail = tail;
+    m_ack = ack;
+    m_synced = tail;
+    m_lastTail = tail;
+    m_partialSyncs = 0;
+    m_persistedAck = hasAck ? stored[0] : ~uint64_t(0);
+    m_dropped = 0;
+    m_dirDirty = false;
+    m_open = true;
+
+    if (tail > ack)
+        LOG_INFO("%s spool에서 DB에 기록되지 않은 %llu행 복구", m_table,
+                 static_cast<unsigned long long>(tail - ack));
+    return true;
+}
+
+void RowSpool::close()
+{
+    if (!m_open)
+        return;
+
+    syncSegments(true);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_spare)
+    {
+        unlink(m_spare->path.c_str());
+        m_spare.reset();
+    }
+    m_segments.clear();
+    syncDirectory();
+    ::close(m_ackFd);
+    m_ackFd = -1;
+    ::close(m_dirFd);
+    m_dirFd = -1;
+    m_open = false;
+}
+
+std::string RowSpool::segmentPath(uint64_t firstSeq) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "-%020llu", static_cast<unsigned long long>(firstSeq));
+    return m_options.directory + "/" + m_table + name + kSegmentSuffix;
+}
+
+std::string RowSpool::sparePath() const
+{
+    return m_options.directory + "/" + m_table + ".spare";
+}
+
+std::unique_ptr<RowSpool::Segment> RowSpool::createSegment(const std::string& path, uint64_t firstSeq)
+{
+    std::unique_ptr<Segment> segment(new Segment());
+    segment->path = path;
+    segment->firstSeq = firstSeq;
+    segment->capacity = (m_options.segmentBytes - sizeof(SegmentHeader)) / m_recordSize;
+    segment->size = sizeof(SegmentHeader) + segment->capacity * m_recordSize;
+
+    segment->fd = ::open(segment->path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (segment->fd < 0)
+    {
+        LOG_SAMPLED(LogLevel::Error, "spool 세그먼트 생성 실패: %s: %s", segment->path.c_str(), strerror(errno));
+        return nullptr;
+    }
+
+    // 디스크 공간을 미리 잡아 둠 (공간이 없을 때 mmap 쓰기가 SIGBUS로 죽지 않도록)
+    int error = posix_fallocate(segment->fd, 0, static_cast<off_t>(segment->size));
+    void* mapped = MAP_FAILED;
+    if (error == 0)
+    {
+        mapped = mmap(nullptr, segment->size, PROT_READ | PROT_WRITE, MAP_SHARED, segment->fd, 0);
+        if (mapped == MAP_FAILED)
+            error = errno;
+    }
+    if (error != 0)
+    {
+        LOG_SAMPLED(LogLevel::Error, "spool 세그먼트 생성 실패: %s: %s", segment->path.c_str(), strerror(error));
+        unlink(segment->path.c_str());
+        return nullptr;
+    }
+    segment->base = static_cast<char*>(mapped);
+
+    SegmentHeader header = {};
+    header.magic = kSegmentMagic;
+    header.recordSize = static_cast<uint32_t>(m_recordSize);
+    header.rowSize = static_cast<uint32_t>(m_rowSize);
+    header.firstSeq = firstSeq;
+    header.capacity = segment->capacity;
+    std::memcpy(segment->base, &header, sizeof(header));
+    return segment;
+}
+
+std::unique_ptr<RowSpool::Segment> RowSpool::openSegment(const std::string& path)
+{
+    std::unique_ptr<Segment> segment(new Segment());
+    segment->path = path;
+    segment->fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    struct stat info;
+    if (segment->fd < 0 || fstat(segment->fd, &info) < 0 ||
+        static_cast<size_t>(info.st_size) < sizeof(SegmentHeader))
+    {
+        return nullptr;
+    }
+
+    segment->size = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, segment->size, PROT_READ | PROT_WRITE, MAP_SHARED, segment->fd, 0);
+    if (mapped == MAP_FAILED)
+        return nullptr;
+    segment->base = static_cast<char*>(mapped);
+
+    SegmentHeader header;
+    std::memcpy(&header, segment->base, sizeof(header));
+    if (header.magic != kSegmentMagic || header.recordSize != m_recordSize || header.rowSize != m_rowSize ||
+        sizeof(SegmentHeader) + header.capacity * m_recordSize > segment->size)
+    {
+        return nullptr;
+    }
+
+    segment->firstSeq = header.firstSeq;
+    segment->capacity = header.capacity;
+    return segment;
+}
+
+// 첫 쓰기 페이지 폴트(ext4는 unwritten extent 변환까지)를 append 대신 미리 처리
+void RowSpool::prefault(Segment& segment)
+{
+    std::memset(segment.base + sizeof(SegmentHeader), 0, segment.size - sizeof(SegmentHeader));
+}
+
+// 쓰는 세그먼트가 가득 찼을 때 다음 세그먼트로 넘어감 (m_mutex 잡은 상태)
+bool RowSpool::nextSegment()
+{
+    std::unique_ptr<Segment> segment;
+    if (m_spare && m_spare->firstSeq == m_tail)
+    {
+        // 미리 만든 파일의 이름만 바꿔서 사용
+        std::string path = segmentPath(m_tail);
+        if (std::rename(m_spare->path.c_str(), path.c_str()) == 0)
+        {
+            segment = std::move(m_spare);
+            segment->path = path;
+        }
+    }
+    if (!segment)
+    {
+        if (m_spare)
+        {
+            unlink(m_spare->path.c_str());
+            m_spare.reset();
+        }
+        segment = createSegment(segmentPath(m_tail), m_tail);
+        if (!segment)
+            return false;
+    }
+    m_segments.push_back(std::move(segment));
+    m_dirDirty = true;     // 다음 sync()가 레코드를 msync한 뒤 디렉터리도 fsync
+
+    // 보관량을 넘으면 DB에 기록되지 않은 가장 오래된 세그먼트를 버림 (파일은 sync()가 지움)
+    size_t live = 0;
+    for (const auto& s : m_segments)
+    {
+        if (s->endSeq() > m_ack)
+            ++live;
+    }
+    for (const auto& s : m_segments)
+    {
+        if (live <= 1 || live * m_options.segmentBytes <= m_options.maxBytes)
+            break;
+        if (s->endSeq() <= m_ack)
+            continue;
+
+        uint64_t lost = s->endSeq() - std::max(m_ack, s->firstSeq);
+        m_dropped += lost;
+        m_ack = s->endSeq();
+        --live;
+        LOG_SAMPLED(LogLevel::Warn, "%s spool 보관량 초과 - 가장 오래된 %llu행 버림", m_table,
+                    static_cast<unsigned long long>(lost));
+    }
+    return true;
+}
+
+uint64_t RowSpool::append(const void* row)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_open)
+        return 0;
+
+    if (m_segments.empty() || m_tail >= m_segments.back()->endSeq())
+    {
+        if (!nextSegment())
+            return 0;
+    }
+
+    char* record = m_segments.back()->record(m_tail, m_recordSize);
+    uint32_t zero = 0;
+    std::memcpy(record + 4, &zero, sizeof(zero));
+    std::memcpy(record + 8, &m_tail, sizeof(m_tail));
+    std::memcpy(record + kRecordHeaderSize, row, m_rowSize);
+    uint32_t crc = recordChecksum(record, m_rowSize);
+    std::memcpy(record, &crc, sizeof(crc));
+
+    ++m_tail;
+    return m_tail - m_ack;
+}
+
+size_t RowSpool::read(void* out, size_t max, uint64_t& first)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    first = m_ack;
+    size_t count = static_cast<size_t>(std::min<uint64_t>(max, m_tail - m_ack));
+
+    char* dst = static_cast<char*>(out);
+    auto it = m_segments.begin();
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint64_t seq = first + i;
+        while ((*it)->endSeq() <= seq)
+            ++it;
+        std::memcpy(dst + i * m_rowSize, (*it)->record(seq, m_recordSize) + kRecordHeaderSize, m_rowSize);
+    }
+    return count;
+}
+
+void RowSpool::ack(uint64_t first, size_t count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ack = std::max(m_ack, first + count);
+}
+
+void RowSpool::sync()
+{
+    syncSegments(false);
+}
+
+// msync한 페이지는 다시 쓸 때 쓰기 보호 폴트(ext4는 저널 처리까지)가 나므로
+// append가 계속 쓰는 마지막 페이지는 추가가 멈췄거나 kPartialPageSyncs번째 sync에서만 내림
+// (가득 찬 페이지는 다시 쓰지 않으므로 매번 msync)
+void RowSpool::syncSegments(bool closing)
+{
+    struct Range
+    {
+        char* begin;
+        size_t length;
+    };
+    static const uintptr_t pageMask = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE)) - 1;
+    std::vector<Range> ranges;
+    uint64_t synced;
+    uint64_t tail;
+    uint64_t ack;
+    bool needSpare;
+    uint64_t spareSeq;
+    bool dirDirty;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_open)
+            return;
+        dirDirty = m_dirDirty;
+        m_dirDirty = false;
+
+        // 마지막 sync 뒤에 추가된 레코드 구간 (세그먼트는 이 스레드만 지우므로 락 밖에서 msync)
+        tail = m_tail;
+        ack = m_ack;
+        bool wholeTail = closing || tail == m_lastTail || ++m_partialSyncs >= kPartialPageSyncs;
+        m_lastTail = tail;
+        synced = m_synced;
+        for (const auto& segment : m_segments)
+        {
+            uint64_t from = std::max(m_synced, segment->firstSeq);
+            uint64_t to = std::min(tail, segment->endSeq());
+            if (from >= to)
+                continue;
+            char* begin = segment->record(from, m_recordSize);
+            char* end = segment->record(to, m_recordSize);
+            if (!wholeTail && to == tail && to < segment->endSeq())
+            {
+                // 마지막 페이지 앞까지의 레코드만
+                end = reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(end) & ~pageMask);
+                to = segment->firstSeq + (end - segment->record(segment->firstSeq, m_recordSize)) / m_recordSize;
+                if (to <= from)
+                    continue;
+                end = segment->record(to, m_recordSize);
+            }
+            ranges.push_back(Range{begin, static_cast<size_t>(end - begin)});
+            synced = to;
+        }
+        if (wholeTail)
+        {
+            synced = tail;
+            m_partialSyncs = 0;
+        }
+        needSpare = !closing && !m_spare;
+        spareSeq = m_segments.empty() ? m_tail : m_segments.back()->endSeq();
+    }
+
+    for (const Range& range : ranges)
+    {
+        uintptr_t begin = reinterpret_cast<uintptr_t>(range.begin);
+        uintptr_t aligned = begin & ~pageMask;
+        if (msync(reinterpret_cast<void*>(aligned), range.length + (begin - aligned), MS_SYNC) < 0)
+            LOG_SAMPLED(LogLevel::Error, "%s spool msync 실패: %s", m_table, strerror(errno));
+    }
+
+    // 새 세그먼트의 디렉터리 항목이 없으면 msync한 레코드도 전원이 꺼질 때 사라짐
+    if (dirDirty)
+        syncDirectory();
+
+    if (ack != m_persistedAck)
+        persistAck(ack);
+
+    std::unique_ptr<Segment> spare;
+    if (needSpare)
+    {
+        spare = createSegment(sparePath(), spareSeq);
+        if (spare)
+            prefault(*spare);
+    }
+
+    std::vector<std::unique_ptr<Segment>> removed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_synced = synced;
+        uint64_t expected = m_segments.empty() ? m_tail : m_segments.back()->endSeq();
+        if (spare && !m_spare && spare->firstSeq == expected)
+            m_spare = std::move(spare);
+
+        // ack 파일에 남긴 위치보다 앞의 세그먼트만 지움 (지운 뒤에 죽어도 다시 읽을 행이 없음)
+        while (!m_segments.empty() && m_segments.front()->endSeq() <= m_persistedAck &&
+               m_persistedAck != ~uint64_t(0))
+        {
+            removed.push_back(std::move(m_segments.front()));
+            m_segments.pop_front();
+        }
+    }
+
+    if (spare)
+        removed.push_back(std::move(spare));
+    for (const auto& segment : removed)
+        unlink(segment->path.c_str());
+    if (needSpare || !removed.empty())
+        syncDirectory();
+}
+
+void RowSpool::syncDirectory()
+{
+    if (m_dirFd >= 0 && fsync(m_dirFd) < 0)
+        LOG_SAMPLED(LogLevel::Error, "%s spool 디렉터리 fsync 실패: %s", m_table, strerror(errno));
+}
+
+void RowSpool::persistAck(uint64_t ack)
+{
+    uint64_t stored[2] = {ack, ~ack};
+    if (pwrite(m_ackFd, stored, sizeof(stored), 0) != static_cast<ssize_t>(sizeof(stored)) ||
+        fdatasync(m_ackFd) < 0)
+    {
+        LOG_SAMPLED(LogLevel::Error, "%s spool ack 기록 실패: %s", m_table, strerror(errno));
+        return;
+    }
+    m_persistedAck = ack;
+}
+
+uint64_t RowSpool::backlog() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tail - m_ack;
+}
+
+SpoolStats RowSpool::stats() const
+{
+    SpoolStats s;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    s.backlogRows = m_tail - m_ack;
+    s.segments = m_segments.size();
+    for (const auto& segment : m_segments)
+        s.bytes += segment->size;
+    if (m_spare)
+    {
+        ++s.segments;
+        s.bytes += m_spare->size;
+    }
+    s.droppedRows = m_dropped;
+    return s;
+}
@@ -0,0 +1,111 @@
+#ifndef ROWSPOOL_H
+#define ROWSPOOL_H
+
+#include <string>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// DB 쓰기 spool 설정 (DBWriteOptions::spool)
+struct SpoolOptions
+{
+    std::string directory;                              // spool 디렉터리 (비어 있으면 spool 없이 메모리 큐만 사용)
+    size_t segmentBytes = 8 << 20;                      // 세그먼트 파일 하나의 크기
+    size_t maxBytes = 64 << 20;                         // 테이블별 최대 보관량 (넘치면 가장 오래된 세그먼트를 버림)
+    std::chrono::milliseconds syncInterval{20};         // group commit 주기 (이 시간 동안 추가된 행을 한 번에 msync)
+    std::chrono::milliseconds retryInterval{1000};      // MySQL에 기록하지 못했을 때 다시 시도하는 간격
+};
+
+// spool 상태 (모니터링용)
+struct SpoolStats
+{
+    uint64_t backlogRows = 0;       // 아직 DB에 기록되지 않은 행 수
+    uint64_t bytes = 0;             // 세그먼트 파일 전체 크기
+    size_t segments = 0;
+    uint64_t droppedRows = 0;       // maxBytes를 넘어서 버린 행 수
+};
+
+// 테이블 하나의 write-ahead spool (append 전용 세그먼트 로그)
+// 행은 DB에 기록되기 전에 먼저 mmap된 세그먼트 끝에 복사되고, DB에 기록된 위치(ack)까지의 세그먼트는 지워짐
+// 디스크 동기화는 sync()가 syncInterval마다 모아서 하므로 append는 fsync를 기다리지 않음
+// (프로세스가 죽어도 mmap 페이지는 남고, 전원이 꺼지면 마지막 syncInterval 동안의 행만 잃음,
+//  계속 추가되는 중인 마지막 페이지는 폴트를 줄이려고 5번에 한 번만 내리므로 그 페이지는 최대 5 * syncInterval)
+//
+// 세그먼트 파일 "<테이블>-<첫 번호 20자리>.wal" = 32바이트 머리 + 고정 크기 레코드
+// 레코드 = u32 crc + u32 0 + u64 번호 + 행 (crc는 번호와 행의 CRC-32, 8바이트 단위로 정렬)
+// "<테이블>.ack"에는 DB에 기록된 다음 번호를 보관하고, 재시작 시 그 번호부터 crc와 번호가 맞는 레코드까지 다시 기록
+// ack를 남기기 전에 죽으면 이미 기록한 배치가 한 번 더 기록될 수 있음 (at-least-once)
+// 세그먼트 생성/이름 변경/삭제는 sync()가 디렉터리를 fsync해야 디스크에 남음 (ack 기록보다 먼저)
+//
+// append/read/ack는 여러 스레드에서 호출할 수 있고 sync()는 한 스레드에서만 호출해야 함
+class RowSpool
+{
+public:
+    RowSpool(const char* table, size_t rowSize);
+    ~RowSpool();
+    RowSpool(const RowSpool&) = delete;
+    RowSpool& operator=(const RowSpool&) = delete;
+
+    // 디렉터리의 기존 세그먼트를 검사해서 DB에 기록되지 않은 행부터 이어 씀
+    bool open(const SpoolOptions& options);
+
+    // 마지막 sync 후 세그먼트를 닫음 (남은 행은 다음 open에서 다시 읽음)
+    void close();
+    bool isOpen() const { return m_open; }
+
+    // 행 하나(rowSize 바이트)를 spool 끝에 추가하고 추가 후 backlog 반환 (디스크 오류면 0)
+    uint64_t append(const void* row);
+
+    // DB에 기록되지 않은 가장 오래된 행부터 최대 max개를 out에 복사하고 개수 반환 (first: 첫 행 번호)
+    size_t read(void* out, size_t max, uint64_t& first);
+
+    // read로 읽은 [first, first + count) 행이 DB에 기록됨
+    void ack(uint64_t first, size_t count);
+
+    // 추가된 레코드를 msync하고 ack 위치를 기록한 뒤 모두 기록된 세그먼트를 지움
+    // 다음 세그먼트("<테이블>.spare")를 미리 만들어서 append가 파일 생성을 기다리지 않도록 함
+    void sync();
+
+    uint64_t backlog() const;
+    SpoolStats stats() const;
+
+    const char* table() const { return m_table; }
+
+    struct Segment;
+
+private:
+    std::string segmentPath(uint64_t firstSeq) const;
+    std::string sparePath() const;
+    std::unique_ptr<Segment> createSegment(const std::string& path, uint64_t firstSeq);
+    std::unique_ptr<Segment> openSegment(const std::string& path);
+    void prefault(Segment& segment);
+    bool nextSegment();
+    void syncSegments(bool closing);
+    void persistAck(uint64_t ack);
+    void syncDirectory();
+
+    const char* m_table;
+    size_t m_rowSize;
+    size_t m_recordSize;
+    SpoolOptions m_options;
+    bool m_open;
+    int m_ackFd;
+    int m_dirFd;                    // spool 디렉터리 (파일 생성/삭제 후 fsync)
+
+    mutable std::mutex m_mutex;
+    std::deque<std::unique_ptr<Segment>> m_segments;    // 오래된 순서 (마지막이 쓰는 세그먼트)
+    std::unique_ptr<Segment> m_spare;                   // sync()가 미리 만든 다음 세그먼트
+    uint64_t m_tail;                // 다음에 추가할 행 번호
+    uint64_t m_ack;                 // 이 번호 앞의 행은 모두 DB에 기록됨
+    uint64_t m_synced;              // 이 번호 앞의 레코드는 msync됨 (sync 스레드 전용)
+    uint64_t m_persistedAck;        // ack 파일에 기록된 값 (sync 스레드 전용)
+    uint64_t m_lastTail;            // 지난 sync 때의 m_tail (sync 스레드 전용)
+    unsigned m_partialSyncs;        // 마지막 페이지를 건너뛴 sync 횟수 (sync 스레드 전용)
+    uint64_t m_dropped;
+    bool m_dirDirty;                // append가 세그먼트를 만들거나 이름을 바꾼 뒤 아직 디렉터리를 fsync하지 않음
+};
+
+#endif // ROWSPOOL_H
@@ -0,0 +1,471 @@
+#include "RuleEngine.h"
+#include "Logger.h"
+#include <sys/stat.h>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <cctype>
+
+namespace
+{
+
+constexpr size_t kSampleTypeCount = std::variant_size<SensorSample>::value;
+
+std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front())))
+        text.remove_prefix(1);
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back())))
+        text.remove_suffix(1);
+    return text;
+}
+
+bool isOperatorChar(char c)
+{
+    return c == '<' || c == '>' || c == '=' || c == '!';
+}
+
+// 조건 부분을 토큰으로 나눔 ("gasData>=700"처럼 붙여 써도 됨)
+std::vector<std::string_view> tokenize(std::string_view text)
+{
+    std::vector<std::string_view> tokens;
+    size_t i = 0;
+    while (i < text.size())
+    {
+        if (std::isspace(static_cast<unsigned char>(text[i])))
+        {
+            ++i;
+            continue;
+        }
+        size_t start = i;
+        bool op = isOperatorChar(text[i]);
+        while (i < text.size() && !std::isspace(static_cast<unsigned char>(text[i])) &&
+               isOperatorChar(text[i]) == op)
+            ++i;
+        tokens.push_back(text.substr(start, i - start));
+    }
+    return tokens;
+}
+
+bool parseOp(std::string_view token, RuleOp& op)
+{
+    if (token == "<")       op = RuleOp::Less;
+    else if (token == "<=") op = RuleOp::LessEqual;
+    else if (token == ">")  op = RuleOp::Greater;
+    else if (token == ">=") op = RuleOp::GreaterEqual;
+    else if (token == "==") op = RuleOp::Equal;
+    else if (token == "!=") op = RuleOp::NotEqual;
+    else return false;
+    return true;
+}
+
+template <typename T>
+bool parseNumber(std::string_view token, T& value)
+{
+    auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+    return result.ec == std::errc() && result.ptr == token.data() + token.size();
+}
+
+// 필드 이름은 종류끼리 겹치지 않으므로 이름만으로 종류와 순서를 찾음
+bool findField(std::string_view name, size_t& type, size_t& field)
+{
+    for (type = 0; type < kSampleTypeCount; ++type)
+    {
+        for (field = 0; field < kMaxSampleFields; ++field)
+        {
+            const char* candidate = sampleFieldName(type, field);
+            if (candidate && name == candidate)
+                return true;
+        }
+    }
+    return false;
+}
+
+inline bool compare(double lhs, RuleOp op, double rhs)
+{
+    switch (op)
+    {
+    case RuleOp::Less:          return lhs < rhs;
+    case RuleOp::LessEqual:     return lhs <= rhs;
+    case RuleOp::Greater:       return lhs > rhs;
+    case RuleOp::GreaterEqual:  return lhs >= rhs;
+    case RuleOp::Equal:         return lhs == rhs;
+    case RuleOp::NotEqual:      return lhs != rhs;
+    }
+    return false;
+}
+
+// 규칙 한 줄 컴파일 (실패하면 error에 원인)
+bool compileRule(std::string_view line, RuleProgram& program, std::string& error)
+{
+    size_t colon = line.find(':');
+    size_t arrow = line.find("->");
+    if (colon == std::string_view::npos || arrow == std::string_view::npos || arrow < colon)
+    {
+        error = "'<이름>: <조건> -> <디바이스> <명령>' 형식이 아님";
+        return false;
+    }
+
+    CompiledRule rule;
+    rule.name = std::string(trim(line.substr(0, colon)));
+    if (rule.name.empty())
+    {
+        error = "규칙 이름이 없음";
+        return false;
+    }
+
+    // 동작: <디바이스|all> <명령>
+    std::string_view action = trim(line.substr(arrow + 2));
+    size_t space = action.find_first_of(" \t");
+    if (space == std::string_view::npos)
+    {
+        error = "동작에 대상 디바이스와 명령이 모두 필요함";
+        return false;
+    }
+    rule.target = std::string(action.substr(0, space));
+    rule.command = std::string(trim(action.substr(space)));
+
+    // 조건: <operand> <op> <값> [and ...] [for N]
+    std::vector<std::string_view> tokens = tokenize(line.substr(colon + 1, arrow - colon - 1));
+    int type = -1;
+    bool sourceSet = false;
+    rule.firstCondition = static_cast<uint32_t>(program.conditions.size());
+    rule.conditionCount = 0;
+    rule.samples = 1;
+
+    size_t i = 0;
+    while (i < tokens.size())
+    {
+        if (i + 3 > tokens.size())
+        {
+            error = "조건은 '<필드> <op> <값>' 형식이어야 함";
+            return false;
+        }
+
+        std::string_view operand = tokens[i];
+        std::string_view source;
+        size_t dot = operand.rfind('.');
+        if (dot != std::string_view::npos)
+        {
+            source = operand.substr(0, dot);
+            operand = operand.substr(dot + 1);
+        }
+
+        size_t fieldType = 0;
+        size_t field = 0;
+        if (!findField(operand, fieldType, field))
+        {
+            error = "알 수 없는 필드: " + std::string(operand);
+            return false;
+        }
+        if (type >= 0 && static_cast<size_t>(type) != fieldType)
+        {
+            error = "한 규칙의 조건은 같은 종류의 샘플 필드여야 함";
+            return false;
+        }
+        type = static_cast<int>(fieldType);
+
+        // 종류 이름이면 확인만, 디바이스 이름이면 그 디바이스로 한정
+        if (!source.empty() && findSampleType(source) < 0)
+        {
+            if (sourceSet && rule.source != source)
+            {
+                error = "한 규칙의 조건은 같은 디바이스여야 함";
+                return false;
+            }
+            rule.source = std::string(source);
+            sourceSet = true;
+        }
+        else if (!source.empty() && findSampleType(source) != type)
+        {
+            error = std::string(operand) + " 필드는 " + std::string(source) + " 샘플에 없음";
+            return false;
+        }
+
+        RuleCondition condition;
+        condition.field = static_cast<uint8_t>(field);
+        if (!parseOp(tokens[i + 1], condition.op))
+        {
+            error = "알 수 없는 연산자: " + std::string(tokens[i + 1]);
+            return false;
+        }
+        if (!parseNumber(tokens[i + 2], condition.value))
+        {
+            error = "숫자가 아님: " + std::string(tokens[i + 2]);
+            return false;
+        }
+        program.conditions.push_back(condition);
+        ++rule.conditionCount;
+        i += 3;
+
+        if (i < tokens.size() && tokens[i] == "and")
+        {
+            ++i;
+            continue;
+        }
+        if (i + 2 == tokens.size() && tokens[i] == "for")
+        {
+            if (!parseNumber(tokens[i + 1], rule.samples) || rule.samples == 0)
+            {
+                error = "for 뒤에는 1 이상의 샘플 수가 필요함";
+                return false;
+            }
+            i += 2;
+        }
+        if (i < tokens.size())
+        {
+            error = "해석할 수 없는 부분: " + std::string(tokens[i]);
+            return false;
+        }
+    }
+
+    if (rule.conditionCount == 0)
+    {
+        error = "조건이 없음";
+        return false;
+    }
+
+    rule.fired = &Metrics::instance().counter("ems_rule_fired_total", "규칙이 실행된 횟수",
+                                              "rule=\"" + rule.name + "\"");
+    program.byType[type].push_back(static_cast<uint32_t>(program.rules.size()));
+    program.rules.push_back(std::move(rule));
+    return true;
+}
+
+} // namespace
+
+// 디바이스 하나의 규칙별 상태 (프로그램이 바뀌면 초기화)
+struct RuleEngine::Device
+{
+    std::mutex mutex;
+    uint64_t version = 0;
+    std::vector<uint32_t> streak;       // 조건이 연속으로 성립한 샘플 수
+    std::vector<uint8_t> active;        // 실행한 뒤 아직 조건이 풀리지 않음
+};
+
+RuleEngine::RuleEngine(Action action)
+    : m_action(std::move(action)),
+      m_program(std::make_shared<RuleProgram>()),
+      m_nextVersion(1),
+      m_watching(false),
+      m_evalLatency(Metrics::instance().histogram(
+          "ems_rule_eval_seconds", "샘플 하나의 규칙 평가 시간 (동작 실행 제외)")),
+      m_reloads(Metrics::instance().counter(
+          "ems_rule_reloads_total", "규칙 파일 적용 횟수", "result=\"ok\"")),
+      m_reloadFailures(Metrics::instance().counter(
+          "ems_rule_reloads_total", "규칙 파일 적용 횟수", "result=\"error\""))
+{
+    Metrics::instance().gauge("ems_rules_loaded", "적용 중인 규칙 수", "",
+                              [this] { return static_cast<double>(ruleCount()); }, this);
+}
+
+RuleEngine::~RuleEngine()
+{
+    stopWatching();
+    Metrics::instance().removeOwner(this);
+}
+
+std::shared_ptr<const RuleProgram> RuleEngine::program() const
+{
+    std::lock_guard<std::mutex> lock(m_programMutex);
+    return m_program;
+}
+
+size_t RuleEngine::ruleCount() const
+{
+    return program()->rules.size();
+}
+
+bool RuleEngine::loadText(std::string_view text, std::string* error)
+{
+    auto compiled = std::make_shared<RuleProgram>();
+
+    size_t lineNumber = 0;
+    while (!text.empty())
+    {
+        size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text = (end == std::string_view::npos) ? std::string_view() : text.substr(end + 1);
+        ++lineNumber;
+
+        size_t comment = line.find('#');
+        if (comment != std::string_view::npos)
+            line = line.substr(0, comment);
+        line = trim(line);
+        if (line.empty())
+            continue;
+
+        std::string reason;
+        if (!compileRule(line, *compiled, reason))
+        {
+            if (error)
+                *error = std::to_string(lineNumber) + "번째 줄: " + reason;
+            m_reloadFailures.inc();
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_programMutex);
+    compiled->version = m_nextVersion++;
+    m_program = std::move(compiled);
+    m_reloads.inc();
+    return true;
+}
+
+bool RuleEngine::loadFile(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        LOG_ERROR("규칙 파일 열기 실패: %s", path.c_str());
+        m_reloadFailures.inc();
+        return false;
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+
+    std::string error;
+    if (!loadText(content.str(), &error))
+    {
+        LOG_ERROR("규칙 파일 오류 (기존 규칙 유지): %s: %s", path.c_str(), error.c_str());
+        return false;
+    }
+    LOG_INFO("규칙 %zu개 적용: %s", ruleCount(), path.c_str());
+    return true;
+}
+
+void RuleEngine::watch(const std::string& path, std::chrono::milliseconds interval)
+{
+    stopWatching();
+    m_watching = true;
+    m_watcher = std::thread(&RuleEngine::watchLoop, this, path, interval);
+}
+
+void RuleEngine::stopWatching()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_watchMutex);
+        m_watching = false;
+    }
+    m_watchCv.notify_all();
+    if (m_watcher.joinable())
+        m_watcher.join();
+}
+
+// 수정 시각이 바뀌면 다시 읽음 (편집기가 파일을 교체하는 경우도 stat으로 감지)
+void RuleEngine::watchLoop(std::string path, std::chrono::milliseconds interval)
+{
+    struct timespec lastModified = {0, 0};
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0)
+        lastModified = info.st_mtim;
+
+    std::unique_lock<std::mutex> lock(m_watchMutex);
+    while (m_watching)
+    {
+        m_watchCv.wait_for(lock, interval);
+        if (!m_watching)
+            break;
+
+        if (stat(path.c_str(), &info) != 0)
+            continue;
+        if (info.st_mtim.tv_sec == lastModified.tv_sec && info.st_mtim.tv_nsec == lastModified.tv_nsec)
+            continue;
+        lastModified = info.st_mtim;
+
+        lock.unlock();
+        loadFile(path);
+        lock.lock();
+    }
+}
+
+RuleEngine::Device* RuleEngine::getOrCreateDevice(uint32_t homeId, std::string_view name)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(m_devicesMutex);
+        auto home = m_devices.find(homeId);
+        if (home != m_devices.end())
+        {
+            auto it = home->second.find(name);
+            if (it != home->second.end())
+                return it->second.get();
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_devicesMutex);
+    auto& devices = m_devices[homeId];
+    auto it = devices.find(name);
+    if (it != devices.end())
+        return it->second.get();
+
+    Device* device = new Device();
+    devices.emplace(std::string(name), std::unique_ptr<Device>(device));
+    return device;
+}
+
+void RuleEngine::write(uint32_t homeId, std::string_view deviceName, int64_t timeUs, const SensorSample& sample)
+{
+    (void)timeUs;
+
+    std::shared_ptr<const RuleProgram> current = program();
+    const std::vector<uint32_t>& candidates = current->byType[sample.index()];
+    if (candidates.empty())
+        return;
+
+    // 실행할 규칙은 모아 두었다가 디바이스 락을 놓고 실행
+    uint32_t firing[16];
+    size_t firingCount = 0;
+    {
+        LatencyHistogram::Timer timer(m_evalLatency);
+
+        double values[kMaxSampleFields];
+        sampleFieldValues(sample, values);
+
+        Device& device = *getOrCreateDevice(homeId, deviceName);
+        std::lock_guard<std::mutex> lock(device.mutex);
+        if (device.version != current->version)
+        {
+            device.version = current->version;
+            device.streak.assign(current->rules.size(), 0);
+            device.active.assign(current->rules.size(), 0);
+        }
+
+        for (uint32_t index : candidates)
+        {
+            const CompiledRule& rule = current->rules[index];
+            if (!rule.source.empty() && rule.source != deviceName)
+                continue;
+
+            bool matched = true;
+            const RuleCondition* condition = &current->conditions[rule.firstCondition];
+            for (uint32_t c = 0; c < rule.conditionCount && matched; ++c, ++condition)
+                matched = compare(values[condition->field], condition->op, condition->value);
+
+            if (!matched)
+            {
+                device.streak[index] = 0;
+                device.active[index] = 0;
+                continue;
+            }
+            if (device.active[index] || ++device.streak[index] < rule.samples)
+                continue;
+
+            // 한 샘플에 실행할 규칙이 firing 크기를 넘으면 나머지는 active로 표시하지 않고 다음 샘플에서 실행
+            if (firingCount == sizeof(firing) / sizeof(firing[0]))
+                continue;
+            device.active[index] = 1;
+            firing[firingCount++] = index;
+        }
+    }
+
+    for (size_t i = 0; i < firingCount; ++i)
+    {
+        const CompiledRule& rule = current->rules[firing[i]];
+        rule.fired->inc();
+        LOG_WARN("[규칙] %s 실행 (home %u %.*s) -> %s %s", rule.name.c_str(), homeId,
+                 static_cast<int>(deviceName.size()), deviceName.data(),
+                 rule.target.c_str(), rule.command.c_str());
+        if (m_action)
+            m_action(homeId, rule.target, rule.command);
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef RULEENGINE_H
+#define RULEENGINE_H
+
+#include "SensorSink.h"
+#include "Metrics.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+// 비교 연산자
+enum class RuleOp : uint8_t
+{
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Equal,
+    NotEqual
+};
+
+// 컴파일된 조건 하나 (샘플 필드 하나와 상수 비교)
+struct RuleCondition
+{
+    uint8_t field;              // sampleFieldValues 순서
+    RuleOp op;
+    double value;
+};
+
+// 컴파일된 규칙 하나 (conditions[first, first + count)가 모두 참이면 조건 성립)
+struct CompiledRule
+{
+    std::string name;
+    std::string source;         // 비어 있으면 같은 종류의 모든 디바이스, 아니면 디바이스 이름
+    uint32_t firstCondition;
+    uint32_t conditionCount;
+    uint32_t samples;           // 연속으로 성립해야 하는 샘플 수 ("for N")
+    std::string target;         // 명령을 보낼 디바이스 ("all"이면 모든 디바이스)
+    std::string command;        // 블루투스 명령
+    Counter* fired;
+};
+
+// 규칙 파일 하나를 컴파일한 결과 (불변, 다시 읽으면 통째로 교체)
+// 샘플 종류별로 규칙을 모아 두어 샘플 하나에 해당 종류의 규칙만 순서대로 평가
+struct RuleProgram
+{
+    uint64_t version = 0;
+    std::vector<RuleCondition> conditions;
+    std::vector<CompiledRule> rules;
+    std::vector<uint32_t> byType[std::variant_size<SensorSample>::value];   // 종류별 규칙 index
+};
+
+// 센서 샘플마다 규칙을 평가해서 조건이 N개 샘플 연속으로 성립하면 명령을 보내는 sink
+// DB보다 먼저 등록해서 화재/가스 대응이 MySQL 상태와 무관하게 동작하도록 함
+//
+// 규칙 파일 형식 (한 줄에 규칙 하나, '#' 뒤는 주석):
+//   <이름>: [<종류|디바이스>.]<필드> <op> <값> [and ...] [for <N>] -> <디바이스|all> <명령>
+//   gas_vent: gasData >= 700 for 3 -> windowModule OPEN
+// 규칙은 조건이 성립하는 순간 한 번 실행되고, 조건이 풀리면 다시 실행 가능해짐
+// 규칙 파일은 모든 home에 공통으로 적용되고, 연속 횟수는 home의 디바이스마다 따로 셈
+class RuleEngine : public SensorSink
+{
+public:
+    // homeId, target, command: 규칙의 동작 (샘플을 보낸 home으로, ingest worker 스레드에서 호출)
+    using Action = std::function<void(uint32_t homeId, const std::string& target, const std::string& command)>;
+
+    explicit RuleEngine(Action action);
+    ~RuleEngine();
+    RuleEngine(const RuleEngine&) = delete;
+    RuleEngine& operator=(const RuleEngine&) = delete;
+
+    // 규칙 파일을 컴파일해서 교체 (오류가 있으면 기존 규칙 유지하고 false)
+    bool loadFile(const std::string& path);
+    bool loadText(std::string_view text, std::string* error = nullptr);
+
+    // path의 수정 시각을 interval마다 확인해서 바뀌면 다시 읽음
+    void watch(const std::string& path, std::chrono::milliseconds interval = std::chrono::milliseconds(1000));
+    void stopWatching();
+
+    void write(uint32_t homeId, std::string_view device, int64_t timeUs, const SensorSample& sample) override;
+
+    size_t ruleCount() const;
+
+    struct Device;
+
+private:
+    std::shared_ptr<const RuleProgram> program() const;
+    Device* getOrCreateDevice(uint32_t homeId, std::string_view name);
+    void watchLoop(std::string path, std::chrono::milliseconds interval);
+
+    Action m_action;
+
+    mutable std::mutex m_programMutex;              // m_program 포인터 교체만 보호 (평가는 복사한 포인터로)
+    std::shared_ptr<const RuleProgram> m_program;
+    uint64_t m_nextVersion;
+
+    mutable std::shared_mutex m_devicesMutex;
+    std::map<uint32_t, std::map<std::string, std::unique_ptr<Device>, std::less<>>> m_devices;   // home → 이름 → 상태
+
+    std::thread m_watcher;
+    std::mutex m_watchMutex;
+    std::condition_variable m_watchCv;
+    bool m_watching;
+
+    // 메트릭 (Metrics 등록소가 소유)
+    LatencyHistogram& m_evalLatency;
+    Counter& m_reloads;
+    Counter& m_reloadFailures;
+};
+
+#endif // RULEENGINE_H
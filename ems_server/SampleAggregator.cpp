@@ -0,0 +1,258 @@
+#include "SampleAggregator.h"
+#include "ServerConfig.h"
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+
+// 기준은 DBManager의 "화재"/"위험" 상태와 같은 설정 값 (SIGHUP으로 바뀜)
+bool isAlarm(const SensorSample& sample)
+{
+    if (const FireSample* fire = std::get_if<FireSample>(&sample))
+    {
+        const AlarmThresholds& alarm = RuntimeConfig::instance().current().alarm;
+        return alarm.isFire(fire->fireData) || alarm.isGas(fire->gasData);
+    }
+    return false;
+}
+
+// 음수 시각에서도 구간 시작이 아래쪽으로 정렬되도록
+int64_t alignDown(int64_t value, int64_t step)
+{
+    int64_t q = value / step;
+    if (value % step < 0)
+        --q;
+    return q * step;
+}
+
+} // namespace
+
+// 디바이스 하나의 집계 상태 (같은 디바이스의 샘플은 같은 worker가 처리하지만 flush와 겹칠 수 있어서 락 사용)
+struct SampleAggregator::Device
+{
+    struct Window
+    {
+        int64_t startUs = 0;
+        uint32_t count = 0;
+        double min = 0.0;
+        double max = 0.0;
+        double sum = 0.0;
+        double last = 0.0;
+    };
+
+    std::mutex mutex;
+    uint32_t homeId = kDefaultHomeId;
+    std::string name;
+    int type = -1;                              // 샘플 종류 (바뀌면 집계를 새로 시작)
+    size_t fieldCount = 0;
+    bool forwardedOnce = false;
+    bool alarm = false;
+    double forwarded[kMaxSampleFields] = {};    // 마지막으로 downstream에 넘긴 값
+    std::vector<Window> windows;                // [구간 * kMaxSampleFields + 필드]
+};
+
+SampleAggregator::SampleAggregator(SensorSink* downstream, const AggregationOptions& options)
+    : m_downstream(downstream),
+      m_options(options),
+      m_forwarded(Metrics::instance().counter(
+          "ems_aggregator_samples_total", "집계 단계를 거친 샘플 수 (결과별)", "result=\"changed\"")),
+      m_alarms(Metrics::instance().counter(
+          "ems_aggregator_samples_total", "집계 단계를 거친 샘플 수 (결과별)", "result=\"threshold\"")),
+      m_suppressed(Metrics::instance().counter(
+          "ems_aggregator_samples_total", "집계 단계를 거친 샘플 수 (결과별)", "result=\"suppressed\"")),
+      m_windows(Metrics::instance().counter(
+          "ems_aggregator_windows_total", "닫혀서 기록된 집계 구간 수 (필드별)"))
+{
+    for (auto& fields : m_deadbands)
+    {
+        for (double& deadband : fields)
+            deadband = 0.0;
+    }
+
+    // 필드 이름으로 지정된 deadband를 [종류][필드] 표로 펼침
+    for (size_t type = 0; type < std::variant_size<SensorSample>::value; ++type)
+    {
+        for (size_t field = 0; field < kMaxSampleFields; ++field)
+        {
+            const char* name = sampleFieldName(type, field);
+            if (!name)
+                continue;
+            for (const FieldDeadband& entry : m_options.deadbands)
+            {
+                if (entry.field == name)
+                    m_deadbands[type][field] = entry.deadband;
+            }
+        }
+    }
+
+    // 0 이하의 구간 길이는 무시
+    std::vector<int64_t> windows;
+    for (int64_t seconds : m_options.windowSeconds)
+    {
+        if (seconds > 0)
+            windows.push_back(seconds);
+    }
+    m_options.windowSeconds.swap(windows);
+}
+
+SampleAggregator::~SampleAggregator() = default;
+
+SampleAggregator::Device* SampleAggregator::getOrCreateDevice(uint32_t homeId, std::string_view name)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(m_devicesMutex);
+        auto home = m_devices.find(homeId);
+        if (home != m_devices.end())
+        {
+            auto it = home->second.find(name);
+            if (it != home->second.end())
+                return it->second.get();
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_devicesMutex);
+    auto& devices = m_devices[homeId];
+    auto it = devices.find(name);
+    if (it != devices.end())
+        return it->second.get();
+
+    std::unique_ptr<Device> device(new Device());
+    device->homeId = homeId;
+    device->name = std::string(name);
+    Device* raw = device.get();
+    devices.emplace(device->name, std::move(device));
+    return raw;
+}
+
+bool SampleAggregator::isSignificant(const Device& device, const double* values, size_t count) const
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        double deadband = m_deadbands[device.type][i];
+        double change = std::fabs(values[i] - device.forwarded[i]);
+        if (deadband > 0.0 ? change >= deadband : change > 0.0)
+            return true;
+    }
+    return false;
+}
+
+void SampleAggregator::emitWindow(const Device& device, size_t window, size_t field)
+{
+    const Device::Window& stats = device.windows[window * kMaxSampleFields + field];
+
+    WindowAggregate aggregate;
+    aggregate.homeId = device.homeId;
+    aggregate.device = device.name;
+    aggregate.field = sampleFieldName(device.type, field);
+    aggregate.windowSeconds = m_options.windowSeconds[window];
+    aggregate.startUs = stats.startUs;
+    aggregate.count = stats.count;
+    aggregate.min = stats.min;
+    aggregate.max = stats.max;
+    aggregate.mean = stats.sum / stats.count;
+    aggregate.last = stats.last;
+
+    m_downstream->writeAggregate(aggregate);
+    m_windows.inc();
+}
+
+void SampleAggregator::emitOpenWindows(Device& device)
+{
+    for (size_t window = 0; window < m_options.windowSeconds.size(); ++window)
+    {
+        for (size_t field = 0; field < device.fieldCount; ++field)
+        {
+            Device::Window& stats = device.windows[window * kMaxSampleFields + field];
+            if (stats.count > 0)
+                emitWindow(device, window, field);
+            stats = Device::Window();
+        }
+    }
+}
+
+void SampleAggregator::write(uint32_t homeId, std::string_view name, int64_t timeUs, const SensorSample& sample)
+{
+    double values[kMaxSampleFields];
+    size_t count = sampleFieldValues(sample, values);
+
+    Device* device = getOrCreateDevice(homeId, name);
+    std::lock_guard<std::mutex> lock(device->mutex);
+
+    int type = static_cast<int>(sample.index());
+    if (device->type != type)
+    {
+        if (device->type >= 0)
+            emitOpenWindows(*device);
+        device->type = type;
+        device->fieldCount = count;
+        device->forwardedOnce = false;
+        device->alarm = false;
+        device->windows.assign(m_options.windowSeconds.size() * kMaxSampleFields, Device::Window());
+    }
+
+    // 구간 통계 갱신 (샘플 시각이 현재 구간을 벗어나면 닫아서 넘기고 새 구간 시작)
+    for (size_t window = 0; window < m_options.windowSeconds.size(); ++window)
+    {
+        int64_t startUs = alignDown(timeUs, m_options.windowSeconds[window] * 1000000);
+        for (size_t field = 0; field < count; ++field)
+        {
+            Device::Window& stats = device->windows[window * kMaxSampleFields + field];
+            if (stats.count > 0 && stats.startUs != startUs)
+            {
+                emitWindow(*device, window, field);
+                stats = Device::Window();
+            }
+
+            double value = values[field];
+            if (stats.count == 0)
+            {
+                stats.startUs = startUs;
+                stats.min = stats.max = value;
+            }
+            stats.min = std::min(stats.min, value);
+            stats.max = std::max(stats.max, value);
+            stats.sum += value;
+            stats.last = value;
+            ++stats.count;
+        }
+    }
+
+    // 원본 샘플: 임계값을 넘었거나 정상으로 돌아왔으면 항상, 아니면 deadband 이상 바뀐 경우만
+    bool alarm = isAlarm(sample);
+    bool crossed = alarm != device->alarm;
+    device->alarm = alarm;
+
+    if (alarm || crossed)
+        m_alarms.inc();
+    else if (!device->forwardedOnce || isSignificant(*device, values, count))
+        m_forwarded.inc();
+    else
+    {
+        m_suppressed.inc();
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        device->forwarded[i] = values[i];
+    device->forwardedOnce = true;
+    m_downstream->write(homeId, name, timeUs, sample);
+}
+
+void SampleAggregator::flush()
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(m_devicesMutex);
+        for (auto& home : m_devices)
+        {
+            for (auto& entry : home.second)
+            {
+                Device& device = *entry.second;
+                std::lock_guard<std::mutex> deviceLock(device.mutex);
+                if (device.type >= 0)
+                    emitOpenWindows(device);
+            }
+        }
+    }
+    m_downstream->flush();
+}
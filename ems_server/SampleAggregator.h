@@ -0,0 +1,75 @@
+#ifndef SAMPLEAGGREGATOR_H
+#define SAMPLEAGGREGATOR_H
+
+#include "SensorSink.h"
+#include "Metrics.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <cstdint>
+
+// 필드별 변화 허용 폭 (이보다 작게 바뀐 샘플은 원본 테이블에 기록하지 않음)
+struct FieldDeadband
+{
+    std::string field;          // sampleFieldName (예: "temp")
+    double deadband;            // 0이면 값이 조금이라도 바뀌면 기록
+};
+
+struct AggregationOptions
+{
+    std::vector<int64_t> windowSeconds = {10, 60, 3600};       // 집계 구간 길이
+    std::vector<FieldDeadband> deadbands = {
+        {"fireData", 10.0}, {"gasData", 20.0},
+        {"soil", 10.0}, {"light", 20.0}, {"temp", 0.5}, {"humi", 2.0},
+    };                                                          // 없는 필드(pet 상태 등)는 0
+};
+
+// handleData와 저장 sink 사이의 집계 단계
+// - 디바이스/필드마다 구간(기본 10초, 1분, 1시간)별 min/max/mean/last를 증분 계산해서
+//   구간이 끝나면 downstream->writeAggregate로 넘김
+// - 원본 샘플은 마지막으로 넘긴 값에서 deadband 이상 바뀐 경우에만 downstream->write로 넘김
+// - 화재(기본 fireData < 150), 가스 위험(기본 gasData >= 700, ServerConfig::alarm) 샘플과 정상으로 돌아온 첫 샘플은 항상 즉시 넘김
+// 구간은 그 디바이스의 다음 샘플이 구간 밖에 들어오거나 flush()할 때 닫힘
+class SampleAggregator : public SensorSink
+{
+public:
+    SampleAggregator(SensorSink* downstream, const AggregationOptions& options = AggregationOptions());
+    ~SampleAggregator();
+    SampleAggregator(const SampleAggregator&) = delete;
+    SampleAggregator& operator=(const SampleAggregator&) = delete;
+
+    void write(uint32_t homeId, std::string_view device, int64_t timeUs, const SensorSample& sample) override;
+
+    // 열린 구간을 모두 닫아서 넘기고 downstream도 flush
+    void flush() override;
+
+    uint64_t forwardedSamples() const { return m_forwarded.value() + m_alarms.value(); }
+    uint64_t suppressedSamples() const { return m_suppressed.value(); }
+
+    struct Device;
+
+private:
+    Device* getOrCreateDevice(uint32_t homeId, std::string_view name);
+    bool isSignificant(const Device& device, const double* values, size_t count) const;
+    void emitWindow(const Device& device, size_t window, size_t field);
+    void emitOpenWindows(Device& device);
+
+    SensorSink* m_downstream;
+    AggregationOptions m_options;
+    double m_deadbands[std::variant_size<SensorSample>::value][kMaxSampleFields];   // [샘플 종류][필드]
+
+    mutable std::shared_mutex m_devicesMutex;       // 디바이스 목록 (집계는 디바이스별 락)
+    std::map<uint32_t, std::map<std::string, std::unique_ptr<Device>, std::less<>>> m_devices;   // home → 이름 → 상태
+
+    // 메트릭 (Metrics 등록소가 소유)
+    Counter& m_forwarded;
+    Counter& m_alarms;
+    Counter& m_suppressed;
+    Counter& m_windows;
+};
+
+#endif // SAMPLEAGGREGATOR_H
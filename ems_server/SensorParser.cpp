@@ -0,0 +1,235 @@
+#include "SensorParser.h"
+#include <charconv>
+#include <cstdio>
+
+namespace
+{
+
+constexpr size_t kMaxFields = 8;
+
+// '_'로 나눈 필드들 (원본 줄을 가리키는 view)
+struct Fields
+{
+    std::string_view items[kMaxFields];
+    size_t count = 0;
+    bool overflow = false;
+};
+
+void splitFields(std::string_view line, Fields& fields)
+{
+    size_t start = 0;
+    while (true)
+    {
+        size_t end = line.find('_', start);
+        std::string_view token = line.substr(start, end == std::string_view::npos ? end : end - start);
+
+        if (fields.count == kMaxFields)
+        {
+            fields.overflow = true;
+            return;
+        }
+        fields.items[fields.count++] = token;
+
+        if (end == std::string_view::npos)
+            return;
+        start = end + 1;
+    }
+}
+
+// 필드 전체가 숫자여야 성공 (앞뒤 공백/쓰레기 값은 실패)
+template <typename T>
+bool toNumber(std::string_view text, T& value)
+{
+    if (text.empty())
+        return false;
+
+    const char* begin = text.data();
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(begin, end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+} // namespace
+
+const char* parseErrorName(ParseError error)
+{
+    switch (error)
+    {
+    case ParseError::None:          return "none";
+    case ParseError::TooFewFields:  return "too_few_fields";
+    case ParseError::UnknownType:   return "unknown_type";
+    case ParseError::FieldCount:    return "field_count";
+    case ParseError::BadNumber:     return "bad_number";
+    case ParseError::Count:         break;
+    }
+    return "unknown";
+}
+
+namespace
+{
+
+// SensorSample variant 순서와 같아야 함
+constexpr const char* kSampleTypes[] = {"fire", "pet", "plant"};
+static_assert(sizeof(kSampleTypes) / sizeof(kSampleTypes[0]) == std::variant_size<SensorSample>::value,
+              "kSampleTypes must name every SensorSample alternative");
+
+// 종류별 필드 이름 (sampleFieldValues의 순서)
+constexpr const char* kSampleFields[][kMaxSampleFields] = {
+    {"fireData", "gasData", nullptr, nullptr},
+    {"food", "water", "toilet", nullptr},
+    {"soil", "light", "temp", "humi"},
+};
+
+} // namespace
+
+const char* sampleTypeName(const SensorSample& sample)
+{
+    return kSampleTypes[sample.index()];
+}
+
+int findSampleType(std::string_view name)
+{
+    for (size_t i = 0; i < sizeof(kSampleTypes) / sizeof(kSampleTypes[0]); ++i)
+    {
+        if (name == kSampleTypes[i])
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+size_t sampleFieldValues(const SensorSample& sample, double (&values)[kMaxSampleFields])
+{
+    if (const FireSample* fire = std::get_if<FireSample>(&sample))
+    {
+        values[0] = fire->fireData;
+        values[1] = fire->gasData;
+        return 2;
+    }
+    if (const PetSample* pet = std::get_if<PetSample>(&sample))
+    {
+        values[0] = pet->food;
+        values[1] = pet->water;
+        values[2] = pet->toilet;
+        return 3;
+    }
+    if (const PlantSample* plant = std::get_if<PlantSample>(&sample))
+    {
+        values[0] = plant->soil;
+        values[1] = plant->light;
+        values[2] = plant->temp;
+        values[3] = plant->humi;
+        return 4;
+    }
+    return 0;
+}
+
+const char* sampleFieldName(size_t type, size_t field)
+{
+    if (type >= sizeof(kSampleFields) / sizeof(kSampleFields[0]) || field >= kMaxSampleFields)
+        return nullptr;
+    return kSampleFields[type][field];
+}
+
+void appendSampleFields(std::string& out, const SensorSample& sample)
+{
+    char buffer[128];
+    int length = 0;
+    if (const FireSample* fire = std::get_if<FireSample>(&sample))
+    {
+        length = std::snprintf(buffer, sizeof(buffer), " fireData=%d gasData=%g",
+                               fire->fireData, fire->gasData);
+    }
+    else if (const PetSample* pet = std::get_if<PetSample>(&sample))
+    {
+        length = std::snprintf(buffer, sizeof(buffer), " food=%d water=%d toilet=%d",
+                               pet->food, pet->water, pet->toilet);
+    }
+    else if (const PlantSample* plant = std::get_if<PlantSample>(&sample))
+    {
+        length = std::snprintf(buffer, sizeof(buffer), " soil=%g light=%g temp=%g humi=%g",
+                               plant->soil, plant->light, plant->temp, plant->humi);
+    }
+    if (length > 0)
+        out.append(buffer, static_cast<size_t>(length));
+}
+
+SensorParser::SensorParser()
+    : m_accepted(0)
+{
+    for (auto& counter : m_rejected)
+        counter.store(0, std::memory_order_relaxed);
+}
+
+ParseError SensorParser::parse(std::string_view line, SensorSample& sample)
+{
+    ParseError error = parseLine(line, sample);
+    if (error == ParseError::None)
+        m_accepted.fetch_add(1, std::memory_order_relaxed);
+    else
+        m_rejected[static_cast<size_t>(error)].fetch_add(1, std::memory_order_relaxed);
+    return error;
+}
+
+uint64_t SensorParser::rejectedLines() const
+{
+    uint64_t total = 0;
+    for (auto& counter : m_rejected)
+        total += counter.load(std::memory_order_relaxed);
+    return total;
+}
+
+uint64_t SensorParser::rejectedLines(ParseError error) const
+{
+    return m_rejected[static_cast<size_t>(error)].load(std::memory_order_relaxed);
+}
+
+ParseError SensorParser::parseLine(std::string_view line, SensorSample& sample) const
+{
+    Fields fields;
+    splitFields(line, fields);
+    if (fields.count < 2)
+        return ParseError::TooFewFields;
+
+    std::string_view type = fields.items[1];
+
+    if (type == "fire")
+    {
+        if (fields.overflow || fields.count != 4)
+            return ParseError::FieldCount;
+
+        FireSample fire;
+        if (!toNumber(fields.items[2], fire.fireData) || !toNumber(fields.items[3], fire.gasData))
+            return ParseError::BadNumber;
+
+        sample = fire;
+        return ParseError::None;
+    }
+    else if (type == "pet")
+    {
+        if (fields.overflow || fields.count != 5)
+            return ParseError::FieldCount;
+
+        PetSample pet;
+        if (!toNumber(fields.items[2], pet.food) || !toNumber(fields.items[3], pet.water) ||
+            !toNumber(fields.items[4], pet.toilet))
+            return ParseError::BadNumber;
+
+        sample = pet;
+        return ParseError::None;
+    }
+    else if (type == "plant")
+    {
+        if (fields.overflow || fields.count != 6)
+            return ParseError::FieldCount;
+
+        PlantSample plant;
+        if (!toNumber(fields.items[2], plant.soil) || !toNumber(fields.items[3], plant.light) ||
+            !toNumber(fields.items[4], plant.temp) || !toNumber(fields.items[5], plant.humi))
+            return ParseError::BadNumber;
+
+        sample = plant;
+        return ParseError::None;
+    }
+
+    return ParseError::UnknownType;
+}
@@ -0,0 +1,81 @@
+#ifndef SENSORPARSER_H
+#define SENSORPARSER_H
+
+#include <string>
+#include <string_view>
+#include <variant>
+#include <atomic>
+#include <cstdint>
+
+// 모듈별 센서 값 (아두이노가 보낸 원시 값)
+struct FireSample
+{
+    int fireData;       // 불꽃 센서 (150 미만이면 화재)
+    float gasData;      // 가스 센서 (700 이상이면 위험)
+};
+
+struct PetSample
+{
+    int food;           // 1: 충분, 0: 부족
+    int water;          // 1: 충분, 0: 부족
+    int toilet;         // 0: 깨끗함, 그 외: 청소 필요
+};
+
+struct PlantSample
+{
+    float soil;
+    float light;
+    float temp;
+    float humi;
+};
+
+using SensorSample = std::variant<FireSample, PetSample, PlantSample>;
+
+// 파싱 실패 원인
+enum class ParseError : uint8_t
+{
+    None = 0,
+    TooFewFields,       // "<id>_<type>" 형식이 아님
+    UnknownType,        // fire/pet/plant가 아님
+    FieldCount,         // 모듈에 맞지 않는 필드 개수
+    BadNumber,          // 숫자로 변환할 수 없는 필드
+    Count
+};
+
+const char* parseErrorName(ParseError error);
+
+// 샘플 종류 이름 ("fire", "pet", "plant")과 variant index 변환 (없는 이름이면 -1)
+const char* sampleTypeName(const SensorSample& sample);
+int findSampleType(std::string_view name);
+
+// 샘플 필드를 숫자 값으로 (시계열 저장, 집계용)
+// values에 필드 순서대로 채우고 필드 수를 반환, 이름은 sampleFieldName(종류, 순서)
+constexpr size_t kMaxSampleFields = 4;
+size_t sampleFieldValues(const SensorSample& sample, double (&values)[kMaxSampleFields]);
+const char* sampleFieldName(size_t type, size_t field);
+
+// " fireData=150 gasData=650.5" 형식으로 필드를 out 뒤에 추가 (TCP 응답/스트림용)
+void appendSampleFields(std::string& out, const SensorSample& sample);
+
+// "iot01_fire_150_650.5" 형식의 센서 한 줄 파서
+// std::string_view + std::from_chars만 사용해서 힙 할당과 예외가 없음
+class SensorParser
+{
+public:
+    SensorParser();
+
+    // 성공 시 ParseError::None과 함께 sample을 채움 (실패한 줄은 원인별로 집계)
+    ParseError parse(std::string_view line, SensorSample& sample);
+
+    uint64_t acceptedLines() const { return m_accepted.load(std::memory_order_relaxed); }
+    uint64_t rejectedLines() const;
+    uint64_t rejectedLines(ParseError error) const;
+
+private:
+    ParseError parseLine(std::string_view line, SensorSample& sample) const;
+
+    std::atomic<uint64_t> m_accepted;
+    std::atomic<uint64_t> m_rejected[static_cast<size_t>(ParseError::Count)];
+};
+
+#endif // SENSORPARSER_H
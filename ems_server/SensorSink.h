@@ -0,0 +1,43 @@
+#ifndef SENSORSINK_H
+#define SENSORSINK_H
+
+#include "SensorParser.h"
+#include "Home.h"
+#include <string_view>
+#include <cstdint>
+
+// 집계 구간 하나의 필드 통계 (SampleAggregator가 구간이 끝날 때 만듦)
+struct WindowAggregate
+{
+    uint32_t homeId;
+    std::string_view device;
+    const char* field;          // sampleFieldName (예: "gasData")
+    int64_t windowSeconds;      // 구간 길이
+    int64_t startUs;            // 구간 시작 (Unix epoch 마이크로초, 구간 길이에 정렬)
+    uint32_t count;
+    double min;
+    double max;
+    double mean;
+    double last;
+};
+
+// 파싱된 센서 샘플의 저장 대상 (MySQL, 로컬 시계열 저장소 등)
+// BluetoothManager::addSink로 등록하면 ingest worker 스레드에서 샘플마다 호출됨
+// worker가 여러 개면 서로 다른 디바이스의 샘플이 동시에 들어오므로 구현은 스레드 안전해야 함
+// 디바이스 이름은 home 안에서만 유일하므로 디바이스별 상태는 (homeId, device)로 구분해야 함
+class SensorSink
+{
+public:
+    virtual ~SensorSink() = default;
+
+    // homeId: 보낸 모듈의 home, device: 모듈 이름, timeUs: 수신 시각 (Unix epoch 마이크로초)
+    virtual void write(uint32_t homeId, std::string_view device, int64_t timeUs, const SensorSample& sample) = 0;
+
+    // 집계 구간 결과 (SampleAggregator 뒤에 연결된 sink만 받음, 기본은 무시)
+    virtual void writeAggregate(const WindowAggregate& aggregate) { (void)aggregate; }
+
+    // 버퍼에 쌓인 샘플을 저장소에 반영 (종료 전 호출)
+    virtual void flush() {}
+};
+
+#endif // SENSORSINK_H
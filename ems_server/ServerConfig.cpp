@@ -0,0 +1,456 @@
+#include "ServerConfig.h"
+#include "LatestValueCache.h"
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <cctype>
+
+namespace
+{
+
+std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front())))
+        text.remove_prefix(1);
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back())))
+        text.remove_suffix(1);
+    return text;
+}
+
+// 공백으로 나눈 단어들
+std::vector<std::string_view> words(std::string_view text)
+{
+    std::vector<std::string_view> result;
+    while (true)
+    {
+        text = trim(text);
+        if (text.empty())
+            break;
+        size_t space = text.find_first_of(" \t");
+        result.push_back(text.substr(0, space));
+        if (space == std::string_view::npos)
+            break;
+        text.remove_prefix(space);
+    }
+    return result;
+}
+
+template <typename T>
+bool parseNumber(std::string_view token, T& value)
+{
+    auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+    return result.ec == std::errc() && result.ptr == token.data() + token.size();
+}
+
+bool setSize(std::string_view value, size_t& out, std::string& error)
+{
+    if (!parseNumber(value, out))
+    {
+        error = "0 이상의 정수가 아님";
+        return false;
+    }
+    return true;
+}
+
+bool setPositive(std::string_view value, size_t& out, std::string& error)
+{
+    if (!parseNumber(value, out) || out == 0)
+    {
+        error = "1 이상의 정수가 아님";
+        return false;
+    }
+    return true;
+}
+
+bool setUint32(std::string_view value, uint32_t& out, std::string& error)
+{
+    if (!parseNumber(value, out))
+    {
+        error = "0 이상의 정수가 아님";
+        return false;
+    }
+    return true;
+}
+
+bool setPort(std::string_view value, int& out, std::string& error)
+{
+    if (!parseNumber(value, out) || out <= 0 || out > 65535)
+    {
+        error = "포트 번호는 1~65535";
+        return false;
+    }
+    return true;
+}
+
+bool setMillis(std::string_view value, std::chrono::milliseconds& out, std::string& error)
+{
+    int64_t ms = 0;
+    if (!parseNumber(value, ms) || ms < 0)
+    {
+        error = "밀리초 값이 아님";
+        return false;
+    }
+    out = std::chrono::milliseconds(ms);
+    return true;
+}
+
+bool setBool(std::string_view value, bool& out, std::string& error)
+{
+    if (value == "true" || value == "yes" || value == "1")
+        out = true;
+    else if (value == "false" || value == "no" || value == "0")
+        out = false;
+    else
+    {
+        error = "true/false가 아님";
+        return false;
+    }
+    return true;
+}
+
+bool setLogLevel(std::string_view value, LogLevel& out, std::string& error)
+{
+    if (value == "trace")       out = LogLevel::Trace;
+    else if (value == "debug")  out = LogLevel::Debug;
+    else if (value == "info")   out = LogLevel::Info;
+    else if (value == "warn")   out = LogLevel::Warn;
+    else if (value == "error")  out = LogLevel::Error;
+    else if (value == "off")    out = LogLevel::Off;
+    else
+    {
+        error = "trace/debug/info/warn/error/off 중 하나가 아님";
+        return false;
+    }
+    return true;
+}
+
+bool setPolicy(std::string_view value, BackpressurePolicy& out, std::string& error)
+{
+    if (value == "block")               out = BackpressurePolicy::Block;
+    else if (value == "drop_newest")    out = BackpressurePolicy::DropNewest;
+    else if (value == "drop_oldest")    out = BackpressurePolicy::DropOldest;
+    else
+    {
+        error = "block/drop_newest/drop_oldest 중 하나가 아님";
+        return false;
+    }
+    return true;
+}
+
+bool setSlowConsumer(std::string_view value, SlowConsumerPolicy& out, std::string& error)
+{
+    if (value == "drop_oldest")         out = SlowConsumerPolicy::DropOldest;
+    else if (value == "disconnect")     out = SlowConsumerPolicy::Disconnect;
+    else
+    {
+        error = "drop_oldest/disconnect 중 하나가 아님";
+        return false;
+    }
+    return true;
+}
+
+// device = <이름> <포트 경로> [home], remote = <이름> <home>
+bool addDevice(std::string_view value, bool remote, ServerConfig& config, std::string& error)
+{
+    std::vector<std::string_view> parts = words(value);
+    DeviceConfig device;
+    if (remote)
+    {
+        if (parts.size() != 2 || !parseHomeId(parts[1], device.homeId))
+        {
+            error = "'remote = <이름> <home>' 형식이 아님";
+            return false;
+        }
+    }
+    else
+    {
+        if ((parts.size() != 2 && parts.size() != 3) ||
+            (parts.size() == 3 && !parseHomeId(parts[2], device.homeId)))
+        {
+            error = "'device = <이름> <포트 경로> [home]' 형식이 아님";
+            return false;
+        }
+        device.path = std::string(parts[1]);
+    }
+    // 최신 값 캐시가 저장하는 길이까지만 허용 (sink마다 이름이 다르게 잘리지 않도록)
+    if (parts[0].size() > LatestValueCache::kMaxNameLength)
+    {
+        error = "디바이스 이름이 " + std::to_string(LatestValueCache::kMaxNameLength) + "자를 넘음: " +
+                std::string(parts[0]);
+        return false;
+    }
+    device.name = std::string(parts[0]);
+
+    for (const DeviceConfig& existing : config.devices)
+    {
+        if (existing.homeId == device.homeId && existing.name == device.name)
+        {
+            error = "home " + std::to_string(device.homeId) + "에 이미 있는 디바이스: " + device.name;
+            return false;
+        }
+    }
+    config.devices.push_back(std::move(device));
+    return true;
+}
+
+// 키 하나 (reloadable이면 SIGHUP으로 다시 읽을 때 바로 적용)
+struct KeySpec
+{
+    const char* name;
+    bool reloadable;
+    bool (*apply)(ServerConfig& config, std::string_view value, std::string& error);
+};
+
+const KeySpec kKeys[] = {
+    {"db.host", false, [](ServerConfig& c, std::string_view v, std::string&) { c.db.host = std::string(v); return true; }},
+    {"db.user", false, [](ServerConfig& c, std::string_view v, std::string&) { c.db.user = std::string(v); return true; }},
+    {"db.password", false, [](ServerConfig& c, std::string_view v, std::string&) { c.db.password = std::string(v); return true; }},
+    {"db.name", false, [](ServerConfig& c, std::string_view v, std::string&) { c.db.name = std::string(v); return true; }},
+    {"db.port", false, [](ServerConfig& c, std::string_view v, std::string& e) {
+        int port = 0;
+        if (!setPort(v, port, e))
+            return false;
+        c.db.port = static_cast<unsigned int>(port);
+        return true;
+    }},
+    {"db.pool_size", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setPositive(v, c.dbPool.size, e); }},
+    {"db.queue_capacity", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setPositive(v, c.dbWrite.queueCapacity, e); }},
+    {"db.batch_size", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setPositive(v, c.dbWrite.batchSize, e); }},
+    {"db.flush_interval_ms", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setMillis(v, c.dbWrite.flushInterval, e); }},
+    {"db.policy", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setPolicy(v, c.dbWrite.policy, e); }},
+    {"db.block_timeout_ms", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setMillis(v, c.dbWrite.blockTimeout, e); }},
+    {"db.spool", false, [](ServerConfig& c, std::string_view v, std::string&) { c.dbWrite.spool.directory = std::string(v); return true; }},
+    {"db.spool_max_bytes", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setPositive(v, c.dbWrite.spool.maxBytes, e); }},
+    {"db.spool_sync_ms", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setMillis(v, c.dbWrite.spool.syncInterval, e); }},
+    {"db.require_connection", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setBool(v, c.dbPool.requireConnection, e); }},
+    {"tcp.port", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setPort(v, c.tcpPort, e); }},
+    {"tcp.threads", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setSize(v, c.tcpThreads, e); }},
+    {"metrics.port", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setPort(v, c.metricsPort, e); }},
+    {"ingest.workers", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setSize(v, c.ingestWorkers, e); }},
+    {"ingest.queue_capacity", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setPositive(v, c.ingestQueueCapacity, e); }},
+    {"subscribe.queue_capacity", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setPositive(v, c.subscription.queueCapacity, e); }},
+    {"subscribe.slow_consumer", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setSlowConsumer(v, c.subscription.policy, e); }},
+    {"bluetooth.reconnect_min_ms", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setMillis(v, c.supervisor.reconnectMin, e); }},
+    {"bluetooth.reconnect_max_ms", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setMillis(v, c.supervisor.reconnectMax, e); }},
+    {"bluetooth.stale_timeout_ms", false, [](ServerConfig& c, std::string_view v, std::string& e) { return setMillis(v, c.supervisor.staleTimeout, e); }},
+    {"tsdb.directory", false, [](ServerConfig& c, std::string_view v, std::string&) { c.timeSeriesDirectory = std::string(v); return true; }},
+    {"rules.file", false, [](ServerConfig& c, std::string_view v, std::string&) { c.rulesFile = std::string(v); return true; }},
+    {"device", false, [](ServerConfig& c, std::string_view v, std::string& e) { return addDevice(v, false, c, e); }},
+    {"remote", false, [](ServerConfig& c, std::string_view v, std::string& e) { return addDevice(v, true, c, e); }},
+
+    {"log.level", true, [](ServerConfig& c, std::string_view v, std::string& e) { return setLogLevel(v, c.logLevel, e); }},
+    {"log.sample_every", true, [](ServerConfig& c, std::string_view v, std::string& e) { return setUint32(v, c.logSampleEvery, e); }},
+    {"log.max_per_second", true, [](ServerConfig& c, std::string_view v, std::string& e) { return setUint32(v, c.logMaxPerSecond, e); }},
+    {"alarm.fire_below", true, [](ServerConfig& c, std::string_view v, std::string& e) {
+        if (!parseNumber(v, c.alarm.fireBelow))
+        {
+            e = "정수가 아님";
+            return false;
+        }
+        return true;
+    }},
+    {"alarm.gas_at_least", true, [](ServerConfig& c, std::string_view v, std::string& e) {
+        if (!parseNumber(v, c.alarm.gasAtLeast))
+        {
+            e = "숫자가 아님";
+            return false;
+        }
+        return true;
+    }},
+    {"bluetooth.command_timeout_ms", true, [](ServerConfig& c, std::string_view v, std::string& e) { return setMillis(v, c.commandTimeout, e); }},
+    {"actuator.debounce_ms", true, [](ServerConfig& c, std::string_view v, std::string& e) { return setMillis(v, c.actuator.debounce, e); }},
+    {"actuator.state_ttl_ms", true, [](ServerConfig& c, std::string_view v, std::string& e) { return setMillis(v, c.actuator.stateTtl, e); }},
+};
+
+const KeySpec* findKey(std::string_view name)
+{
+    for (const KeySpec& key : kKeys)
+    {
+        if (name == key.name)
+            return &key;
+    }
+    return nullptr;
+}
+
+// 다시 읽어도 되는 값만 옮김 (kKeys의 reloadable 키와 맞춰야 함)
+void copyReloadable(const ServerConfig& from, ServerConfig& to)
+{
+    to.logLevel = from.logLevel;
+    to.logSampleEvery = from.logSampleEvery;
+    to.logMaxPerSecond = from.logMaxPerSecond;
+    to.alarm = from.alarm;
+    to.commandTimeout = from.commandTimeout;
+    to.actuator = from.actuator;
+}
+
+void applyLogging(const ServerConfig& config)
+{
+    Logger::instance().setLevel(config.logLevel);
+    Logger::instance().setSampling(config.logSampleEvery, config.logMaxPerSecond);
+}
+
+} // namespace
+
+bool parseServerConfig(std::string_view text, ServerConfig& config, std::string* error)
+{
+    size_t lineNumber = 0;
+    while (!text.empty())
+    {
+        size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text = (end == std::string_view::npos) ? std::string_view() : text.substr(end + 1);
+        ++lineNumber;
+
+        size_t comment = line.find('#');
+        if (comment != std::string_view::npos)
+            line = line.substr(0, comment);
+        line = trim(line);
+        if (line.empty())
+            continue;
+
+        std::string reason;
+        size_t equals = line.find('=');
+        std::string_view name = trim(line.substr(0, equals));
+        std::string_view value = (equals == std::string_view::npos) ? std::string_view() : trim(line.substr(equals + 1));
+        const KeySpec* key = findKey(name);
+        if (equals == std::string_view::npos)
+            reason = "'<키> = <값>' 형식이 아님";
+        else if (!key)
+            reason = "알 수 없는 키: " + std::string(name);
+        else if (value.empty())
+            reason = std::string(name) + " 값이 없음";
+        else if (key->apply(config, value, reason))
+        {
+            if (!key->reloadable)
+            {
+                std::string& recorded = config.restartOnly[key->name];
+                if (!recorded.empty())
+                    recorded += "; ";
+                recorded += value;
+            }
+            continue;
+        }
+        else
+            reason = std::string(name) + ": " + reason;
+
+        if (error)
+            *error = std::to_string(lineNumber) + "번째 줄: " + reason;
+        return false;
+    }
+    return true;
+}
+
+RuntimeConfig& RuntimeConfig::instance()
+{
+    static RuntimeConfig config;
+    return config;
+}
+
+RuntimeConfig::RuntimeConfig()
+    : m_config(std::make_shared<const ServerConfig>()),
+      m_version(1),
+      m_reloads(Metrics::instance().counter(
+          "ems_config_reloads_total", "설정 파일 적용 횟수", "result=\"ok\"")),
+      m_reloadFailures(Metrics::instance().counter(
+          "ems_config_reloads_total", "설정 파일 적용 횟수", "result=\"error\""))
+{
+}
+
+bool RuntimeConfig::readFile(const std::string& path, ServerConfig& config)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        LOG_ERROR("설정 파일 열기 실패: %s", path.c_str());
+        return false;
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+
+    std::string error;
+    if (!parseServerConfig(content.str(), config, &error))
+    {
+        LOG_ERROR("설정 파일 오류: %s: %s", path.c_str(), error.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool RuntimeConfig::load(const std::string& path)
+{
+    auto config = std::make_shared<ServerConfig>();
+    if (!readFile(path, *config))
+    {
+        m_reloadFailures.inc();
+        return false;
+    }
+    m_path = path;
+    applyLogging(*config);
+    publish(std::move(config));
+    m_reloads.inc();
+    LOG_INFO("설정 적용: %s", path.c_str());
+    return true;
+}
+
+bool RuntimeConfig::reload()
+{
+    ServerConfig fresh;
+    if (!readFile(m_path, fresh))
+    {
+        LOG_ERROR("기존 설정 유지");
+        m_reloadFailures.inc();
+        return false;
+    }
+
+    std::shared_ptr<const ServerConfig> running = snapshot();
+    auto next = std::make_shared<ServerConfig>(*running);
+    copyReloadable(fresh, *next);
+
+    // 재시작 전용 키는 실행 중인 값을 그대로 두고 바뀐 키만 알림
+    for (const KeySpec& key : kKeys)
+    {
+        if (key.reloadable)
+            continue;
+        auto before = running->restartOnly.find(key.name);
+        auto after = fresh.restartOnly.find(key.name);
+        bool changed = (before == running->restartOnly.end()) != (after == fresh.restartOnly.end()) ||
+                       (before != running->restartOnly.end() && before->second != after->second);
+        if (changed)
+            LOG_WARN("설정 %s 변경은 재시작해야 적용됨", key.name);
+    }
+
+    applyLogging(*next);
+    publish(std::move(next));
+    m_reloads.inc();
+    LOG_INFO("설정 다시 읽음: %s", m_path.c_str());
+    return true;
+}
+
+const ServerConfig& RuntimeConfig::current() const
+{
+    // 스레드별 캐시 (RuntimeConfig는 프로세스에 하나뿐이라 thread_local 하나로 충분)
+    thread_local std::shared_ptr<const ServerConfig> cached;
+    thread_local uint64_t cachedVersion = 0;
+
+    uint64_t version = m_version.load(std::memory_order_acquire);
+    if (version != cachedVersion)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        cached = m_config;
+        cachedVersion = m_version.load(std::memory_order_relaxed);
+    }
+    return *cached;
+}
+
+std::shared_ptr<const ServerConfig> RuntimeConfig::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_config;
+}
+
+void RuntimeConfig::publish(std::shared_ptr<const ServerConfig> config)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = std::move(config);
+    m_version.fetch_add(1, std::memory_order_release);
+}
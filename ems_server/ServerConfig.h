@@ -0,0 +1,133 @@
+#ifndef SERVERCONFIG_H
+#define SERVERCONFIG_H
+
+#include "BluetoothManager.h"
+#include "DBManager.h"
+#include "DBConnectionPool.h"
+#include "DeviceSupervisor.h"
+#include "SubscriptionHub.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "Home.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// MySQL 접속 정보
+struct DatabaseConfig
+{
+    std::string host = "127.0.0.1";
+    std::string user = "user1";
+    std::string password = "1234";
+    std::string name = "hometer";
+    unsigned int port = 3306;
+};
+
+// 블루투스 모듈 하나 (path가 비어 있으면 원격 gateway가 TCP로 넘겨주는 모듈)
+struct DeviceConfig
+{
+    std::string name;
+    std::string path;
+    uint32_t homeId = kDefaultHomeId;
+};
+
+// 화재/가스 경보 기준 (DB 상태 문자열과 집계기의 즉시 전달 판정이 함께 사용)
+struct AlarmThresholds
+{
+    int fireBelow = 150;            // fireData가 이 값 미만이면 화재
+    float gasAtLeast = 700.0f;      // gasData가 이 값 이상이면 가스 위험
+
+    bool isFire(int fireData) const { return fireData < fireBelow; }
+    bool isGas(float gasData) const { return gasData >= gasAtLeast; }
+};
+
+// 서버 설정 한 벌 (설정 파일 하나를 읽은 결과, 만든 뒤에는 수정하지 않음)
+// 파일에 없는 키는 여기와 각 Options 구조체의 기본값 (디바이스는 없음)
+struct ServerConfig
+{
+    // 재시작해야 적용되는 값
+    DatabaseConfig db;
+    DBWriteOptions dbWrite;
+    DBPoolOptions dbPool;
+    int tcpPort = 8080;
+    size_t tcpThreads = 0;                      // TCP 이벤트 루프 스레드 수 (0이면 자동)
+    int metricsPort = 9100;
+    size_t ingestWorkers = 0;                   // 0이면 CPU 수에 맞춤
+    size_t ingestQueueCapacity = 4096;
+    SubscriptionOptions subscription;
+    DeviceSupervisorOptions supervisor;
+    std::string timeSeriesDirectory = "tsdata"; // 비어 있으면 로컬 시계열 저장소를 쓰지 않음
+    std::string rulesFile = "rules.conf";
+    std::vector<DeviceConfig> devices;
+
+    // SIGHUP으로 다시 읽으면 바로 적용되는 값
+    LogLevel logLevel = LogLevel::Info;
+    uint32_t logSampleEvery = 1;
+    uint32_t logMaxPerSecond = 50;
+    AlarmThresholds alarm;
+    std::chrono::milliseconds commandTimeout{2000};
+    ActuatorOptions actuator;
+
+    // 재시작 전용 키의 원문 값 (다시 읽을 때 바뀐 키를 알리는 데만 사용)
+    std::map<std::string, std::string> restartOnly;
+};
+
+// 설정 파일 파싱 (한 줄에 "<키> = <값>", '#' 뒤는 주석, 실패하면 error에 "N번째 줄: 원인")
+//   db.host = 127.0.0.1
+//   device = fireModule /dev/rfcomm0 [home]
+//   remote = petModule <home>
+bool parseServerConfig(std::string_view text, ServerConfig& config, std::string* error = nullptr);
+
+// 실행 중인 설정 (불변 스냅샷을 통째로 교체)
+// - current()는 스레드마다 스냅샷 포인터를 캐시해 두고 버전 번호 하나만 atomic으로 비교하므로
+//   센서 샘플마다 불러도 락을 잡지 않음 (교체 직후 스레드별로 한 번만 락을 잡고 새 스냅샷을 가져감)
+// - reload()는 파일 전체를 검사한 뒤 다시 읽어도 되는 값만 새 스냅샷에 반영하고,
+//   재시작 전용 키가 바뀌었으면 경고만 남김 (오류가 있으면 기존 설정 유지)
+class RuntimeConfig
+{
+public:
+    static RuntimeConfig& instance();
+
+    // 시작할 때 한 번 (모든 값을 적용, 실패하면 false)
+    bool load(const std::string& path);
+
+    // SIGHUP 때 (path는 load에 준 파일)
+    bool reload();
+
+    // 핫 패스용: 반환한 참조는 같은 스레드가 다음에 current()를 부를 때까지 유효
+    const ServerConfig& current() const;
+
+    // 오래 들고 있을 스냅샷 (락을 잡음)
+    std::shared_ptr<const ServerConfig> snapshot() const;
+
+    // 스냅샷 교체 (테스트와 벤치마크에서 파일 없이 설정할 때)
+    void publish(std::shared_ptr<const ServerConfig> config);
+
+    uint64_t version() const { return m_version.load(std::memory_order_acquire); }
+    const std::string& path() const { return m_path; }
+
+private:
+    RuntimeConfig();
+    RuntimeConfig(const RuntimeConfig&) = delete;
+    RuntimeConfig& operator=(const RuntimeConfig&) = delete;
+
+    bool readFile(const std::string& path, ServerConfig& config);
+
+    std::string m_path;
+
+    mutable std::mutex m_mutex;                 // m_config 포인터 교체만 보호
+    std::shared_ptr<const ServerConfig> m_config;
+    std::atomic<uint64_t> m_version;
+
+    // 메트릭 (Metrics 등록소가 소유)
+    Counter& m_reloads;
+    Counter& m_reloadFailures;
+};
+
+#endif // SERVERCONFIG_H
@@ -0,0 +1,218 @@
+#include "SubscriptionHub.h"
+#include "BinaryProtocol.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+
+constexpr size_t kLengthHeaderSize = 4;
+
+} // namespace
+
+std::string_view StreamMessage::frame(FrameMode mode) const
+{
+    if (mode == FrameMode::Binary)
+        return binary;
+
+    std::string_view view(bytes);
+    if (mode == FrameMode::LengthPrefixed)
+        return view.substr(0, view.size() - 1);       // 길이 헤더 + 줄 (개행 제외)
+    return view.substr(kLengthHeaderSize);            // 줄 + 개행
+}
+
+StreamSubscriber::StreamSubscriber(const SubscriptionOptions& options, FrameMode mode, std::function<void()> notify)
+    : m_options(options),
+      m_mode(mode),
+      m_notify(std::move(notify)),
+      m_overflowed(false),
+      m_dropped(0),
+      m_homeId(kDefaultHomeId),
+      m_all(false),
+      m_types(0)
+{
+    if (m_options.queueCapacity == 0)
+        m_options.queueCapacity = 1;
+}
+
+bool StreamSubscriber::push(const StreamMessagePtr& message)
+{
+    bool wasEmpty;
+    bool accepted = true;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        wasEmpty = m_queue.empty();
+        if (m_queue.size() >= m_options.queueCapacity)
+        {
+            accepted = false;
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            if (m_options.policy == SlowConsumerPolicy::Disconnect)
+            {
+                // 이벤트 루프가 깨어나서 연결을 끊도록 알림 (처음 넘쳤을 때 한 번)
+                if (!m_overflowed.exchange(true, std::memory_order_relaxed))
+                    wasEmpty = true;
+                else
+                    return false;
+            }
+            else
+            {
+                m_queue.pop_front();
+                m_queue.push_back(message);
+            }
+        }
+        else
+        {
+            m_queue.push_back(message);
+        }
+    }
+
+    // 이미 대기 중인 업데이트가 있으면 이벤트 루프가 꺼낼 예정이므로 깨우지 않음
+    if (wasEmpty && m_notify)
+        m_notify();
+    return accepted;
+}
+
+size_t StreamSubscriber::drain(std::deque<StreamMessagePtr>& out, size_t max)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = std::min(max, m_queue.size());
+    for (size_t i = 0; i < count; ++i)
+    {
+        out.push_back(std::move(m_queue.front()));
+        m_queue.pop_front();
+    }
+    return count;
+}
+
+bool StreamSubscriber::matches(uint32_t homeId, std::string_view device, int type) const
+{
+    if (homeId != m_homeId)
+        return false;
+    if (m_all || (type >= 0 && (m_types & (1u << type))))
+        return true;
+    return std::find(m_devices.begin(), m_devices.end(), device) != m_devices.end();
+}
+
+SubscriptionHub::SubscriptionHub()
+    : m_count(0),
+      m_binaryCount(0),
+      m_published(Metrics::instance().counter(
+          "ems_stream_messages_total", "구독자가 있어서 만든 스트림 업데이트 수")),
+      m_delivered(Metrics::instance().counter(
+          "ems_stream_deliveries_total", "구독자 대기열에 넣은 업데이트 수")),
+      m_dropped(Metrics::instance().counter(
+          "ems_stream_dropped_total", "구독자 대기열이 가득 차서 버린 업데이트 수"))
+{
+    Metrics::instance().gauge("ems_stream_subscribers", "현재 구독 연결 수", "",
+                              [this] { return static_cast<double>(subscriberCount()); }, this);
+}
+
+SubscriptionHub::~SubscriptionHub()
+{
+    Metrics::instance().removeOwner(this);
+}
+
+void SubscriptionHub::subscribe(StreamSubscriber* subscriber, uint32_t homeId, std::string_view filter)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+    subscriber->m_homeId = homeId;
+    int type = findSampleType(filter);
+    if (filter == "all" || filter == "*")
+        subscriber->m_all = true;
+    else if (type >= 0)
+        subscriber->m_types |= 1u << type;
+    else if (std::find(subscriber->m_devices.begin(), subscriber->m_devices.end(), filter) ==
+             subscriber->m_devices.end())
+        subscriber->m_devices.emplace_back(filter);
+
+    if (std::find(m_subscribers.begin(), m_subscribers.end(), subscriber) == m_subscribers.end())
+    {
+        m_subscribers.push_back(subscriber);
+        if (subscriber->m_mode == FrameMode::Binary)
+            ++m_binaryCount;
+        m_count.store(m_subscribers.size(), std::memory_order_relaxed);
+    }
+}
+
+void SubscriptionHub::unsubscribe(StreamSubscriber* subscriber)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+    auto it = std::find(m_subscribers.begin(), m_subscribers.end(), subscriber);
+    if (it != m_subscribers.end())
+    {
+        m_subscribers.erase(it);
+        if (subscriber->m_mode == FrameMode::Binary)
+            --m_binaryCount;
+        m_count.store(m_subscribers.size(), std::memory_order_relaxed);
+    }
+    subscriber->m_all = false;
+    subscriber->m_types = 0;
+    subscriber->m_devices.clear();
+}
+
+// 텍스트 줄은 텍스트 구독자가 있을 때만, Event 프레임은 바이너리 구독자가 있을 때만 만듦 (공유 락 안에서 호출)
+StreamMessagePtr SubscriptionHub::makeMessage(uint32_t homeId, std::string_view device, int64_t timeUs,
+                                              const SensorSample& sample) const
+{
+    auto message = std::make_shared<StreamMessage>();
+    if (m_binaryCount > 0)
+    {
+        size_t start = beginBinaryFrame(message->binary, Opcode::Event, 0, homeId);
+        appendSampleRecord(message->binary, device, timeUs, 0, sample);
+        finishBinaryFrame(message->binary, start, BinaryStatus::Ok);
+    }
+    if (m_binaryCount == m_subscribers.size())
+        return message;
+
+    std::string& bytes = message->bytes;
+    bytes.reserve(128);
+    bytes.append(kLengthHeaderSize, '\0');
+
+    // 디바이스 이름 길이에 상관없이 bytes에 바로 씀
+    char number[24];
+    int length = std::snprintf(number, sizeof(number), "%lld", static_cast<long long>(timeUs));
+    bytes += "EVENT device=";
+    bytes.append(device.data(), device.size());
+    bytes += " type=";
+    bytes += sampleTypeName(sample);
+    bytes += " time_us=";
+    bytes.append(number, static_cast<size_t>(length));
+    appendSampleFields(bytes, sample);
+
+    uint32_t payload = static_cast<uint32_t>(bytes.size() - kLengthHeaderSize);
+    bytes[0] = static_cast<char>(payload >> 24);
+    bytes[1] = static_cast<char>(payload >> 16);
+    bytes[2] = static_cast<char>(payload >> 8);
+    bytes[3] = static_cast<char>(payload);
+    bytes += '\n';
+    return message;
+}
+
+void SubscriptionHub::write(uint32_t homeId, std::string_view device, int64_t timeUs, const SensorSample& sample)
+{
+    // 구독자가 없으면 줄도 만들지 않음
+    if (m_count.load(std::memory_order_relaxed) == 0)
+        return;
+
+    int type = static_cast<int>(sample.index());
+    StreamMessagePtr message;
+
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    for (StreamSubscriber* subscriber : m_subscribers)
+    {
+        if (!subscriber->matches(homeId, device, type))
+            continue;
+
+        if (!message)
+        {
+            message = makeMessage(homeId, device, timeUs, sample);
+            m_published.inc();
+        }
+        if (subscriber->push(message))
+            m_delivered.inc();
+        else
+            m_dropped.inc();
+    }
+}
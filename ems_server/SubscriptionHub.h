@@ -0,0 +1,121 @@
+#ifndef SUBSCRIPTIONHUB_H
+#define SUBSCRIPTIONHUB_H
+
+#include "SensorSink.h"
+#include "FrameDecoder.h"
+#include "Metrics.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+// 구독자에게 보낼 업데이트 한 줄
+// 샘플마다 한 번만 만들고 모든 구독자가 같은 버퍼를 공유함 (만든 뒤에는 수정하지 않음)
+// bytes = [4바이트 길이 헤더][줄]['\n'] 이라서 프레임 방식에 맞는 구간을 복사 없이 그대로 전송
+// binary는 Event 프레임 (바이너리 구독자가 있을 때만 만듦)
+struct StreamMessage
+{
+    std::string bytes;
+    std::string binary;
+
+    std::string_view frame(FrameMode mode) const;
+};
+
+using StreamMessagePtr = std::shared_ptr<const StreamMessage>;
+
+// 구독자 큐가 가득 찼을 때의 처리
+enum class SlowConsumerPolicy
+{
+    DropOldest,     // 가장 오래된 업데이트를 버리고 최신 값 유지
+    Disconnect      // 연결을 끊음
+};
+
+struct SubscriptionOptions
+{
+    size_t queueCapacity = 256;         // 구독자별 최대 대기 업데이트 수
+    SlowConsumerPolicy policy = SlowConsumerPolicy::DropOldest;
+};
+
+// 구독 연결 하나의 대기열 (ingest worker가 넣고 TCP 이벤트 루프가 꺼냄)
+class StreamSubscriber
+{
+public:
+    // mode: 연결의 프레임 방식 (Binary면 Event 프레임을 받음)
+    // notify: 대기열이 비어 있다가 채워졌을 때 ingest worker 스레드에서 호출됨
+    StreamSubscriber(const SubscriptionOptions& options, FrameMode mode, std::function<void()> notify);
+
+    // 꺼낸 업데이트를 out 뒤에 최대 max개 추가하고 개수 반환
+    size_t drain(std::deque<StreamMessagePtr>& out, size_t max);
+
+    // Disconnect 정책에서 대기열이 넘쳤으면 true (연결을 끊어야 함)
+    bool overflowed() const { return m_overflowed.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    friend class SubscriptionHub;
+
+    // 넣지 못하고 버린 업데이트가 있으면 false
+    bool push(const StreamMessagePtr& message);
+    bool matches(uint32_t homeId, std::string_view device, int type) const;
+
+    SubscriptionOptions m_options;
+    FrameMode m_mode;
+    std::function<void()> m_notify;
+
+    std::mutex m_mutex;
+    std::deque<StreamMessagePtr> m_queue;
+    std::atomic<bool> m_overflowed;
+    std::atomic<uint64_t> m_dropped;
+
+    // 구독 대상 (SubscriptionHub 락으로 보호)
+    uint32_t m_homeId;                      // 이 home의 샘플만 받음
+    bool m_all;
+    uint32_t m_types;                       // SensorSample 종류 비트
+    std::vector<std::string> m_devices;
+};
+
+// 파싱된 센서 업데이트를 구독자에게 나눠 주는 sink
+// 샘플을 한 줄로 한 번만 만들어서 조건이 맞는 구독자 대기열에 포인터만 넣으므로
+// 구독자가 느려도 ingest worker는 기다리지 않음 (대기열이 차면 정책에 따라 버리거나 끊음)
+class SubscriptionHub : public SensorSink
+{
+public:
+    SubscriptionHub();
+    ~SubscriptionHub();
+    SubscriptionHub(const SubscriptionHub&) = delete;
+    SubscriptionHub& operator=(const SubscriptionHub&) = delete;
+
+    // filter: "all", 모듈 종류("fire", "pet", "plant"), 또는 디바이스 이름 (homeId의 디바이스만)
+    // 같은 구독자에 여러 번 호출하면 대상이 추가됨 (다른 home으로 부르면 기존 대상은 그 home에 적용됨)
+    void subscribe(StreamSubscriber* subscriber, uint32_t homeId, std::string_view filter);
+
+    // 반환 후에는 hub가 subscriber에 접근하지 않음
+    void unsubscribe(StreamSubscriber* subscriber);
+
+    // SensorSink: "EVENT device=... type=... time_us=... <필드>" 한 줄 (바이너리 구독자는 Event 프레임)을 구독자에게 전달
+    void write(uint32_t homeId, std::string_view device, int64_t timeUs, const SensorSample& sample) override;
+
+    size_t subscriberCount() const { return m_count.load(std::memory_order_relaxed); }
+
+private:
+    StreamMessagePtr makeMessage(uint32_t homeId, std::string_view device, int64_t timeUs,
+                                 const SensorSample& sample) const;
+
+    mutable std::shared_mutex m_mutex;      // 구독자 목록과 구독 대상 (전달은 공유 락)
+    std::vector<StreamSubscriber*> m_subscribers;
+    std::atomic<size_t> m_count;
+    size_t m_binaryCount;                   // Binary 구독자 수 (m_mutex로 보호)
+
+    // 메트릭 (Metrics 등록소가 소유)
+    Counter& m_published;
+    Counter& m_delivered;
+    Counter& m_dropped;
+};
+
+#endif // SUBSCRIPTIONHUB_H
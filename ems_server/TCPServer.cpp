@@ -1,67 +1,197 @@
 #include "TCPServer.h"
+#include "Logger.h"
+#include "LatestValueCache.h"
+#include "BinaryProtocol.h"
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include <sys/eventfd.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
 #include <cstring>
+#include <cstdio>
 #include <iostream>
-#include <sstream>
+#include <algorithm>
+#include <chrono>
 
-TCPServer::TCPServer(int port) 
-    : m_port(port), m_serverSocket(-1), m_running(false)
+namespace
 {
+
+constexpr int kMaxEvents = 64;
+constexpr size_t kReadChunk = 4096;
+constexpr size_t kMaxFrameSize = 4096;       // 명령 하나의 최대 크기
+constexpr size_t kMaxSendSpans = 64;         // sendmsg 한 번에 묶는 스트림 메시지 수
+constexpr size_t kMaxPendingReplies = 1024;  // 전송 결과를 기다리며 쌓아둘 수 있는 응답 수 (연결별)
+
+} // namespace
+
+TCPServer::TCPServer(int port, size_t eventLoopThreads)
+    : m_port(port),
+      m_threadCount(eventLoopThreads),
+      m_frameMode(FrameMode::Newline),
+      m_running(false),
+      m_connectionCount(0),
+      m_latestValues(nullptr),
+      m_hub(nullptr),
+      m_commandLatency(Metrics::instance().histogram(
+          "ems_tcp_command_seconds", "TCP 명령 한 개 처리 시간 (파싱, 응답 적재, 블루투스 전송 콜백)")),
+      m_commands(Metrics::instance().counter(
+          "ems_tcp_commands_total", "처리한 TCP 명령 수", "known=\"true\"")),
+      m_unknownCommands(Metrics::instance().counter(
+          "ems_tcp_commands_total", "처리한 TCP 명령 수", "known=\"false\"")),
+      m_binaryConnections(Metrics::instance().counter(
+          "ems_tcp_binary_connections_total", "바이너리 프로토콜로 협상한 TCP 연결 수"))
+{
+    if (m_threadCount == 0)
+    {
+        unsigned int cores = std::thread::hardware_concurrency();
+        m_threadCount = (cores == 0) ? 1 : std::min<size_t>(cores, 4);
+    }
+
+    Metrics::instance().gauge("ems_tcp_connections", "현재 TCP 클라이언트 연결 수", "",
+                              [this] { return static_cast<double>(connectionCount()); }, this);
 }
 
 TCPServer::~TCPServer()
 {
+    Metrics::instance().removeOwner(this);
     stop();
 }
 
-bool TCPServer::start()
+// SO_REUSEPORT 리슨 소켓 생성 (이벤트 루프마다 하나씩, 커널이 연결을 분배)
+int TCPServer::createListenSocket()
 {
-    // 소켓 생성
-    m_serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (m_serverSocket < 0)
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
     {
         std::cerr << "소켓 생성 실패" << std::endl;
-        return false;
+        return -1;
     }
 
-    // 소켓 옵션 설정 (재사용 가능)
+    // 소켓 옵션 설정 (재사용 가능 + 여러 스레드가 같은 포트에 바인드)
     int opt = 1;
-    if (setsockopt(m_serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)))
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)))
     {
         std::cerr << "소켓 옵션 설정 실패" << std::endl;
-        close(m_serverSocket);
-        return false;
+        close(fd);
+        return -1;
     }
 
     // 주소 설정
     struct sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
     address.sin_family = AF_INET;
     address.sin_addr.s_addr = INADDR_ANY;
     address.sin_port = htons(m_port);
 
     // 바인드
-    if (bind(m_serverSocket, (struct sockaddr*)&address, sizeof(address)) < 0)
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0)
     {
         std::cerr << "바인드 실패: 포트 " << m_port << std::endl;
-        close(m_serverSocket);
-        return false;
+        close(fd);
+        return -1;
     }
 
     // 리슨
-    if (listen(m_serverSocket, 5) < 0)
+    if (listen(fd, SOMAXCONN) < 0)
     {
         std::cerr << "리슨 실패" << std::endl;
-        close(m_serverSocket);
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+bool TCPServer::setupLoop(EventLoop& loop)
+{
+    loop.listenFd = createListenSocket();
+    if (loop.listenFd < 0)
+        return false;
+
+    loop.epollFd = epoll_create1(EPOLL_CLOEXEC);
+    loop.wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (loop.epollFd < 0 || loop.wakeFd < 0)
+    {
+        perror("epoll/eventfd 생성 실패");
+        return false;
+    }
+
+    // data.ptr로 이벤트 종류 구분: 리슨/웨이크 fd는 멤버 주소, 나머지는 Connection*
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = &loop.listenFd;
+    if (epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, loop.listenFd, &ev) < 0)
+        return false;
+
+    ev.events = EPOLLIN;
+    ev.data.ptr = &loop.wakeFd;
+    if (epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, loop.wakeFd, &ev) < 0)
         return false;
+
+    loop.completions = std::make_shared<CompletionQueue>();
+    loop.completions->wakeFd = loop.wakeFd;
+    return true;
+}
+
+void TCPServer::closeLoop(EventLoop& loop)
+{
+    for (auto& it : loop.connections)
+    {
+        releaseSubscriber(loop, *it.second);
+        close(it.first);
+    }
+    m_connectionCount.fetch_sub(loop.connections.size(), std::memory_order_relaxed);
+    loop.connections.clear();
+
+    // 아직 오지 않은 전송 결과는 버림 (wakeFd를 닫기 전에 끊어야 함)
+    if (loop.completions)
+    {
+        std::lock_guard<std::mutex> lock(loop.completions->mutex);
+        loop.completions->wakeFd = -1;
+        loop.completions->entries.clear();
+    }
+
+    if (loop.listenFd >= 0)
+        close(loop.listenFd);
+    if (loop.wakeFd >= 0)
+        close(loop.wakeFd);
+    if (loop.epollFd >= 0)
+        close(loop.epollFd);
+    loop.listenFd = loop.wakeFd = loop.epollFd = -1;
+}
+
+bool TCPServer::start()
+{
+    if (m_running)
+        return true;
+
+    for (size_t i = 0; i < m_threadCount; ++i)
+    {
+        std::unique_ptr<EventLoop> loop(new EventLoop());
+        if (!setupLoop(*loop))
+        {
+            closeLoop(*loop);
+            for (auto& created : m_loops)
+                closeLoop(*created);
+            m_loops.clear();
+            return false;
+        }
+        m_loops.push_back(std::move(loop));
     }
 
     m_running = true;
-    m_serverThread = std::thread(&TCPServer::serverLoop, this);
+    for (auto& loop : m_loops)
+    {
+        loop->thread = std::thread(&TCPServer::eventLoop, this, std::ref(*loop));
+    }
 
-    std::cout << "TCP 서버 시작됨 - 포트: " << m_port << std::endl;
+    std::cout << "TCP 서버 시작됨 - 포트: " << m_port
+              << " (이벤트 루프 " << m_threadCount << "개)" << std::endl;
     return true;
 }
 
@@ -70,129 +200,850 @@ void TCPServer::stop()
     if (m_running)
     {
         m_running = false;
-        
-        if (m_serverSocket >= 0)
+
+        // 모든 이벤트 루프를 깨워서 종료시키고 join
+        for (auto& loop : m_loops)
         {
-            close(m_serverSocket);
-            m_serverSocket = -1;
+            uint64_t one = 1;
+            ssize_t ignored = write(loop->wakeFd, &one, sizeof(one));
+            (void)ignored;
         }
-
-        if (m_serverThread.joinable())
+        for (auto& loop : m_loops)
         {
-            m_serverThread.join();
+            if (loop->thread.joinable())
+                loop->thread.join();
+            closeLoop(*loop);
         }
+        m_loops.clear();
 
         std::cout << "TCP 서버 종료됨" << std::endl;
     }
 }
 
-void TCPServer::setCommandCallback(std::function<void(const std::string&)> callback)
+void TCPServer::setCommandCallback(CommandCallback callback)
 {
-    m_commandCallback = callback;
+    m_commandCallback = std::move(callback);
 }
 
-void TCPServer::serverLoop()
+void TCPServer::eventLoop(EventLoop& loop)
 {
+    struct epoll_event events[kMaxEvents];
+
     while (m_running)
+    {
+        int n = epoll_wait(loop.epollFd, events, kMaxEvents, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("epoll_wait 오류");
+            break;
+        }
+
+        // wakeFd는 배치의 연결 이벤트를 모두 처리한 뒤에 처리
+        // (deliverStreams/deliverCompletions가 연결을 닫으면 같은 배치의 뒤쪽 이벤트가 해제된 Connection을 가리키게 됨)
+        bool woken = false;
+        for (int i = 0; i < n; ++i)
+        {
+            void* tag = events[i].data.ptr;
+            if (tag == &loop.wakeFd)
+            {
+                woken = true;
+                continue;
+            }
+            if (tag == &loop.listenFd)
+            {
+                acceptClients(loop);
+                continue;
+            }
+
+            Connection* conn = static_cast<Connection*>(tag);
+            uint32_t flags = events[i].events;
+            bool alive = (flags & EPOLLERR) == 0;
+
+            if (alive && (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)))
+                alive = readFromClient(*conn);
+            if (alive)
+                alive = conn->subscriber ? writeStream(*conn) : flushOutput(*conn);
+
+            if (!alive)
+                closeConnection(loop, conn->fd);
+        }
+
+        if (woken)
+        {
+            uint64_t value;
+            ssize_t ignored = read(loop.wakeFd, &value, sizeof(value));
+            (void)ignored;
+            if (loop.streamPending.exchange(false, std::memory_order_acq_rel))
+                deliverStreams(loop);
+            deliverCompletions(loop);
+        }
+    }
+}
+
+// edge-triggered이므로 EAGAIN이 나올 때까지 모두 accept
+void TCPServer::acceptClients(EventLoop& loop)
+{
+    while (true)
     {
         struct sockaddr_in clientAddr;
         socklen_t clientLen = sizeof(clientAddr);
-        
-        int clientSocket = accept(m_serverSocket, (struct sockaddr*)&clientAddr, &clientLen);
-        
+
+        int clientSocket = accept4(loop.listenFd, (struct sockaddr*)&clientAddr, &clientLen,
+                                   SOCK_NONBLOCK | SOCK_CLOEXEC);
         if (clientSocket < 0)
         {
-            if (m_running) // 정상 종료가 아닌 경우만 에러 출력
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                LOG_ERROR("클라이언트 연결 수락 실패: %s", strerror(errno));
+            return;
+        }
+
+        std::unique_ptr<Connection> conn(new Connection());
+        conn->fd = clientSocket;
+        conn->id = ++loop.nextConnectionId;
+        conn->loop = &loop;
+        conn->mode = m_frameMode;
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = conn.get();
+        if (epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, clientSocket, &ev) < 0)
+        {
+            LOG_ERROR("epoll_ctl 실패: %s", strerror(errno));
+            close(clientSocket);
+            continue;
+        }
+
+        loop.connections[clientSocket] = std::move(conn);
+        m_connectionCount.fetch_add(1, std::memory_order_relaxed);
+
+        char address[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &clientAddr.sin_addr, address, sizeof(address));
+        LOG_INFO("클라이언트 연결됨: %s:%u", address, ntohs(clientAddr.sin_port));
+    }
+}
+
+// 소켓을 비울 때까지 읽고 완성된 명령을 모두 처리 (false: 연결 종료 필요)
+bool TCPServer::readFromClient(Connection& conn)
+{
+    while (true)
+    {
+        // 링 버퍼의 빈 공간에 바로 수신
+        conn.input.reserve(kReadChunk);
+        struct iovec iov[2];
+        size_t count = conn.input.writableSpans(iov);
+        if (count == 0)
+        {
+            LOG_WARN("[TCP] 입력 버퍼 한도 초과 - 연결 종료");
+            return false;
+        }
+
+        ssize_t bytesReceived = readv(conn.fd, iov, static_cast<int>(count));
+        if (bytesReceived > 0)
+        {
+            conn.input.commitWrite(bytesReceived);
+            if (!processInput(conn))
+                return false;
+            continue;
+        }
+
+        if (bytesReceived == 0)
+        {
+            // 클라이언트 연결 종료: 남은 응답을 최대한 보내고 닫음
+            flushOutput(conn);
+            return false;
+        }
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return true;
+        return false;
+    }
+}
+
+// 쌓인 응답을 scatter-gather 전송 한 번으로 보냄 (writev와 같지만 MSG_NOSIGNAL 사용) (못 보낸 나머지는 다음 EPOLLOUT에서 이어서)
+// 구독 업데이트는 공유 메시지 버퍼를 iovec으로 바로 보내고, 응답과 업데이트는 줄 경계에서만 번갈아 보냄
+bool TCPServer::flushOutput(Connection& conn)
+{
+    while (!conn.output.empty() || !conn.stream.empty())
+    {
+        struct iovec iov[kMaxSendSpans];
+        size_t count = 0;
+        bool fromStream = conn.streamOffset > 0 || conn.output.empty();
+        if (fromStream)
+        {
+            size_t offset = conn.streamOffset;
+            for (const StreamMessagePtr& message : conn.stream)
             {
-                std::cerr << "클라이언트 연결 수락 실패" << std::endl;
+                if (count == kMaxSendSpans)
+                    break;
+                std::string_view frame = message->frame(conn.mode);
+                iov[count].iov_base = const_cast<char*>(frame.data() + offset);
+                iov[count].iov_len = frame.size() - offset;
+                offset = 0;
+                ++count;
             }
+        }
+        else
+        {
+            count = conn.output.readableSpans(iov);
+        }
+
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+
+        ssize_t n = sendmsg(conn.fd, &msg, MSG_NOSIGNAL);
+        if (n > 0)
+        {
+            if (fromStream)
+                consumeStream(conn, n);
+            else
+                conn.output.consume(n);
             continue;
         }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        return false;
+    }
+    return true;
+}
 
-        std::cout << "클라이언트 연결됨: " << inet_ntoa(clientAddr.sin_addr) 
-                  << ":" << ntohs(clientAddr.sin_port) << std::endl;
+void TCPServer::consumeStream(Connection& conn, size_t bytes)
+{
+    while (bytes > 0 && !conn.stream.empty())
+    {
+        size_t remaining = conn.stream.front()->frame(conn.mode).size() - conn.streamOffset;
+        if (bytes < remaining)
+        {
+            conn.streamOffset += bytes;
+            return;
+        }
+        bytes -= remaining;
+        conn.stream.pop_front();
+        conn.streamOffset = 0;
+    }
+}
+
+// hub 대기열에서 업데이트를 꺼내 보냄 (소켓이 막히면 연결 쪽에는 queueCapacity개까지만 두고
+// 나머지는 hub 대기열에 남겨서 정책대로 버려지게 함)
+bool TCPServer::writeStream(Connection& conn)
+{
+    while (true)
+    {
+        size_t pulled = 0;
+        if (conn.stream.size() < m_subscriptionOptions.queueCapacity)
+            pulled = conn.subscriber->drain(conn.stream, m_subscriptionOptions.queueCapacity - conn.stream.size());
 
-        // 각 클라이언트를 별도 스레드에서 처리
-        std::thread clientThread(&TCPServer::handleClient, this, clientSocket);
-        clientThread.detach(); // 독립적으로 실행
+        if (conn.subscriber->overflowed())
+        {
+            LOG_WARN("[TCP] 구독자가 업데이트를 따라오지 못함 - 연결 종료");
+            return false;
+        }
+        if (!flushOutput(conn))
+            return false;
+        if (pulled == 0 || !conn.stream.empty())
+            return true;
     }
 }
 
-void TCPServer::handleClient(int clientSocket)
+// ingest worker가 wakeFd로 깨운 뒤 구독 연결마다 업데이트 전송
+void TCPServer::deliverStreams(EventLoop& loop)
 {
-    char buffer[1024];
-    
-    while (m_running)
+    std::vector<int> failed;
+    for (Connection* conn : loop.subscribed)
+    {
+        if (!writeStream(*conn))
+            failed.push_back(conn->fd);
+    }
+    for (int fd : failed)
+    {
+        closeConnection(loop, fd);
+    }
+}
+
+void TCPServer::releaseSubscriber(EventLoop& loop, Connection& conn)
+{
+    if (!conn.subscriber)
+        return;
+
+    if (m_hub)
+        m_hub->unsubscribe(conn.subscriber.get());
+    loop.subscribed.erase(std::remove(loop.subscribed.begin(), loop.subscribed.end(), &conn),
+                          loop.subscribed.end());
+}
+
+void TCPServer::closeConnection(EventLoop& loop, int fd)
+{
+    auto it = loop.connections.find(fd);
+    if (it != loop.connections.end())
+        releaseSubscriber(loop, *it->second);
+
+    epoll_ctl(loop.epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    if (loop.connections.erase(fd) > 0)
+    {
+        m_connectionCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+    LOG_INFO("클라이언트 연결 종료");
+}
+
+// 입력 버퍼에 들어있는 완성된 프레임을 모두 처리 (파이프라이닝된 명령 지원)
+bool TCPServer::processInput(Connection& conn)
+{
+    if (!conn.negotiated)
+    {
+        if (!negotiate(conn))
+            return false;
+        if (!conn.negotiated)
+            return true;
+    }
+
+    while (true)
+    {
+        std::string_view frame;
+        size_t consumed = 0;
+        FrameStatus status = nextFrame(conn.input, conn.mode, kMaxFrameSize,
+                                       conn.scratch, frame, consumed);
+        if (status == FrameStatus::TooLarge)
+        {
+            LOG_WARN("[TCP] 명령 길이 초과 - 연결 종료");
+            return false;
+        }
+        if (status == FrameStatus::NeedMore)
+        {
+            conn.input.consume(consumed);
+            return true;
+        }
+
+        LatencyHistogram::Timer timer(m_commandLatency);
+
+        // 한 번만 파싱해서 응답/콜백 모두 같은 Command 사용 (frame은 consume 전까지 유효)
+        Command command;
+        bool binary = conn.mode == FrameMode::Binary;
+        if (binary)
+        {
+            decodeBinaryCommand(conn, frame, command);
+        }
+        else
+        {
+            command = parseCommand(frame);
+            command.homeId = conn.homeId;
+            LOG_SAMPLED(LogLevel::Info, "[TCP] 클라이언트 명령: %.*s", static_cast<int>(frame.size()), frame.data());
+        }
+        (command.spec ? m_commands : m_unknownCommands).inc();
+
+        // 명령 처리 (응답은 모아두었다가 flushOutput에서 한 번에 전송)
+        // 블루투스 명령은 전송 결과가 나온 뒤에 응답 (그동안 이벤트 루프는 다른 명령 처리)
+        bool local = command.spec && command.spec->kind != CommandKind::Device;
+        bool deferred = !local && command.spec && !command.spec->btCommand.empty() && m_commandCallback;
+        CommandCompletion done;
+        bool queued;
+        if (deferred)
+        {
+            done = deferResponse(conn, command);
+            queued = static_cast<bool>(done);
+        }
+        else if (binary)
+        {
+            queued = queueResponse(conn, command.spec ? processBinaryCommand(conn, command) : conn.reply);
+        }
+        else
+        {
+            queued = queueResponse(conn, processCommand(conn, command));
+        }
+
+        // 콜백 함수 호출 (블루투스 전송용, 조회/구독 명령과 등록되지 않은 바이너리 opcode는 제외)
+        if (queued && !local && (command.spec || !binary) && m_commandCallback)
+        {
+            m_commandCallback(command, std::move(done));
+        }
+
+        conn.input.consume(consumed);
+        if (!queued)
+        {
+            LOG_WARN("[TCP] 출력 버퍼 한도 초과 - 연결 종료");
+            return false;
+        }
+    }
+}
+
+// 첫 바이트가 kBinaryMagic이면 바이너리 프로토콜로 전환하고 [magic][version]으로 답함
+// (false: 지원하지 않는 version이라 연결 종료, 바이트가 모자라면 negotiated를 그대로 두고 다음 수신을 기다림)
+bool TCPServer::negotiate(Connection& conn)
+{
+    if (conn.input.empty())
+        return true;
+    if (static_cast<uint8_t>(conn.input.at(0)) != kBinaryMagic)
+    {
+        conn.negotiated = true;
+        return true;
+    }
+    if (conn.input.size() < kBinaryHelloSize)
+        return true;
+
+    uint8_t version = static_cast<uint8_t>(conn.input.at(1));
+    const char hello[kBinaryHelloSize] = { static_cast<char>(kBinaryMagic), static_cast<char>(kBinaryVersion) };
+    conn.output.append(hello, sizeof(hello));
+    if (version != kBinaryVersion)
+    {
+        LOG_WARN("[TCP] 지원하지 않는 바이너리 프로토콜 version %u - 연결 종료", version);
+        flushOutput(conn);
+        return false;
+    }
+
+    conn.input.consume(kBinaryHelloSize);
+    conn.mode = FrameMode::Binary;
+    conn.negotiated = true;
+    m_binaryConnections.inc();
+    return true;
+}
+
+// 바이너리 프레임을 Command로 바꿈 (args는 수신 버퍼의 payload를 그대로 가리킴)
+// 등록되지 않은 opcode면 spec이 nullptr이고 conn.reply에 UnknownOpcode 응답을 작성
+void TCPServer::decodeBinaryCommand(Connection& conn, std::string_view frame, Command& command)
+{
+    BinaryHeader header = decodeBinaryHeader(frame.data());
+    command.spec = findCommand(static_cast<Opcode>(header.opcode));
+    command.verb = command.spec ? command.spec->verb : std::string_view();
+    command.args = frame.substr(kBinaryHeaderSize);
+    command.homeId = (header.homeId != 0) ? header.homeId : conn.homeId;
+    command.requestId = header.requestId;
+    LOG_SAMPLED(LogLevel::Info, "[TCP] 바이너리 명령: 0x%02x #%u", header.opcode, header.requestId);
+
+    if (!command.spec)
+    {
+        conn.reply.clear();
+        size_t start = beginBinaryFrame(conn.reply, static_cast<Opcode>(header.opcode), header.requestId,
+                                        command.homeId);
+        finishBinaryFrame(conn.reply, start, BinaryStatus::UnknownOpcode);
+    }
+}
+
+// 전송 결과를 기다리는 응답이 있으면 그 뒤에 줄을 세움 (파이프라이닝된 명령의 응답 순서 유지)
+// 바이너리 연결은 requestId로 응답을 구분하므로 기다리지 않고 바로 씀
+bool TCPServer::queueResponse(Connection& conn, std::string_view response)
+{
+    if (response.empty())
+        return true;
+    if (conn.replies.empty() || conn.mode == FrameMode::Binary)
+        return appendResponse(conn, response);
+    if (conn.replies.size() >= kMaxPendingReplies)
+        return false;
+
+    PendingReply reply;
+    reply.done = true;
+    reply.text.assign(response.data(), response.size());
+    conn.replies.push_back(std::move(reply));
+    return true;
+}
+
+bool TCPServer::appendResponse(Connection& conn, std::string_view response)
+{
+    if (response.empty())
+        return true;
+
+    // 길이 헤더 방식에서는 프레임 자체가 경계이므로 줄바꿈 제거
+    if (conn.mode == FrameMode::LengthPrefixed && response.back() == '\n')
+        response.remove_suffix(1);
+
+    return appendFrame(conn.output, conn.mode, response);
+}
+
+// 전송 결과를 기다리는 응답 자리를 만들고, 결과를 이 루프로 넘기는 콜백 반환 (한도 초과 시 빈 콜백)
+CommandCompletion TCPServer::deferResponse(Connection& conn, const Command& command)
+{
+    if (conn.replies.size() >= kMaxPendingReplies)
+        return nullptr;
+
+    PendingReply reply;
+    reply.token = ++conn.nextToken;
+    reply.spec = command.spec;
+    reply.requestId = command.requestId;
+    reply.homeId = command.homeId;
+    conn.replies.push_back(std::move(reply));
+
+    std::shared_ptr<CompletionQueue> queue = conn.loop->completions;
+    CompletionQueue::Entry entry{conn.fd, conn.id, conn.nextToken, CommandResult::Sent};
+    return [queue, entry](CommandResult result) mutable {
+        entry.result = result;
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (queue->wakeFd < 0)
+            return;
+        bool wasEmpty = queue->entries.empty();
+        queue->entries.push_back(entry);
+        if (wasEmpty)
+        {
+            uint64_t one = 1;
+            ssize_t ignored = write(queue->wakeFd, &one, sizeof(one));
+            (void)ignored;
+        }
+    };
+}
+
+// 블루투스 수신 스레드가 넘긴 전송 결과로 응답을 채우고, 순서가 된 응답부터 전송
+void TCPServer::deliverCompletions(EventLoop& loop)
+{
+    std::vector<CompletionQueue::Entry> entries;
+    {
+        std::lock_guard<std::mutex> lock(loop.completions->mutex);
+        entries.swap(loop.completions->entries);
+    }
+
+    for (const CompletionQueue::Entry& entry : entries)
     {
-        memset(buffer, 0, sizeof(buffer));
-        
-        int bytesReceived = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-        
-        if (bytesReceived <= 0)
+        // 그 사이 닫혔거나 fd가 다른 연결에 재사용됐으면 버림
+        auto it = loop.connections.find(entry.fd);
+        if (it == loop.connections.end() || it->second->id != entry.connectionId)
+            continue;
+
+        Connection& conn = *it->second;
+        for (PendingReply& reply : conn.replies)
         {
-            // 클라이언트 연결 종료
+            if (reply.token != entry.token || reply.done)
+                continue;
+            reply.done = true;
+            if (conn.mode == FrameMode::Binary)
+            {
+                reply.text.clear();
+                size_t start = beginBinaryFrame(reply.text, reply.spec->opcode, reply.requestId, reply.homeId);
+                finishBinaryFrame(reply.text, start, binaryStatus(entry.result));
+            }
+            else if (entry.result == CommandResult::Sent)
+            {
+                reply.text.assign(reply.spec->response.data(), reply.spec->response.size());
+            }
+            else
+            {
+                reply.text = commandResultName(entry.result);
+                reply.text += ' ';
+                reply.text.append(reply.spec->verb.data(), reply.spec->verb.size());
+                reply.text += '\n';
+            }
             break;
         }
 
-        std::string command(buffer);
-        std::cout << "[TCP] 클라이언트 명령: " << command << std::endl;
-
-        // 명령 처리
-        std::string response = processCommand(command);
-
-        // 응답 전송
-        if (!response.empty())
-        {
-            send(clientSocket, response.c_str(), response.length(), 0);
-        }
-
-        // 콜백 함수 호출 (블루투스 전송용)
-        if (m_commandCallback)
-        {
-            m_commandCallback(command);
-        }
-    }
-
-    close(clientSocket);
-    std::cout << "클라이언트 연결 종료" << std::endl;
-}
-
-std::string TCPServer::processCommand(const std::string& command)
-{
-    // 명령어 파싱 및 응답 생성
-    std::stringstream ss(command);
-    std::string action;
-    ss >> action;
-    
-    // Smart Window 명령어들
-    if (action == "window_open")
-        return "OK_WINDOW_OPENING\n";
-    else if (action == "window_close")
-        return "OK_WINDOW_CLOSING\n";
-    else if (action == "window_status")
-        return "OK_STATUS_REQUESTED\n";
-    
-    // Smart Window 각도 설정 명령어들
-    // else if (action.find("set_open_angle=") == 0)
-    // {
-    //     std::string angle = action.substr(15);
-    //     return "OK_OPEN_ANGLE_SET_TO_" + angle + "\n";
-    // }
-    // else if (action.find("set_close_angle=") == 0)
-    // {
-    //     std::string angle = action.substr(16);
-    //     return "OK_CLOSE_ANGLE_SET_TO_" + angle + "\n";
-    // }
-    
-    // 기타 명령어들 (기존)
-    // else if (action == "light_on")
-    //     return "OK_LIGHT_ON\n";
-    // else if (action == "light_off")
-    //     return "OK_LIGHT_OFF\n";
-    // else if (action == "door_open")
-    //     return "OK_DOOR_OPEN\n";
-    // else if (action == "door_close")
-    //     return "OK_DOOR_CLOSE\n";
-
-    return "OK_COMMAND_RECEIVED\n";
-}
\ No newline at end of file
+        bool alive = releaseReplies(conn);
+        if (alive)
+            alive = conn.subscriber ? writeStream(conn) : flushOutput(conn);
+        if (!alive)
+            closeConnection(loop, conn.fd);
+    }
+}
+
+// 앞에서부터 완성된 응답을 output으로 옮김 (false: 출력 버퍼 한도 초과)
+// 바이너리 연결은 결과가 나온 응답을 순서와 관계없이 보냄
+bool TCPServer::releaseReplies(Connection& conn)
+{
+    if (conn.mode == FrameMode::Binary)
+    {
+        for (auto it = conn.replies.begin(); it != conn.replies.end();)
+        {
+            if (!it->done)
+            {
+                ++it;
+                continue;
+            }
+            if (!appendResponse(conn, it->text))
+            {
+                LOG_WARN("[TCP] 출력 버퍼 한도 초과 - 연결 종료");
+                return false;
+            }
+            it = conn.replies.erase(it);
+        }
+        return true;
+    }
+
+    while (!conn.replies.empty() && conn.replies.front().done)
+    {
+        if (!appendResponse(conn, conn.replies.front().text))
+        {
+            LOG_WARN("[TCP] 출력 버퍼 한도 초과 - 연결 종료");
+            return false;
+        }
+        conn.replies.pop_front();
+    }
+    return true;
+}
+
+// 명령 표에 등록된 응답 반환 (등록되지 않은 명령은 기본 응답, 조회 명령은 conn.reply에 작성)
+std::string_view TCPServer::processCommand(Connection& conn, const Command& command)
+{
+    if (command.spec && command.spec->kind == CommandKind::Query)
+    {
+        conn.reply.clear();
+        processQuery(command, conn.reply);
+        return conn.reply;
+    }
+    if (command.spec && command.spec->kind == CommandKind::Stream)
+    {
+        conn.reply.clear();
+        processSubscription(conn, command, conn.reply);
+        return conn.reply;
+    }
+    if (command.spec && command.spec->kind == CommandKind::Session)
+    {
+        conn.reply.clear();
+        processHome(conn, command, conn.reply);
+        return conn.reply;
+    }
+    if (command.spec && command.spec->kind == CommandKind::Ingest)
+    {
+        conn.reply.clear();
+        processSensorLine(command, conn.reply);
+        return conn.reply;
+    }
+    if (command.spec)
+        return command.spec->response;
+
+    return kDefaultCommandResponse;
+}
+
+// get <디바이스|fire|pet|plant>, snapshot (DB를 거치지 않고 최신 값 캐시에서 응답, 연결의 home만)
+// state <디바이스>: 마지막으로 요청/전송된 구동기 상태 (블루투스를 기다리지 않음)
+void TCPServer::processQuery(const Command& command, std::string& reply)
+{
+    if (command.verb == "state")
+    {
+        processStateQuery(command, reply);
+        return;
+    }
+    if (!m_latestValues)
+    {
+        reply = "ERR_NO_DATA\n";
+        return;
+    }
+
+    int64_t nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    if (command.verb == "snapshot")
+    {
+        m_latestValues->formatSnapshot(command.homeId, nowUs, reply);
+    }
+    else if (command.args.empty())
+    {
+        reply = "ERR_USAGE get <module>\n";
+    }
+    else
+    {
+        m_latestValues->formatGet(command.homeId, command.args, nowUs, reply);
+    }
+}
+
+void TCPServer::processStateQuery(const Command& command, std::string& reply)
+{
+    if (command.args.empty())
+    {
+        reply = "ERR_USAGE state <module>\n";
+        return;
+    }
+
+    ActuatorState state;
+    if (!m_actuatorStateCallback || !m_actuatorStateCallback(command.homeId, command.args, state))
+    {
+        reply = "ERR_NO_DEVICE ";
+        reply.append(command.args.data(), command.args.size());
+        reply += '\n';
+        return;
+    }
+
+    reply = "OK_STATE device=";
+    reply.append(command.args.data(), command.args.size());
+    reply += " commanded=";
+    reply += state.commanded.empty() ? "-" : state.commanded;
+    reply += " confirmed=";
+    reply += state.confirmed.empty() ? "-" : state.confirmed;
+    reply += " pending=";
+    reply += state.pending ? '1' : '0';
+    reply += " age_ms=";
+    reply += std::to_string(state.confirmedAgeMs);
+    reply += '\n';
+}
+
+// subscribe <all|fire|pet|plant|디바이스>: 이 연결로 연결의 home 센서 업데이트를 "EVENT ..." 줄로 계속 보냄
+// unsubscribe: 모든 구독 해제 (이미 꺼낸 업데이트는 마저 보냄)
+void TCPServer::processSubscription(Connection& conn, const Command& command, std::string& reply)
+{
+    if (!m_hub)
+    {
+        reply = "ERR_STREAM_UNAVAILABLE\n";
+        return;
+    }
+
+    if (command.verb == "unsubscribe")
+    {
+        if (conn.subscriber)
+            m_hub->unsubscribe(conn.subscriber.get());
+        reply = "OK_UNSUBSCRIBED\n";
+        return;
+    }
+
+    if (command.args.empty())
+    {
+        reply = "ERR_USAGE subscribe <module>\n";
+        return;
+    }
+
+    startStream(conn, command);
+
+    reply = "OK_SUBSCRIBED ";
+    reply.append(command.args.data(), command.args.size());
+    reply += '\n';
+}
+
+// 연결에 구독자가 없으면 만들고 command.args 대상을 추가
+void TCPServer::startStream(Connection& conn, const Command& command)
+{
+    EventLoop* loop = conn.loop;
+    if (!conn.subscriber)
+    {
+        // 대기열이 채워지면 ingest worker가 이 연결의 이벤트 루프를 깨움 (루프당 한 번만 write)
+        conn.subscriber.reset(new StreamSubscriber(m_subscriptionOptions, conn.mode, [loop] {
+            if (!loop->streamPending.exchange(true, std::memory_order_acq_rel))
+            {
+                uint64_t one = 1;
+                ssize_t ignored = write(loop->wakeFd, &one, sizeof(one));
+                (void)ignored;
+            }
+        }));
+        loop->subscribed.push_back(&conn);
+    }
+    m_hub->subscribe(conn.subscriber.get(), command.homeId, command.args);
+}
+
+// home [<id>]: 이 연결의 이후 명령/조회/구독 대상 home 선택 (인자가 없으면 현재 home만 응답)
+void TCPServer::processHome(Connection& conn, const Command& command, std::string& reply)
+{
+    if (!command.args.empty() && !parseHomeId(command.args, conn.homeId))
+    {
+        reply = "ERR_USAGE home <id>\n";
+        return;
+    }
+
+    reply = "OK_HOME ";
+    reply += std::to_string(conn.homeId);
+    reply += '\n';
+}
+
+// sensor <디바이스> <줄>: 원격 gateway가 연결의 home 디바이스에서 받은 센서 줄을 넘김
+// 줄은 로컬 rfcomm에서 읽은 줄과 같은 ingest worker로 들어감 (같은 디바이스는 순서 유지)
+void TCPServer::processSensorLine(const Command& command, std::string& reply)
+{
+    std::string_view args = command.args;
+    size_t space = args.find(' ');
+    if (space == std::string_view::npos)
+    {
+        reply = "ERR_USAGE sensor <device> <line>\n";
+        return;
+    }
+    std::string_view device = args.substr(0, space);
+    std::string_view line = args.substr(args.find_first_not_of(' ', space));
+
+    CommandResult result = m_sensorLineCallback ? m_sensorLineCallback(command.homeId, device, line)
+                                                : CommandResult::NoDevice;
+    if (result == CommandResult::Sent)
+    {
+        reply = "OK_SENSOR\n";
+        return;
+    }
+    reply = commandResultName(result);
+    reply += " sensor\n";
+}
+
+// 바이너리 연결의 명령 응답 프레임을 conn.reply에 작성 (전송 결과를 기다리는 Device 명령은 deliverCompletions에서)
+std::string_view TCPServer::processBinaryCommand(Connection& conn, const Command& command)
+{
+    conn.reply.clear();
+    size_t start = beginBinaryFrame(conn.reply, command.spec->opcode, command.requestId, command.homeId);
+
+    BinaryStatus status = BinaryStatus::Ok;
+    switch (command.spec->kind)
+    {
+    case CommandKind::Device:
+        break;
+    case CommandKind::Query:
+        status = processBinaryQuery(command, conn.reply);
+        break;
+    case CommandKind::Stream:
+        status = processBinarySubscription(conn, command);
+        break;
+    case CommandKind::Session:
+        conn.homeId = command.homeId;       // 헤더의 homeId (0이면 현재 home 유지)
+        break;
+    case CommandKind::Ingest:
+        status = processBinarySensorLine(command);
+        break;
+    }
+
+    finishBinaryFrame(conn.reply, start, status);
+    return conn.reply;
+}
+
+// Get: 샘플 레코드 1개, Snapshot: u16 개수 + 레코드, State: 구동기 상태 레코드 (텍스트로 바꾸지 않고 최신 값 캐시에서 바로 작성)
+BinaryStatus TCPServer::processBinaryQuery(const Command& command, std::string& reply)
+{
+    if (command.spec->opcode == Opcode::State)
+    {
+        if (command.args.empty())
+            return BinaryStatus::BadRequest;
+        ActuatorState state;
+        if (!m_actuatorStateCallback || !m_actuatorStateCallback(command.homeId, command.args, state))
+            return BinaryStatus::NoDevice;
+        appendActuatorState(reply, command.args, state);
+        return BinaryStatus::Ok;
+    }
+    if (!m_latestValues)
+        return BinaryStatus::NoData;
+
+    if (command.spec->opcode == Opcode::Snapshot)
+    {
+        m_latestValues->encodeSnapshot(command.homeId, reply);
+        return BinaryStatus::Ok;
+    }
+    if (command.args.empty())
+        return BinaryStatus::BadRequest;
+
+    std::string device;
+    LatestValue value;
+    if (!m_latestValues->read(command.homeId, command.args, device, value))
+        return BinaryStatus::NoData;
+    appendSampleRecord(reply, device, value.timeUs, value.updates, value.sample);
+    return BinaryStatus::Ok;
+}
+
+// Subscribe 이후 업데이트는 Event 프레임으로 옴 (requestId 0)
+BinaryStatus TCPServer::processBinarySubscription(Connection& conn, const Command& command)
+{
+    if (!m_hub)
+        return BinaryStatus::Unavailable;
+
+    if (command.spec->opcode == Opcode::Unsubscribe)
+    {
+        if (conn.subscriber)
+            m_hub->unsubscribe(conn.subscriber.get());
+        return BinaryStatus::Ok;
+    }
+    if (command.args.empty())
+        return BinaryStatus::BadRequest;
+
+    startStream(conn, command);
+    return BinaryStatus::Ok;
+}
+
+BinaryStatus TCPServer::processBinarySensorLine(const Command& command)
+{
+    std::string_view device;
+    std::string_view line;
+    if (!splitSensorPayload(command.args, device, line))
+        return BinaryStatus::BadRequest;
+    if (!m_sensorLineCallback)
+        return BinaryStatus::NoDevice;
+    return binaryStatus(m_sensorLineCallback(command.homeId, device, line));
+}
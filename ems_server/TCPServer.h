@@ -6,11 +6,26 @@
 #include <thread>
 #include <atomic>
 #include <functional>
+#include <memory>
+#include <unordered_map>
+#include <string_view>
+#include "RingBuffer.h"
+#include "FrameDecoder.h"
+#include "CommandTable.h"
+#include "Metrics.h"
+#include "SubscriptionHub.h"
+#include "Home.h"
+#include "BinaryProtocol.h"
+#include <deque>
+#include <mutex>
+
+class LatestValueCache;
 
 class TCPServer
 {
 public:
-    TCPServer(int port);
+    // eventLoopThreads가 0이면 CPU 수에 맞춰 자동 설정 (최대 4)
+    TCPServer(int port, size_t eventLoopThreads = 0);
     ~TCPServer();
 
     // 서버 시작/중지
@@ -18,19 +33,163 @@ public:
     void stop();
 
     // 콜백 함수 설정 (클라이언트 명령 처리용)
-    void setCommandCallback(std::function<void(const std::string&)> callback);
+    // 블루투스 명령이 있는 Device 명령은 done으로 전송 결과를 받은 뒤에 응답 (나머지는 done이 비어 있음)
+    using CommandCallback = std::function<void(const Command& command, CommandCompletion done)>;
+    void setCommandCallback(CommandCallback callback);
+
+    // sensor <디바이스> <줄> 명령으로 원격 gateway가 넘긴 센서 줄을 받을 콜백 (이벤트 루프 스레드에서 호출)
+    // 결과가 Sent가 아니면 "<ERR_...> sensor"로 응답
+    using SensorLineCallback = std::function<CommandResult(uint32_t homeId, std::string_view device,
+                                                           std::string_view line)>;
+    void setSensorLineCallback(SensorLineCallback callback) { m_sensorLineCallback = std::move(callback); }
+
+    // state <디바이스> 명령으로 구동기 상태를 조회할 콜백 (이벤트 루프 스레드에서 호출, 블루투스를 거치지 않음)
+    // 디바이스가 없으면 false
+    using ActuatorStateCallback = std::function<bool(uint32_t homeId, std::string_view device, ActuatorState& state)>;
+    void setActuatorStateCallback(ActuatorStateCallback callback) { m_actuatorStateCallback = std::move(callback); }
+
+    // 명령 구분 방식 (start 전에 설정, 기본값은 개행 단위)
+    // 첫 바이트로 바이너리 프로토콜을 협상한 연결은 이 설정과 관계없이 FrameMode::Binary
+    void setFrameMode(FrameMode mode) { m_frameMode = mode; }
+
+    // get/snapshot 명령이 조회할 최신 값 캐시 (start 전에 설정, 없으면 ERR_NO_DATA 응답)
+    void setLatestValueCache(const LatestValueCache* cache) { m_latestValues = cache; }
+
+    // subscribe 명령으로 센서 업데이트를 받을 hub (start 전에 설정, 없으면 구독 불가)
+    void setSubscriptionHub(SubscriptionHub* hub, const SubscriptionOptions& options = SubscriptionOptions())
+    {
+        m_hub = hub;
+        m_subscriptionOptions = options;
+    }
+
+    size_t connectionCount() const { return m_connectionCount.load(std::memory_order_relaxed); }
 
 private:
+    struct EventLoop;
+
+    // 응답 순서를 지키기 위해 전송 결과를 기다리는 응답 뒤의 응답도 여기서 대기
+    struct PendingReply
+    {
+        uint64_t token = 0;
+        const CommandSpec* spec = nullptr;  // 결과를 기다리는 Device 명령 (결과가 나오면 text 작성)
+        uint32_t requestId = 0;             // 바이너리 응답 헤더용
+        uint32_t homeId = 0;
+        bool done = false;
+        std::string text;
+    };
+
+    // 전송 결과를 이벤트 루프로 넘기는 통로 (완료 콜백이 서버보다 오래 살 수 있어서 shared_ptr로 공유)
+    struct CompletionQueue
+    {
+        struct Entry
+        {
+            int fd;
+            uint64_t connectionId;
+            uint64_t token;
+            CommandResult result;
+        };
+
+        std::mutex mutex;
+        std::vector<Entry> entries;
+        int wakeFd = -1;        // 루프가 닫히면 -1 (이후 결과는 버림)
+    };
+
+    // 클라이언트 연결 하나 (이벤트 루프 스레드 하나에서만 접근)
+    struct Connection
+    {
+        Connection() : input(4096, 64 * 1024), output(4096, 256 * 1024) {}
+
+        int fd = -1;
+        uint64_t id = 0;        // fd 재사용과 구분하는 연결 번호 (전송 결과 전달용)
+        EventLoop* loop = nullptr;
+        FrameMode mode = FrameMode::Newline;
+        bool negotiated = false;    // 첫 바이트로 텍스트/바이너리를 정했음
+        RingBuffer input;       // 아직 프레임이 완성되지 않은 수신 데이터
+        RingBuffer output;      // 아직 보내지 못한 응답 (sendmsg 한 번으로 일괄 전송)
+        std::string scratch;    // 랩어라운드된 프레임 복사용
+        std::string reply;      // 조회 명령 응답 작성용 (연결마다 재사용, 바이너리는 응답 프레임)
+        uint32_t homeId = kDefaultHomeId;   // home 명령으로 선택한 home (명령/조회/구독 대상)
+
+        // 전송 결과를 기다리는 응답과 그 뒤의 응답 (비어 있으면 응답을 바로 output에 씀)
+        // 바이너리 연결은 requestId로 구분하므로 기다리는 응답만 두고 나머지는 바로 씀
+        std::deque<PendingReply> replies;
+        uint64_t nextToken = 0;
+
+        // 구독 중이면 hub에서 꺼낸 업데이트 (공유 버퍼를 그대로 전송, streamOffset은 맨 앞 메시지의 보낸 바이트)
+        std::unique_ptr<StreamSubscriber> subscriber;
+        std::deque<StreamMessagePtr> stream;
+        size_t streamOffset = 0;
+    };
+
+    // edge-triggered epoll 이벤트 루프 (스레드마다 SO_REUSEPORT 리슨 소켓을 따로 가짐)
+    struct EventLoop
+    {
+        int epollFd = -1;
+        int listenFd = -1;
+        int wakeFd = -1;        // stop() 시 epoll_wait를 깨우는 eventfd
+        std::thread thread;
+        std::unordered_map<int, std::unique_ptr<Connection>> connections;
+        std::vector<Connection*> subscribed;        // 구독 중인 연결
+        std::atomic<bool> streamPending{false};     // 구독 업데이트가 들어와서 wakeFd를 깨웠음
+        std::shared_ptr<CompletionQueue> completions;
+        uint64_t nextConnectionId = 0;
+    };
+
     int m_port;
-    int m_serverSocket;
+    size_t m_threadCount;
+    FrameMode m_frameMode;
     std::atomic<bool> m_running;
-    std::thread m_serverThread;
-    
-    std::function<void(const std::string&)> m_commandCallback;
+    std::atomic<size_t> m_connectionCount;
+    std::vector<std::unique_ptr<EventLoop>> m_loops;
+
+    CommandCallback m_commandCallback;
+    SensorLineCallback m_sensorLineCallback;
+    ActuatorStateCallback m_actuatorStateCallback;
+    const LatestValueCache* m_latestValues;
+    SubscriptionHub* m_hub;
+    SubscriptionOptions m_subscriptionOptions;
+
+    // 메트릭 (Metrics 등록소가 소유)
+    LatencyHistogram& m_commandLatency;
+    Counter& m_commands;
+    Counter& m_unknownCommands;
+    Counter& m_binaryConnections;
+
+    int createListenSocket();
+    bool setupLoop(EventLoop& loop);
+    void closeLoop(EventLoop& loop);
+
+    void eventLoop(EventLoop& loop);
+    void acceptClients(EventLoop& loop);
+    bool readFromClient(Connection& conn);
+    bool flushOutput(Connection& conn);
+    void closeConnection(EventLoop& loop, int fd);
+    void releaseSubscriber(EventLoop& loop, Connection& conn);
+
+    void deliverStreams(EventLoop& loop);
+    bool writeStream(Connection& conn);
+    void consumeStream(Connection& conn, size_t bytes);
+
+    bool processInput(Connection& conn);
+    bool negotiate(Connection& conn);
+    void decodeBinaryCommand(Connection& conn, std::string_view frame, Command& command);
+    bool queueResponse(Connection& conn, std::string_view response);
+    bool appendResponse(Connection& conn, std::string_view response);
+    CommandCompletion deferResponse(Connection& conn, const Command& command);
+    void deliverCompletions(EventLoop& loop);
+    bool releaseReplies(Connection& conn);
+    std::string_view processCommand(Connection& conn, const Command& command);
+    void processQuery(const Command& command, std::string& reply);
+    void processStateQuery(const Command& command, std::string& reply);
+    void processSubscription(Connection& conn, const Command& command, std::string& reply);
+    void startStream(Connection& conn, const Command& command);
+    void processHome(Connection& conn, const Command& command, std::string& reply);
+    void processSensorLine(const Command& command, std::string& reply);
 
-    void serverLoop();
-    void handleClient(int clientSocket);
-    std::string processCommand(const std::string& command);
+    std::string_view processBinaryCommand(Connection& conn, const Command& command);
+    BinaryStatus processBinaryQuery(const Command& command, std::string& reply);
+    BinaryStatus processBinarySubscription(Connection& conn, const Command& command);
+    BinaryStatus processBinarySensorLine(const Command& command);
 };
 
-#endif // TCPSERVER_H
\ No newline at end of file
+#endif // TCPSERVER_H
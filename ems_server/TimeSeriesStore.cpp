@@ -0,0 +1,669 @@
+#include "TimeSeriesStore.h"
+#include "Logger.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+namespace
+{
+
+constexpr uint32_t kBlockMagic = 0x31535445;        // "ETS1"
+constexpr const char* kFileSuffix = ".ts";
+
+// 파일에 기록되는 블록 머리 (뒤에 8바이트 정렬된 압축 데이터가 이어짐)
+struct BlockHeader
+{
+    uint32_t magic;             // 마지막에 기록 (0이면 여기서 파일 끝)
+    uint32_t count;
+    int64_t firstUs;
+    int64_t lastUs;
+    uint32_t payloadBytes;
+    uint32_t checksum;          // payload의 FNV-1a
+};
+static_assert(sizeof(BlockHeader) == 32, "BlockHeader 크기는 32바이트");
+
+uint32_t checksum(const void* data, size_t length)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint64_t doubleBits(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsDouble(uint64_t bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// 상위 비트부터 채우는 비트 스트림
+class BitWriter
+{
+public:
+    void write(uint64_t value, int bits)
+    {
+        if (bits == 0)
+            return;
+        if (bits < 64)
+            value &= (1ULL << bits) - 1;
+
+        int used = static_cast<int>(m_bitCount % 64);
+        if (used == 0)
+            m_words.push_back(0);
+
+        int room = 64 - used;
+        if (bits <= room)
+        {
+            m_words.back() |= value << (room - bits);
+        }
+        else
+        {
+            m_words.back() |= value >> (bits - room);
+            m_words.push_back(value << (64 - (bits - room)));
+        }
+        m_bitCount += bits;
+    }
+
+    void clear()
+    {
+        m_words.clear();
+        m_bitCount = 0;
+    }
+
+    const std::vector<uint64_t>& words() const { return m_words; }
+    size_t byteSize() const { return m_words.size() * sizeof(uint64_t); }
+
+private:
+    std::vector<uint64_t> m_words;
+    uint64_t m_bitCount = 0;
+};
+
+class BitReader
+{
+public:
+    BitReader(const uint64_t* words, size_t wordCount) : m_words(words), m_wordCount(wordCount) {}
+
+    uint64_t read(int bits)
+    {
+        if (bits == 0)
+            return 0;
+
+        size_t index = m_bitPos / 64;
+        int used = static_cast<int>(m_bitPos % 64);
+        int room = 64 - used;
+        m_bitPos += bits;
+        if (index >= m_wordCount)
+            return 0;
+
+        uint64_t value;
+        if (bits <= room)
+        {
+            value = m_words[index] >> (room - bits);
+        }
+        else
+        {
+            value = m_words[index] << (bits - room);
+            if (index + 1 < m_wordCount)
+                value |= m_words[index + 1] >> (64 - (bits - room));
+        }
+        return bits < 64 ? value & ((1ULL << bits) - 1) : value;
+    }
+
+    bool readBit() { return read(1) != 0; }
+
+private:
+    const uint64_t* m_words;
+    size_t m_wordCount;
+    uint64_t m_bitPos = 0;
+};
+
+// delta-of-delta 구간 (마이크로초 시각 기준: ±8ms, ±0.5s, ±35분, 그 외)
+struct DodBucket
+{
+    uint64_t prefix;
+    int prefixBits;
+    int valueBits;
+};
+constexpr DodBucket kDodBuckets[] = {
+    {0b10, 2, 14},
+    {0b110, 3, 20},
+    {0b1110, 4, 32},
+};
+
+// Gorilla 방식 블록 인코더 (블록 첫 점은 원본 그대로 기록)
+struct BlockEncoder
+{
+    BitWriter bits;
+    uint32_t count = 0;
+    int64_t firstUs = 0;
+    int64_t prevUs = 0;
+    int64_t prevDelta = 0;
+    uint64_t prevValue = 0;
+    int prevLeading = -1;
+    int prevTrailing = 0;
+
+    void append(int64_t timeUs, double value)
+    {
+        uint64_t valueBits = doubleBits(value);
+        if (count == 0)
+        {
+            bits.write(static_cast<uint64_t>(timeUs), 64);
+            bits.write(valueBits, 64);
+            firstUs = prevUs = timeUs;
+            prevDelta = 0;
+            prevValue = valueBits;
+            prevLeading = -1;
+            ++count;
+            return;
+        }
+
+        // 시각: 이전 간격과의 차이만 기록 (주기적인 센서는 대부분 1~3바이트)
+        int64_t delta = timeUs - prevUs;
+        int64_t dod = delta - prevDelta;
+        if (dod == 0)
+        {
+            bits.write(0, 1);
+        }
+        else
+        {
+            bool written = false;
+            for (const DodBucket& bucket : kDodBuckets)
+            {
+                int64_t limit = 1LL << (bucket.valueBits - 1);
+                if (dod >= -limit + 1 && dod <= limit)
+                {
+                    bits.write(bucket.prefix, bucket.prefixBits);
+                    bits.write(static_cast<uint64_t>(dod + limit - 1), bucket.valueBits);
+                    written = true;
+                    break;
+                }
+            }
+            if (!written)
+            {
+                bits.write(0b1111, 4);
+                bits.write(static_cast<uint64_t>(dod), 64);
+            }
+        }
+
+        // 값: 이전 값과 XOR해서 달라진 비트 구간만 기록
+        uint64_t x = valueBits ^ prevValue;
+        if (x == 0)
+        {
+            bits.write(0, 1);
+        }
+        else
+        {
+            bits.write(1, 1);
+            int leading = __builtin_clzll(x);
+            int trailing = __builtin_ctzll(x);
+            if (leading > 31)
+                leading = 31;
+
+            if (prevLeading >= 0 && leading >= prevLeading && trailing >= prevTrailing)
+            {
+                // 이전 구간 안에 들어가면 구간 정보 생략
+                bits.write(0, 1);
+                bits.write(x >> prevTrailing, 64 - prevLeading - prevTrailing);
+            }
+            else
+            {
+                int meaningful = 64 - leading - trailing;
+                bits.write(1, 1);
+                bits.write(static_cast<uint64_t>(leading), 5);
+                bits.write(static_cast<uint64_t>(meaningful - 1), 6);
+                bits.write(x >> trailing, meaningful);
+                prevLeading = leading;
+                prevTrailing = trailing;
+            }
+        }
+
+        prevDelta = delta;
+        prevUs = timeUs;
+        prevValue = valueBits;
+        ++count;
+    }
+
+    void clear()
+    {
+        bits.clear();
+        count = 0;
+        prevLeading = -1;
+    }
+};
+
+// 블록 하나를 복원해서 [fromUs, toUs] 구간의 점만 out에 추가
+size_t decodeBlock(const uint64_t* words, size_t wordCount, uint32_t count,
+                   int64_t fromUs, int64_t toUs, std::vector<TimePoint>& out)
+{
+    BitReader reader(words, wordCount);
+    size_t added = 0;
+
+    int64_t timeUs = static_cast<int64_t>(reader.read(64));
+    uint64_t valueBits = reader.read(64);
+    int64_t delta = 0;
+    int leading = 0;
+    int trailing = 0;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (i > 0)
+        {
+            // prefix의 1 개수로 구간 구분 (10, 110, 1110, 1111)
+            int64_t dod = 0;
+            if (reader.readBit())
+            {
+                int ones = 1;
+                while (ones < 4 && reader.readBit())
+                    ++ones;
+
+                if (ones < 4)
+                {
+                    const DodBucket& bucket = kDodBuckets[ones - 1];
+                    int64_t limit = 1LL << (bucket.valueBits - 1);
+                    dod = static_cast<int64_t>(reader.read(bucket.valueBits)) - limit + 1;
+                }
+                else
+                {
+                    dod = static_cast<int64_t>(reader.read(64));
+                }
+            }
+            delta += dod;
+            timeUs += delta;
+
+            if (reader.readBit())
+            {
+                if (reader.readBit())
+                {
+                    leading = static_cast<int>(reader.read(5));
+                    int meaningful = static_cast<int>(reader.read(6)) + 1;
+                    trailing = 64 - leading - meaningful;
+                }
+                valueBits ^= reader.read(64 - leading - trailing) << trailing;
+            }
+        }
+
+        if (timeUs > toUs)
+            break;
+        if (timeUs >= fromUs)
+        {
+            out.push_back(TimePoint{timeUs, bitsDouble(valueBits)});
+            ++added;
+        }
+    }
+    return added;
+}
+
+std::string fileNameFor(std::string_view series)
+{
+    std::string name;
+    name.reserve(series.size() + 3);
+    for (char c : series)
+    {
+        bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                    c == '.' || c == '_' || c == '-';
+        name += safe ? c : '_';
+    }
+    return name + kFileSuffix;
+}
+
+} // namespace
+
+// 시계열 하나 (파일 + 열린 블록)
+struct TimeSeriesStore::Series
+{
+    struct BlockIndex
+    {
+        size_t offset;
+        int64_t firstUs;
+        int64_t lastUs;
+        uint32_t count;
+    };
+
+    std::string name;
+    int fd = -1;
+    char* base = nullptr;           // mmap 시작 주소
+    size_t mappedSize = 0;
+    size_t fileEnd = 0;             // 마지막 정상 블록 끝
+    std::vector<BlockIndex> blocks;
+    uint64_t sealedPoints = 0;
+
+    BlockEncoder pending;           // 아직 파일에 기록하지 않은 최근 점
+    int64_t lastUs = INT64_MIN;
+
+    mutable std::mutex mutex;
+
+    ~Series()
+    {
+        if (base)
+            munmap(base, mappedSize);
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    bool map(size_t size)
+    {
+        if (ftruncate(fd, static_cast<off_t>(size)) < 0)
+            return false;
+
+        void* mapped;
+        if (base)
+            mapped = mremap(base, mappedSize, size, MREMAP_MAYMOVE);
+        else
+            mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED)
+            return false;
+
+        base = static_cast<char*>(mapped);
+        mappedSize = size;
+        return true;
+    }
+
+    // 기존 블록을 검사해서 이어 쓸 위치를 찾음 (깨진 블록 이후는 지움)
+    void scan()
+    {
+        size_t offset = 0;
+        while (offset + sizeof(BlockHeader) <= mappedSize)
+        {
+            BlockHeader header;
+            std::memcpy(&header, base + offset, sizeof(header));
+            size_t end = offset + sizeof(header) + header.payloadBytes;
+            if (header.magic != kBlockMagic || header.payloadBytes % 8 != 0 || end > mappedSize ||
+                checksum(base + offset + sizeof(header), header.payloadBytes) != header.checksum)
+            {
+                break;
+            }
+
+            blocks.push_back(BlockIndex{offset, header.firstUs, header.lastUs, header.count});
+            sealedPoints += header.count;
+            lastUs = header.lastUs;
+            offset = end;
+        }
+
+        // 기록 도중 끊긴 블록이 남아 있으면 지워서 이후 블록과 섞이지 않게 함
+        fileEnd = offset;
+        if (fileEnd + sizeof(uint32_t) <= mappedSize &&
+            *reinterpret_cast<const uint32_t*>(base + fileEnd) != 0)
+        {
+            std::memset(base + fileEnd, 0, mappedSize - fileEnd);
+        }
+    }
+
+    // 열린 블록을 파일 끝에 추가 (payload를 먼저 쓰고 magic은 마지막에 기록)
+    bool seal(size_t growBytes)
+    {
+        if (pending.count == 0)
+            return true;
+
+        size_t payloadBytes = pending.bits.byteSize();
+        size_t needed = fileEnd + sizeof(BlockHeader) + payloadBytes;
+        if (needed > mappedSize)
+        {
+            size_t size = mappedSize;
+            while (size < needed)
+                size += growBytes;
+            if (!map(size))
+            {
+                LOG_ERROR("시계열 파일 확장 실패: %s: %s", name.c_str(), strerror(errno));
+                return false;
+            }
+        }
+
+        char* payload = base + fileEnd + sizeof(BlockHeader);
+        std::memcpy(payload, pending.bits.words().data(), payloadBytes);
+
+        BlockHeader header;
+        header.magic = 0;
+        header.count = pending.count;
+        header.firstUs = pending.firstUs;
+        header.lastUs = pending.prevUs;
+        header.payloadBytes = static_cast<uint32_t>(payloadBytes);
+        header.checksum = checksum(payload, payloadBytes);
+        std::memcpy(base + fileEnd, &header, sizeof(header));
+        __atomic_store_n(reinterpret_cast<uint32_t*>(base + fileEnd), kBlockMagic, __ATOMIC_RELEASE);
+
+        blocks.push_back(BlockIndex{fileEnd, header.firstUs, header.lastUs, header.count});
+        sealedPoints += header.count;
+        fileEnd = needed;
+        pending.clear();
+        return true;
+    }
+};
+
+TimeSeriesStore::TimeSeriesStore()
+    : m_open(false)
+{
+}
+
+TimeSeriesStore::~TimeSeriesStore()
+{
+    close();
+}
+
+bool TimeSeriesStore::open(const TimeSeriesOptions& options)
+{
+    close();
+    m_options = options;
+    if (m_options.pointsPerBlock == 0)
+        m_options.pointsPerBlock = 1;
+    if (m_options.growBytes < 4096)
+        m_options.growBytes = 4096;
+
+    if (mkdir(m_options.directory.c_str(), 0755) < 0 && errno != EEXIST)
+    {
+        LOG_ERROR("시계열 디렉터리 생성 실패: %s: %s", m_options.directory.c_str(), strerror(errno));
+        return false;
+    }
+
+    DIR* dir = opendir(m_options.directory.c_str());
+    if (!dir)
+    {
+        LOG_ERROR("시계열 디렉터리 열기 실패: %s: %s", m_options.directory.c_str(), strerror(errno));
+        return false;
+    }
+
+    m_open = true;
+    std::vector<std::string> names;
+    while (struct dirent* entry = readdir(dir))
+    {
+        std::string fileName = entry->d_name;
+        size_t suffixLength = std::strlen(kFileSuffix);
+        if (fileName.size() > suffixLength &&
+            fileName.compare(fileName.size() - suffixLength, suffixLength, kFileSuffix) == 0)
+        {
+            names.push_back(fileName.substr(0, fileName.size() - suffixLength));
+        }
+    }
+    closedir(dir);
+
+    for (const std::string& name : names)
+    {
+        getOrCreateSeries(name);
+    }
+    return true;
+}
+
+void TimeSeriesStore::close()
+{
+    if (!m_open)
+        return;
+
+    flush();
+    std::unique_lock<std::shared_mutex> lock(m_seriesMutex);
+    m_series.clear();
+    m_open = false;
+}
+
+void TimeSeriesStore::flush()
+{
+    std::shared_lock<std::shared_mutex> lock(m_seriesMutex);
+    for (auto& it : m_series)
+    {
+        Series& series = *it.second;
+        std::lock_guard<std::mutex> seriesLock(series.mutex);
+        series.seal(m_options.growBytes);
+        if (series.base)
+            msync(series.base, series.fileEnd, MS_SYNC);
+    }
+}
+
+TimeSeriesStore::Series* TimeSeriesStore::findSeries(std::string_view name) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_seriesMutex);
+    auto it = m_series.find(name);
+    return it == m_series.end() ? nullptr : it->second.get();
+}
+
+TimeSeriesStore::Series* TimeSeriesStore::getOrCreateSeries(std::string_view name)
+{
+    if (Series* existing = findSeries(name))
+        return existing;
+
+    std::unique_lock<std::shared_mutex> lock(m_seriesMutex);
+    auto it = m_series.find(name);
+    if (it != m_series.end())
+        return it->second.get();
+
+    std::unique_ptr<Series> series(new Series());
+    series->name = std::string(name);
+
+    std::string path = m_options.directory + "/" + fileNameFor(name);
+    series->fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    struct stat info;
+    if (series->fd < 0 || fstat(series->fd, &info) < 0)
+    {
+        LOG_ERROR("시계열 파일 열기 실패: %s: %s", path.c_str(), strerror(errno));
+        return nullptr;
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    if (size < m_options.growBytes)
+        size = m_options.growBytes;
+    if (!series->map(size))
+    {
+        LOG_ERROR("시계열 파일 mmap 실패: %s: %s", path.c_str(), strerror(errno));
+        return nullptr;
+    }
+    series->scan();
+
+    Series* result = series.get();
+    m_series.emplace(std::string(name), std::move(series));
+    return result;
+}
+
+bool TimeSeriesStore::append(std::string_view name, int64_t timeUs, double value)
+{
+    if (!m_open)
+        return false;
+
+    Series* series = getOrCreateSeries(name);
+    if (!series)
+        return false;
+
+    std::lock_guard<std::mutex> lock(series->mutex);
+    if (timeUs < series->lastUs)
+        return false;
+
+    series->pending.append(timeUs, value);
+    series->lastUs = timeUs;
+    if (series->pending.count >= m_options.pointsPerBlock)
+        series->seal(m_options.growBytes);
+    return true;
+}
+
+void TimeSeriesStore::write(uint32_t homeId, std::string_view device, int64_t timeUs, const SensorSample& sample)
+{
+    // "[h<home>.]<디바이스>.<필드>" 이름을 스택 버퍼에서 만들어 힙 할당 없이 조회
+    // 기본 home은 접두사 없이 두어 기존 시계열 파일을 그대로 이어 씀
+    char name[128];
+    size_t prefix = 0;
+    if (homeId != kDefaultHomeId)
+        prefix = static_cast<size_t>(std::snprintf(name, 16, "h%u.", homeId));
+    size_t length = std::min(device.size(), sizeof(name) - 48);
+    std::memcpy(name + prefix, device.data(), length);
+    prefix += length;
+    name[prefix] = '.';
+
+    double values[kMaxSampleFields];
+    size_t count = sampleFieldValues(sample, values);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const char* field = sampleFieldName(sample.index(), i);
+        size_t length = std::strlen(field);
+        std::memcpy(name + prefix + 1, field, length);
+        append(std::string_view(name, prefix + 1 + length), timeUs, values[i]);
+    }
+}
+
+size_t TimeSeriesStore::query(std::string_view name, int64_t fromUs, int64_t toUs,
+                              std::vector<TimePoint>& out) const
+{
+    Series* series = findSeries(name);
+    if (!series)
+        return 0;
+
+    std::lock_guard<std::mutex> lock(series->mutex);
+    size_t added = 0;
+    for (const Series::BlockIndex& block : series->blocks)
+    {
+        if (block.lastUs < fromUs || block.firstUs > toUs)
+            continue;
+
+        BlockHeader header;
+        std::memcpy(&header, series->base + block.offset, sizeof(header));
+        const uint64_t* words = reinterpret_cast<const uint64_t*>(series->base + block.offset + sizeof(header));
+        added += decodeBlock(words, header.payloadBytes / 8, header.count, fromUs, toUs, out);
+    }
+
+    const BlockEncoder& pending = series->pending;
+    if (pending.count > 0 && pending.prevUs >= fromUs && pending.firstUs <= toUs)
+    {
+        added += decodeBlock(pending.bits.words().data(), pending.bits.words().size(), pending.count,
+                             fromUs, toUs, out);
+    }
+    return added;
+}
+
+std::vector<std::string> TimeSeriesStore::seriesNames() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_seriesMutex);
+    std::vector<std::string> names;
+    for (auto& it : m_series)
+        names.push_back(it.first);
+    return names;
+}
+
+TimeSeriesStats TimeSeriesStore::stats() const
+{
+    TimeSeriesStats s;
+    std::shared_lock<std::shared_mutex> lock(m_seriesMutex);
+    s.series = m_series.size();
+    for (auto& it : m_series)
+    {
+        const Series& series = *it.second;
+        std::lock_guard<std::mutex> seriesLock(series.mutex);
+        s.points += series.sealedPoints + series.pending.count;
+        s.blocks += series.blocks.size();
+        s.storedBytes += series.fileEnd + series.pending.bits.byteSize();
+    }
+    if (s.points > 0)
+        s.bytesPerPoint = static_cast<double>(s.storedBytes) / s.points;
+    return s;
+}
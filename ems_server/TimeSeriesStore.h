@@ -0,0 +1,82 @@
+#ifndef TIMESERIESSTORE_H
+#define TIMESERIESSTORE_H
+
+#include "SensorSink.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <cstdint>
+
+struct TimePoint
+{
+    int64_t timeUs;
+    double value;
+};
+
+struct TimeSeriesOptions
+{
+    std::string directory = "tsdata";           // 시계열 파일 디렉터리 (없으면 생성)
+    size_t pointsPerBlock = 1024;               // 압축 블록 하나에 묶는 점 수
+    size_t growBytes = 1 << 20;                 // 파일을 늘리는 단위
+};
+
+struct TimeSeriesStats
+{
+    size_t series = 0;
+    uint64_t points = 0;            // 저장된 점 수 (열린 블록 포함)
+    uint64_t blocks = 0;            // 파일에 기록된 블록 수
+    uint64_t storedBytes = 0;       // 파일에 기록된 바이트 + 열린 블록 바이트
+    double bytesPerPoint = 0.0;     // 압축 전에는 점 하나당 16바이트
+};
+
+// 외부 서비스 없이 동작하는 내장 시계열 저장소
+// 시계열("<디바이스>.<필드>", 기본 home이 아니면 "h<home>.<디바이스>.<필드>")마다 append 전용 파일 하나를 mmap으로 열고,
+// 점을 블록 단위로 모아 Gorilla 방식(시각은 delta-of-delta, 값은 이전 값과의 XOR)으로 압축해서 추가함
+// 블록은 독립적으로 복원 가능하고 체크섬이 있어서 재시작 시 마지막 정상 블록 뒤부터 이어 씀
+// 아직 블록이 차지 않은 최근 점은 메모리에만 있으며 flush/close 시 파일에 기록됨
+class TimeSeriesStore : public SensorSink
+{
+public:
+    TimeSeriesStore();
+    ~TimeSeriesStore();
+    TimeSeriesStore(const TimeSeriesStore&) = delete;
+    TimeSeriesStore& operator=(const TimeSeriesStore&) = delete;
+
+    // 디렉터리의 기존 시계열 파일을 모두 열고 이어 쓸 위치를 찾음
+    bool open(const TimeSeriesOptions& options);
+    void close();
+    bool isOpen() const { return m_open; }
+
+    // SensorSink: 샘플의 필드마다 시계열 하나씩 기록 (예: fireModule.gasData, h2.fireModule.gasData)
+    void write(uint32_t homeId, std::string_view device, int64_t timeUs, const SensorSample& sample) override;
+
+    // 열린 블록을 파일에 기록하고 msync
+    void flush() override;
+
+    // 같은 시계열에는 시각 순서대로 추가해야 함 (역순이면 false)
+    bool append(std::string_view series, int64_t timeUs, double value);
+
+    // [fromUs, toUs] 구간의 점을 out 뒤에 추가하고 추가한 개수 반환
+    size_t query(std::string_view series, int64_t fromUs, int64_t toUs, std::vector<TimePoint>& out) const;
+
+    std::vector<std::string> seriesNames() const;
+    TimeSeriesStats stats() const;
+
+    struct Series;
+
+private:
+    Series* findSeries(std::string_view name) const;
+    Series* getOrCreateSeries(std::string_view name);
+
+    TimeSeriesOptions m_options;
+    bool m_open;
+
+    mutable std::shared_mutex m_seriesMutex;        // 시계열 목록 (점 추가는 시계열별 락)
+    std::map<std::string, std::unique_ptr<Series>, std::less<>> m_series;
+};
+
+#endif // TIMESERIESSTORE_H
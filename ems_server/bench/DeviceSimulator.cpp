@@ -0,0 +1,186 @@
+#include "DeviceSimulator.h"
+#include <pty.h>
+#include <pthread.h>
+#include <termios.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <algorithm>
+
+namespace
+{
+
+constexpr size_t kMaxBurst = 64;            // 한 번에 몰아서 쓰는 최대 줄 수
+constexpr int kIdlePollMs = 100;
+
+double threadCpuSeconds(std::thread& thread)
+{
+    clockid_t clock;
+    struct timespec ts;
+    if (!thread.joinable() || pthread_getcpuclockid(thread.native_handle(), &clock) != 0 ||
+        clock_gettime(clock, &ts) != 0)
+    {
+        return 0.0;
+    }
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+} // namespace
+
+DeviceSimulator::DeviceSimulator(Module module, double linesPerSecond, SampleTracker& tracker)
+    : m_module(module),
+      m_rate(module == Module::Actuator ? 0.0 : linesPerSecond),
+      m_tracker(tracker),
+      m_masterFd(-1),
+      m_slaveFd(-1),
+      m_running(false),
+      m_sentLines(0),
+      m_receivedBytes(0)
+{
+}
+
+DeviceSimulator::~DeviceSimulator()
+{
+    stop();
+    if (m_masterFd >= 0)
+        close(m_masterFd);
+    if (m_slaveFd >= 0)
+        close(m_slaveFd);
+}
+
+bool DeviceSimulator::open()
+{
+    char name[64];
+    if (openpty(&m_masterFd, &m_slaveFd, name, nullptr, nullptr) < 0)
+    {
+        perror("openpty 실패");
+        return false;
+    }
+
+    // 에코/줄 편집 없이 바이트 그대로 전달 (실제 rfcomm 포트와 같게)
+    struct termios tio;
+    tcgetattr(m_slaveFd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(m_slaveFd, TCSANOW, &tio);
+
+    m_path = name;
+    return true;
+}
+
+void DeviceSimulator::start()
+{
+    if (m_running || m_masterFd < 0)
+        return;
+    m_running = true;
+    m_thread = std::thread(&DeviceSimulator::run, this);
+}
+
+void DeviceSimulator::stop()
+{
+    m_running = false;
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+double DeviceSimulator::cpuSeconds()
+{
+    return threadCpuSeconds(m_thread);
+}
+
+size_t DeviceSimulator::formatLine(char* out, size_t size, uint32_t slot)
+{
+    int n = 0;
+    switch (m_module)
+    {
+    case Module::Fire:
+        n = snprintf(out, size, "iot01_fire_%u_%.1f\n", slot, 600.0 + (slot % 200));
+        break;
+    case Module::Pet:
+        n = snprintf(out, size, "iot01_pet_%u_%u_%u\n", slot & 1, (slot >> 1) & 1, (slot >> 2) & 1);
+        break;
+    case Module::Plant:
+        n = snprintf(out, size, "iot01_plant_%u_%.1f_%.1f_%.1f\n",
+                     slot, 300.0 + (slot % 50), 20.0 + (slot % 10), 40.0 + (slot % 20));
+        break;
+    case Module::Actuator:
+        break;
+    }
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+void DeviceSimulator::drainCommands()
+{
+    char buffer[1024];
+    while (true)
+    {
+        ssize_t n = read(m_masterFd, buffer, sizeof(buffer));
+        if (n > 0)
+        {
+            m_receivedBytes.fetch_add(n, std::memory_order_relaxed);
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        return;
+    }
+}
+
+// 경과 시간 × 속도만큼 밀린 줄을 몰아서 쓰고, 다음 줄 시각까지는 명령을 읽으며 대기
+void DeviceSimulator::run()
+{
+    fcntl(m_masterFd, F_SETFL, fcntl(m_masterFd, F_GETFL, 0) | O_NONBLOCK);
+
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t sent = 0;
+    std::string burst;
+    char line[96];
+
+    while (m_running)
+    {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        uint64_t due = (m_rate > 0.0) ? static_cast<uint64_t>(elapsed * m_rate) : 0;
+
+        if (due > sent)
+        {
+            size_t count = static_cast<size_t>(std::min<uint64_t>(due - sent, kMaxBurst));
+            burst.clear();
+            for (size_t i = 0; i < count; ++i)
+                burst.append(line, formatLine(line, sizeof(line), m_tracker.acquire()));
+
+            // 서버가 못 따라오면 여기서 밀림 (pty 버퍼가 찰 때까지 쓰고 기다림)
+            size_t offset = 0;
+            while (offset < burst.size() && m_running)
+            {
+                ssize_t n = write(m_masterFd, burst.data() + offset, burst.size() - offset);
+                if (n > 0)
+                {
+                    offset += n;
+                    continue;
+                }
+                if (n < 0 && errno != EAGAIN && errno != EINTR)
+                    break;
+
+                struct pollfd pfd = {m_masterFd, POLLOUT, 0};
+                poll(&pfd, 1, kIdlePollMs);
+                drainCommands();
+            }
+            sent += count;
+            m_sentLines.fetch_add(count, std::memory_order_relaxed);
+            continue;
+        }
+
+        int waitMs = kIdlePollMs;
+        if (m_rate > 0.0)
+        {
+            double nextAt = (sent + 1) / m_rate;
+            waitMs = std::max(1, std::min(kIdlePollMs, static_cast<int>((nextAt - elapsed) * 1000.0)));
+        }
+
+        struct pollfd pfd = {m_masterFd, POLLIN, 0};
+        if (poll(&pfd, 1, waitMs) > 0)
+            drainCommands();
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef DEVICESIMULATOR_H
+#define DEVICESIMULATOR_H
+
+#include "SampleTracker.h"
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+// openpty 쌍으로 흉내 낸 아두이노 모듈
+// slave 경로를 BluetoothManager::addDevice에 등록하면 실제 rfcomm 포트처럼 동작함
+// 정해진 속도로 센서 줄을 보내고, 서버가 보낸 명령은 읽어서 버림
+class DeviceSimulator
+{
+public:
+    enum class Module
+    {
+        Fire,
+        Pet,
+        Plant,
+        Actuator        // 센서 줄 없이 명령만 받는 모듈 (window/light/door)
+    };
+
+    DeviceSimulator(Module module, double linesPerSecond, SampleTracker& tracker);
+    ~DeviceSimulator();
+    DeviceSimulator(const DeviceSimulator&) = delete;
+    DeviceSimulator& operator=(const DeviceSimulator&) = delete;
+
+    // pty 생성 (slave는 raw 모드, 서버가 열 수 있도록 열어둔 채 유지)
+    bool open();
+    const std::string& path() const { return m_path; }
+
+    void start();
+    void stop();
+
+    uint64_t sentLines() const { return m_sentLines.load(std::memory_order_relaxed); }
+    uint64_t receivedBytes() const { return m_receivedBytes.load(std::memory_order_relaxed); }
+    // 시뮬레이터 스레드가 지금까지 쓴 CPU 시간 (실행 중에만 유효, 서버 CPU 계산 시 제외용)
+    double cpuSeconds();
+
+private:
+    void run();
+    size_t formatLine(char* out, size_t size, uint32_t slot);
+    void drainCommands();
+
+    Module m_module;
+    double m_rate;
+    SampleTracker& m_tracker;
+    int m_masterFd;
+    int m_slaveFd;
+    std::string m_path;
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+
+    std::atomic<uint64_t> m_sentLines;
+    std::atomic<uint64_t> m_receivedBytes;
+};
+
+#endif // DEVICESIMULATOR_H
@@ -0,0 +1,41 @@
+#include "MemoryBatchWriter.h"
+#include <cstring>
+#include <thread>
+
+MemoryBatchWriter::MemoryBatchWriter(const SampleTracker& tracker,
+                                     std::chrono::microseconds batchLatency)
+    : m_tracker(tracker), m_batchLatency(batchLatency), m_available(true), m_rows(0), m_batches(0)
+{
+}
+
+bool MemoryBatchWriter::writeBatch(const InsertSpec& spec, const void* rows, size_t count)
+{
+    if (m_batchLatency.count() > 0)
+        std::this_thread::sleep_for(m_batchLatency);
+    if (!m_available.load(std::memory_order_relaxed))
+        return false;
+
+    if (std::strcmp(spec.table, "fire_events") == 0)
+    {
+        const FireRow* fire = static_cast<const FireRow*>(rows);
+        for (size_t i = 0; i < count; ++i)
+            recordSlot(static_cast<uint32_t>(fire[i].fireData));
+    }
+    else if (std::strcmp(spec.table, "plant_env") == 0)
+    {
+        const PlantRow* plant = static_cast<const PlantRow*>(rows);
+        for (size_t i = 0; i < count; ++i)
+            recordSlot(static_cast<uint32_t>(plant[i].soil));
+    }
+
+    m_rows.fetch_add(count, std::memory_order_relaxed);
+    m_batches.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void MemoryBatchWriter::recordSlot(uint32_t slot)
+{
+    int64_t elapsed = m_tracker.elapsedNanos(slot);
+    if (elapsed >= 0)
+        m_endToEnd.record(static_cast<uint64_t>(elapsed));
+}
@@ -0,0 +1,39 @@
+#ifndef MEMORYBATCHWRITER_H
+#define MEMORYBATCHWRITER_H
+
+#include "DBManager.h"
+#include "Metrics.h"
+#include "SampleTracker.h"
+#include <atomic>
+#include <chrono>
+
+// MySQL 대신 행을 세기만 하는 메모리 sink (DBManager::connect(writer)로 연결)
+// fire_events/plant_env 행은 첫 숫자 필드의 slot 번호로 종단 간 지연 시간을 기록
+class MemoryBatchWriter : public BatchWriter
+{
+public:
+    // batchLatency: 배치마다 흉내 낼 DB 왕복 시간 (0이면 바로 반환)
+    MemoryBatchWriter(const SampleTracker& tracker, std::chrono::microseconds batchLatency);
+
+    bool writeBatch(const InsertSpec& spec, const void* rows, size_t count) override;
+
+    // false면 MySQL 장애처럼 모든 배치를 거부 (spool 재기록 측정용)
+    void setAvailable(bool available) { m_available.store(available, std::memory_order_relaxed); }
+
+    uint64_t rows() const { return m_rows.load(std::memory_order_relaxed); }
+    uint64_t batches() const { return m_batches.load(std::memory_order_relaxed); }
+    const LatencyHistogram& endToEnd() const { return m_endToEnd; }
+    void resetLatency() { m_endToEnd.reset(); }
+
+private:
+    void recordSlot(uint32_t slot);
+
+    const SampleTracker& m_tracker;
+    std::chrono::microseconds m_batchLatency;
+    std::atomic<bool> m_available;
+    std::atomic<uint64_t> m_rows;
+    std::atomic<uint64_t> m_batches;
+    LatencyHistogram m_endToEnd;       // 시뮬레이터 송신 → sink 도착
+};
+
+#endif // MEMORYBATCHWRITER_H
@@ -0,0 +1,51 @@
+#ifndef SAMPLETRACKER_H
+#define SAMPLETRACKER_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <cstdint>
+
+// 시뮬레이터가 보낸 센서 줄의 송신 시각 기록 (줄의 숫자 필드에 slot 번호를 실어 보냄)
+// sink에서 slot 번호로 송신 시각을 찾아 종단 간 지연 시간을 계산
+class SampleTracker
+{
+public:
+    // slot 번호는 float 필드로도 정확히 전달되도록 2^24 미만
+    static constexpr uint32_t kSlots = 1u << 20;
+
+    SampleTracker() : m_sentAt(new std::atomic<int64_t>[kSlots]), m_next(0)
+    {
+        for (uint32_t i = 0; i < kSlots; ++i)
+            m_sentAt[i].store(0, std::memory_order_relaxed);
+    }
+
+    static int64_t nowNanos()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 송신 직전에 slot을 받아서 줄에 넣음
+    uint32_t acquire()
+    {
+        uint32_t slot = static_cast<uint32_t>(m_next.fetch_add(1, std::memory_order_relaxed) % kSlots);
+        m_sentAt[slot].store(nowNanos(), std::memory_order_relaxed);
+        return slot;
+    }
+
+    // slot의 송신 후 경과 시간 (모르는 slot이면 -1)
+    int64_t elapsedNanos(uint32_t slot) const
+    {
+        if (slot >= kSlots)
+            return -1;
+        int64_t sentAt = m_sentAt[slot].load(std::memory_order_relaxed);
+        return sentAt == 0 ? -1 : nowNanos() - sentAt;
+    }
+
+private:
+    std::unique_ptr<std::atomic<int64_t>[]> m_sentAt;
+    std::atomic<uint64_t> m_next;
+};
+
+#endif // SAMPLETRACKER_H
@@ -0,0 +1,46 @@
+// 센서 줄 파서 처리량 측정
+// 사용법: ./SensorParserBench [반복 횟수]
+#include "SensorParser.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[])
+{
+    size_t iterations = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 5000000;
+
+    // 정상 줄과 잘못된 줄을 섞은 입력
+    std::vector<std::string> lines = {
+        "iot01_fire_150_650.5",
+        "iot01_fire_98_712.25",
+        "iot01_pet_1_0_1",
+        "iot01_plant_512.0_300.5_24.5_45.0",
+        "iot01_plant_498.5_310.0_24.7_44.8",
+        "iot01_fire_abc_650.5",
+        "iot01_unknown_1",
+        "garbage",
+    };
+
+    SensorParser parser;
+    SensorSample sample;
+    uint64_t checksum = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const std::string& line = lines[i % lines.size()];
+        checksum += static_cast<uint64_t>(parser.parse(line, sample));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::printf("lines:        %zu\n", iterations);
+    std::printf("accepted:     %llu\n", static_cast<unsigned long long>(parser.acceptedLines()));
+    std::printf("rejected:     %llu\n", static_cast<unsigned long long>(parser.rejectedLines()));
+    std::printf("elapsed:      %.3f s\n", seconds);
+    std::printf("throughput:   %.2f M lines/s\n", iterations / seconds / 1e6);
+    std::printf("per line:     %.1f ns\n", seconds * 1e9 / iterations);
+    std::printf("(checksum %llu)\n", static_cast<unsigned long long>(checksum));
+    return 0;
+}
@@ -0,0 +1,419 @@
+// 서버 전체 부하 벤치마크 (실제 블루투스 모듈/MySQL 없이 실행)
+// - openpty 가상 아두이노 모듈이 fire/pet/plant 센서 줄을 정해진 속도로 전송
+// - TCP 부하 생성기가 window_open 등 명령과 get 조회를 파이프라이닝으로 전송
+// - 구독 클라이언트가 subscribe all로 센서 업데이트를 받음 (--subscribers)
+// - DB 대신 MemoryBatchWriter가 행을 받아서 종단 간 지연 시간 기록
+//
+// 사용법: ./ServerBench [--seconds 10] [--warmup 1] [--devices 1] [--rate 200]
+//                       [--tcp-clients 2] [--tcp-window 8] [--db-latency-us 0]
+//                       [--batch 256] [--flush-ms 200] [--workers 0] [--port 18080]
+//                       [--tsdb <디렉터리>] [--subscribers 0] [--aggregate 0] [--homes 1]
+//                       [--tcp-binary 0] [--spool <디렉터리>] [--db-outage 0]
+//                       [--debounce-ms 0] [--state-ttl-ms 0]
+// 마지막 RESULT 줄은 회귀 비교용 key=value 형식
+#include "BluetoothManager.h"
+#include "DBManager.h"
+#include "TCPServer.h"
+#include "LatestValueCache.h"
+#include "SubscriptionHub.h"
+#include "SampleAggregator.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "DeviceSimulator.h"
+#include "MemoryBatchWriter.h"
+#include "SampleTracker.h"
+#include "TcpLoadGenerator.h"
+#include "SubscriberLoad.h"
+#include "TimeSeriesStore.h"
+#include <sys/resource.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct Options
+{
+    double seconds = 10.0;
+    double warmup = 1.0;
+    size_t devices = 1;             // home마다 센서 종류(fire/pet/plant)별 가상 모듈 수
+    size_t homes = 1;               // 센서 모듈을 가진 home 수 (액추에이터 모듈과 TCP 부하는 기본 home만)
+    double rate = 200.0;            // 모듈 하나의 초당 줄 수
+    size_t tcpClients = 2;
+    size_t tcpWindow = 8;
+    bool tcpBinary = false;         // TCP 부하를 바이너리 프로토콜로 전송
+    long dbLatencyUs = 0;
+    size_t batch = 256;
+    long flushMs = 200;
+    size_t workers = 0;
+    int port = 18080;
+    std::string tsdb;               // 비어 있지 않으면 로컬 시계열 저장소도 sink로 추가
+    size_t subscribers = 0;         // subscribe all 스트림 클라이언트 수
+    bool aggregate = false;         // DB 앞에 SampleAggregator 사용 (샘플이 걸러지므로 종단 간 지연 측정 대상도 줄어듦)
+    std::string spool;              // 비어 있지 않으면 DB 행을 디스크 spool을 거쳐 기록
+    double dbOutage = 0.0;          // 측정 시작부터 이 시간(초) 동안 DB sink가 모든 배치를 거부
+    long debounceMs = 0;            // 구동기 명령 debounce (기본 0: 이전 결과와 비교할 수 있도록 끔)
+    long stateTtlMs = 0;            // 이미 그 상태인 구동기 명령을 보내지 않는 시간 (0이면 끔)
+};
+
+bool parseOptions(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const char* name = argv[i];
+        const char* value = argv[i + 1];
+        if (std::strcmp(name, "--seconds") == 0)            options.seconds = std::atof(value);
+        else if (std::strcmp(name, "--warmup") == 0)        options.warmup = std::atof(value);
+        else if (std::strcmp(name, "--devices") == 0)       options.devices = std::strtoul(value, nullptr, 10);
+        else if (std::strcmp(name, "--rate") == 0)          options.rate = std::atof(value);
+        else if (std::strcmp(name, "--tcp-clients") == 0)   options.tcpClients = std::strtoul(value, nullptr, 10);
+        else if (std::strcmp(name, "--tcp-window") == 0)    options.tcpWindow = std::strtoul(value, nullptr, 10);
+        else if (std::strcmp(name, "--tcp-binary") == 0)    options.tcpBinary = std::atoi(value) != 0;
+        else if (std::strcmp(name, "--db-latency-us") == 0) options.dbLatencyUs = std::atol(value);
+        else if (std::strcmp(name, "--batch") == 0)         options.batch = std::strtoul(value, nullptr, 10);
+        else if (std::strcmp(name, "--flush-ms") == 0)      options.flushMs = std::atol(value);
+        else if (std::strcmp(name, "--workers") == 0)       options.workers = std::strtoul(value, nullptr, 10);
+        else if (std::strcmp(name, "--port") == 0)          options.port = std::atoi(value);
+        else if (std::strcmp(name, "--tsdb") == 0)          options.tsdb = value;
+        else if (std::strcmp(name, "--subscribers") == 0)   options.subscribers = std::strtoul(value, nullptr, 10);
+        else if (std::strcmp(name, "--aggregate") == 0)     options.aggregate = std::atoi(value) != 0;
+        else if (std::strcmp(name, "--homes") == 0)         options.homes = std::strtoul(value, nullptr, 10);
+        else if (std::strcmp(name, "--spool") == 0)         options.spool = value;
+        else if (std::strcmp(name, "--db-outage") == 0)     options.dbOutage = std::atof(value);
+        else if (std::strcmp(name, "--debounce-ms") == 0)   options.debounceMs = std::atol(value);
+        else if (std::strcmp(name, "--state-ttl-ms") == 0)  options.stateTtlMs = std::atol(value);
+        else
+        {
+            std::fprintf(stderr, "알 수 없는 옵션: %s\n", name);
+            return false;
+        }
+    }
+    return (argc % 2) == 1;
+}
+
+double processCpuSeconds()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+void printLatency(const char* label, const LatencyHistogram& histogram, double scale, const char* unit)
+{
+    std::printf("%-22s count %-10llu p50 %9.3f  p99 %9.3f  p999 %9.3f  max %9.3f %s\n", label,
+                static_cast<unsigned long long>(histogram.count()),
+                histogram.percentile(0.5) / scale, histogram.percentile(0.99) / scale,
+                histogram.percentile(0.999) / scale, histogram.maxNanos() / scale, unit);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "사용법: %s [--seconds N] [--rate N] [--devices N] [--tcp-clients N] ...\n", argv[0]);
+        return 1;
+    }
+
+    // 벤치마크 중 콘솔 출력이 측정을 흔들지 않도록 경고 이상만 기록
+    Logger::instance().setLevel(LogLevel::Warn);
+
+    SampleTracker tracker;
+    auto sink = std::make_shared<MemoryBatchWriter>(tracker, std::chrono::microseconds(options.dbLatencyUs));
+
+    DBWriteOptions writeOptions;
+    writeOptions.batchSize = options.batch;
+    writeOptions.flushInterval = std::chrono::milliseconds(options.flushMs);
+    writeOptions.spool.directory = options.spool;
+    DBManager::instance().configure(writeOptions);
+    DBManager::instance().connect(sink);
+
+    TimeSeriesStore localStore;
+    if (!options.tsdb.empty())
+    {
+        TimeSeriesOptions storeOptions;
+        storeOptions.directory = options.tsdb;
+        if (!localStore.open(storeOptions))
+            return 1;
+    }
+
+    std::vector<std::unique_ptr<DeviceSimulator>> simulators;
+    BluetoothManager btManager;
+    btManager.setIngestWorkers(options.workers);
+    ActuatorOptions actuatorOptions;
+    actuatorOptions.debounce = std::chrono::milliseconds(options.debounceMs);
+    actuatorOptions.stateTtl = std::chrono::milliseconds(options.stateTtlMs);
+    btManager.setActuatorOptions(actuatorOptions);
+    LatestValueCache latestValues;
+    SubscriptionHub hub;
+    btManager.addSink(&latestValues);
+    btManager.addSink(&hub);
+    SampleAggregator aggregator(&DBManager::instance());
+    btManager.addSink(options.aggregate ? static_cast<SensorSink*>(&aggregator) : &DBManager::instance());
+    if (localStore.isOpen())
+        btManager.addSink(&localStore);
+
+    // 가상 모듈: 센서 모듈은 종류별 devices개, 액추에이터 모듈은 명령 수신용으로 하나씩
+    struct SimulatedModule
+    {
+        const char* name;
+        DeviceSimulator::Module module;
+        size_t count;
+    };
+    const SimulatedModule modules[] = {
+        {"fireModule", DeviceSimulator::Module::Fire, options.devices},
+        {"petModule", DeviceSimulator::Module::Pet, options.devices},
+        {"plantModule", DeviceSimulator::Module::Plant, options.devices},
+        {"windowModule", DeviceSimulator::Module::Actuator, 1},
+        {"lightModule", DeviceSimulator::Module::Actuator, 1},
+        {"doorModule", DeviceSimulator::Module::Actuator, 1},
+    };
+    for (uint32_t home = kDefaultHomeId; home < kDefaultHomeId + options.homes; ++home)
+    {
+        for (const SimulatedModule& entry : modules)
+        {
+            if (entry.module == DeviceSimulator::Module::Actuator && home != kDefaultHomeId)
+                continue;
+
+            for (size_t i = 0; i < entry.count; ++i)
+            {
+                std::unique_ptr<DeviceSimulator> simulator(new DeviceSimulator(entry.module, options.rate, tracker));
+                if (!simulator->open())
+                    return 1;
+
+                // 같은 종류의 두 번째 모듈부터는 이름 뒤에 번호를 붙임 (home마다 같은 이름 사용)
+                std::string name = entry.name;
+                if (i > 0)
+                    name += std::to_string(i + 1);
+                btManager.addDevice(name, simulator->path(), home);
+                simulators.push_back(std::move(simulator));
+            }
+        }
+    }
+
+    if (!btManager.initializeDevices())
+        return 1;
+
+    std::thread bluetoothThread([&btManager]() {
+        btManager.processDataLoop();
+    });
+
+    TCPServer server(options.port);
+    server.setLatestValueCache(&latestValues);
+    server.setSubscriptionHub(&hub);
+    server.setCommandCallback([&btManager](const Command& command, CommandCompletion done) {
+        btManager.handleTCPCommand(command, std::move(done));
+    });
+    if (!server.start())
+        return 1;
+
+    TcpLoadGenerator load(options.port, options.tcpClients, options.tcpWindow,
+                          {"window_open", "window_close", "light_on", "light_off", "door_open", "door_close",
+                           "get fire", "get plant"},
+                          options.tcpBinary);
+
+    for (auto& simulator : simulators)
+        simulator->start();
+    if (options.tcpClients > 0 && !load.start())
+        return 1;
+    SubscriberLoad subscribers(options.port, options.subscribers, "all");
+    if (options.subscribers > 0 && !subscribers.start())
+        return 1;
+
+    // 예열 후 측정 구간만 집계
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.warmup));
+
+    LatencyHistogram& handleLatency = Metrics::instance().histogram("ems_sensor_handle_seconds", "");
+    LatencyHistogram& commandLatency = Metrics::instance().histogram("ems_tcp_command_seconds", "");
+    handleLatency.reset();
+    commandLatency.reset();
+    sink->resetLatency();
+    load.resetLatency();
+    subscribers.resetLatency();
+
+    // 구동기 모듈에 실제로 쓴 명령 수 (기본 home의 window/light/door)
+    auto actuatorWrites = [&]() {
+        uint64_t total = 0;
+        for (const char* name : {"windowModule", "lightModule", "doorModule"})
+        {
+            std::string labels = "home=\"" + std::to_string(kDefaultHomeId) + "\",device=\"" + name + "\"";
+            total += Metrics::instance().counter("ems_bt_commands_sent_total", "", labels).value();
+        }
+        return total;
+    };
+
+    auto helperCpu = [&]() {
+        double total = load.cpuSeconds() + subscribers.cpuSeconds();
+        for (auto& simulator : simulators)
+            total += simulator->cpuSeconds();
+        return total;
+    };
+
+    uint64_t sentBefore = 0;
+    for (auto& simulator : simulators)
+        sentBefore += simulator->sentLines();
+    uint64_t processedBefore = btManager.ingestPipeline().processedLines();
+    uint64_t commandsBefore = load.completed();
+    uint64_t btWritesBefore = actuatorWrites();
+    uint64_t tcpBytesBefore = load.bytesSent() + load.bytesReceived();
+    uint64_t eventsBefore = subscribers.events();
+    uint64_t rowsBefore = sink->rows();
+    double cpuBefore = processCpuSeconds() - helperCpu();
+    auto begin = std::chrono::steady_clock::now();
+
+    // DB 장애: 장애가 끝난 뒤 spool에 밀린 행을 다 기록할 때까지 걸린 시간 측정
+    uint64_t outagePeakBacklog = 0;
+    double replaySeconds = -1.0;
+    std::thread outage;
+    if (options.dbOutage > 0.0)
+    {
+        sink->setAvailable(false);
+        outage = std::thread([&]() {
+            auto until = begin + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                     std::chrono::duration<double>(options.dbOutage));
+            while (std::chrono::steady_clock::now() < until)
+            {
+                outagePeakBacklog = std::max(outagePeakBacklog, DBManager::instance().stats().spoolBacklog);
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            sink->setAvailable(true);
+            auto recovered = std::chrono::steady_clock::now();
+            auto deadline = begin + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                        std::chrono::duration<double>(options.seconds));
+            while (std::chrono::steady_clock::now() < deadline)
+            {
+                if (DBManager::instance().stats().spoolBacklog < options.batch)
+                {
+                    replaySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - recovered).count();
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+    if (outage.joinable())
+        outage.join();
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    double serverCpu = processCpuSeconds() - helperCpu() - cpuBefore;
+    uint64_t sent = 0;
+    for (auto& simulator : simulators)
+        sent += simulator->sentLines();
+    sent -= sentBefore;
+    uint64_t processed = btManager.ingestPipeline().processedLines() - processedBefore;
+    uint64_t commands = load.completed() - commandsBefore;
+    uint64_t btWrites = actuatorWrites() - btWritesBefore;
+    uint64_t tcpBytes = load.bytesSent() + load.bytesReceived() - tcpBytesBefore;
+    uint64_t events = subscribers.events() - eventsBefore;
+    uint64_t rows = sink->rows() - rowsBefore;
+
+    load.stop();
+    subscribers.stop();
+    for (auto& simulator : simulators)
+        simulator->stop();
+
+    DBWriteStats db = DBManager::instance().stats();
+    double perSample = processed > 0 ? serverCpu * 1e6 / processed : 0.0;
+
+    std::printf("== ServerBench: %zu homes x %zu x 3 sensor modules @ %.0f lines/s, %zu tcp clients x %zu window, %.1f s\n",
+                options.homes, options.devices, options.rate, options.tcpClients, options.tcpWindow, elapsed);
+    std::printf("sensor lines           sent %llu  processed %llu  (%.1f lines/s)  ingest dropped %llu\n",
+                static_cast<unsigned long long>(sent), static_cast<unsigned long long>(processed),
+                processed / elapsed,
+                static_cast<unsigned long long>(btManager.ingestPipeline().droppedLines()));
+    std::printf("db sink                rows %llu (%.2f per line)  batches %llu  queue dropped %llu\n",
+                static_cast<unsigned long long>(rows),
+                processed > 0 ? static_cast<double>(rows) / processed : 0.0,
+                static_cast<unsigned long long>(sink->batches()),
+                static_cast<unsigned long long>(db.droppedRows));
+    if (!options.spool.empty())
+    {
+        std::printf("db spool               backlog %llu rows  %.1f MiB\n",
+                    static_cast<unsigned long long>(db.spoolBacklog), db.spoolBytes / 1048576.0);
+    }
+    if (options.dbOutage > 0.0)
+    {
+        std::printf("db outage              %.1f s  peak backlog %llu rows  replay %s%.2f s  failed rows %llu\n",
+                    options.dbOutage, static_cast<unsigned long long>(outagePeakBacklog),
+                    replaySeconds < 0.0 ? "not done " : "", std::max(replaySeconds, 0.0),
+                    static_cast<unsigned long long>(db.failedRows));
+    }
+    std::printf("tcp commands           completed %llu  (%.1f cmd/s)  errors %llu  %s  %.1f bytes/cmd\n",
+                static_cast<unsigned long long>(commands), commands / elapsed,
+                static_cast<unsigned long long>(load.errors()), options.tcpBinary ? "binary" : "text",
+                commands > 0 ? static_cast<double>(tcpBytes) / commands : 0.0);
+    std::printf("bt commands            written %llu (%.2f per cmd)  suppressed %llu  superseded %llu  coalesced %llu\n",
+                static_cast<unsigned long long>(btWrites),
+                commands > 0 ? static_cast<double>(btWrites) / commands : 0.0,
+                static_cast<unsigned long long>(
+                    Metrics::instance().counter("ems_bt_commands_suppressed_total", "").value()),
+                static_cast<unsigned long long>(
+                    Metrics::instance().counter("ems_bt_commands_superseded_total", "").value()),
+                static_cast<unsigned long long>(
+                    Metrics::instance().counter("ems_bt_commands_coalesced_total", "").value()));
+    if (options.subscribers > 0)
+    {
+        Metrics& metrics = Metrics::instance();
+        std::printf("stream                 subscribers %zu  events %llu  (%.1f events/s)  dropped %llu\n",
+                    options.subscribers, static_cast<unsigned long long>(events), events / elapsed,
+                    static_cast<unsigned long long>(
+                        metrics.counter("ems_stream_dropped_total", "").value()));
+    }
+    printLatency("sample e2e (ms)", sink->endToEnd(), 1e6, "ms");
+    printLatency("handleData (us)", handleLatency, 1e3, "us");
+    printLatency("tcp round trip (us)", load.roundTrip(), 1e3, "us");
+    printLatency("tcp command (us)", commandLatency, 1e3, "us");
+    if (options.subscribers > 0)
+        printLatency("stream delivery (us)", subscribers.delivery(), 1e3, "us");
+    std::printf("server cpu             %.3f s  (%.2f us/sample, %.1f%% of one core)\n",
+                serverCpu, perSample, serverCpu * 100.0 / elapsed);
+
+    std::printf("RESULT lines_per_sec=%.1f e2e_p50_ms=%.3f e2e_p99_ms=%.3f e2e_p999_ms=%.3f "
+                "handle_p50_us=%.3f handle_p99_us=%.3f handle_p999_us=%.3f "
+                "cmd_per_sec=%.1f rtt_p50_us=%.3f rtt_p99_us=%.3f rtt_p999_us=%.3f cpu_us_per_sample=%.2f\n",
+                processed / elapsed,
+                sink->endToEnd().percentile(0.5) / 1e6, sink->endToEnd().percentile(0.99) / 1e6,
+                sink->endToEnd().percentile(0.999) / 1e6,
+                handleLatency.percentile(0.5) / 1e3, handleLatency.percentile(0.99) / 1e3,
+                handleLatency.percentile(0.999) / 1e3,
+                commands / elapsed,
+                load.roundTrip().percentile(0.5) / 1e3, load.roundTrip().percentile(0.99) / 1e3,
+                load.roundTrip().percentile(0.999) / 1e3, perSample);
+    if (localStore.isOpen())
+    {
+        localStore.flush();
+        TimeSeriesStats store = localStore.stats();
+        std::printf("local store            series %zu  points %llu  %.2f bytes/point\n",
+                    store.series, static_cast<unsigned long long>(store.points), store.bytesPerPoint);
+    }
+
+    // 서버와 같은 순서로 종료 (TCP → 블루투스 → DB), 걸린 시간 출력
+    auto shutdownBegin = std::chrono::steady_clock::now();
+    server.stop();
+    btManager.stop();
+    bluetoothThread.join();
+    if (options.aggregate)
+        aggregator.flush();
+    DBManager::instance().shutdown();
+    localStore.close();
+    double shutdownMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shutdownBegin).count();
+    std::printf("shutdown               %.1f ms  db failed rows %llu\n", shutdownMs,
+                static_cast<unsigned long long>(DBManager::instance().stats().failedRows));
+    std::fflush(stdout);
+
+    Logger::instance().shutdown();
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "SubscriberLoad.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <chrono>
+
+SubscriberLoad::SubscriberLoad(int port, size_t clients, std::string filter)
+    : m_port(port),
+      m_filter(std::move(filter)),
+      m_running(false),
+      m_events(0)
+{
+    for (size_t i = 0; i < clients; ++i)
+        m_clients.emplace_back(new Client());
+}
+
+SubscriberLoad::~SubscriberLoad()
+{
+    stop();
+}
+
+bool SubscriberLoad::start()
+{
+    std::string request = "subscribe " + m_filter + "\n";
+    for (auto& client : m_clients)
+    {
+        client->fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+        struct sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(m_port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (client->fd < 0 || connect(client->fd, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+            send(client->fd, request.data(), request.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(request.size()))
+        {
+            perror("구독 클라이언트 연결 실패");
+            stop();
+            return false;
+        }
+
+        // 종료 시 recv에서 오래 멈추지 않도록
+        struct timeval timeout = {0, 200 * 1000};
+        setsockopt(client->fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    m_running = true;
+    for (auto& client : m_clients)
+        client->thread = std::thread(&SubscriberLoad::run, this, std::ref(*client));
+    return true;
+}
+
+void SubscriberLoad::stop()
+{
+    m_running = false;
+    for (auto& client : m_clients)
+    {
+        if (client->thread.joinable())
+            client->thread.join();
+        if (client->fd >= 0)
+            close(client->fd);
+        client->fd = -1;
+    }
+}
+
+double SubscriberLoad::cpuSeconds()
+{
+    double total = 0.0;
+    for (auto& client : m_clients)
+    {
+        clockid_t clock;
+        struct timespec ts;
+        if (client->thread.joinable() &&
+            pthread_getcpuclockid(client->thread.native_handle(), &clock) == 0 &&
+            clock_gettime(clock, &ts) == 0)
+        {
+            total += ts.tv_sec + ts.tv_nsec / 1e9;
+        }
+    }
+    return total;
+}
+
+// "EVENT ... time_us=<서버 수신 시각> ..." 줄마다 도착 시각과의 차이를 기록
+void SubscriberLoad::run(Client& client)
+{
+    std::string pending;
+    char buffer[16384];
+
+    while (m_running)
+    {
+        ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (n <= 0)
+            continue;
+
+        int64_t nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        pending.append(buffer, static_cast<size_t>(n));
+
+        size_t start = 0;
+        size_t end;
+        while ((end = pending.find('\n', start)) != std::string::npos)
+        {
+            if (pending.compare(start, 6, "EVENT ") == 0)
+            {
+                size_t field = pending.find("time_us=", start);
+                if (field != std::string::npos && field < end)
+                {
+                    int64_t sentUs = std::strtoll(pending.c_str() + field + 8, nullptr, 10);
+                    if (nowUs > sentUs)
+                        m_delivery.record(static_cast<uint64_t>(nowUs - sentUs) * 1000);
+                }
+                m_events.fetch_add(1, std::memory_order_relaxed);
+            }
+            start = end + 1;
+        }
+        pending.erase(0, start);
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef SUBSCRIBERLOAD_H
+#define SUBSCRIBERLOAD_H
+
+#include "Metrics.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+// 구독 클라이언트 부하
+// 클라이언트마다 "subscribe <filter>"를 보내고 받은 EVENT 줄 수와
+// 서버 수신 시각(time_us)부터 클라이언트 도착까지의 지연 시간을 기록
+class SubscriberLoad
+{
+public:
+    SubscriberLoad(int port, size_t clients, std::string filter);
+    ~SubscriberLoad();
+    SubscriberLoad(const SubscriberLoad&) = delete;
+    SubscriberLoad& operator=(const SubscriberLoad&) = delete;
+
+    bool start();
+    void stop();
+
+    uint64_t events() const { return m_events.load(std::memory_order_relaxed); }
+    const LatencyHistogram& delivery() const { return m_delivery; }
+    void resetLatency() { m_delivery.reset(); }
+    // 클라이언트 스레드들이 지금까지 쓴 CPU 시간 (실행 중에만 유효)
+    double cpuSeconds();
+
+private:
+    struct Client
+    {
+        int fd = -1;
+        std::thread thread;
+    };
+
+    void run(Client& client);
+
+    int m_port;
+    std::string m_filter;
+    std::vector<std::unique_ptr<Client>> m_clients;
+    std::atomic<bool> m_running;
+    std::atomic<uint64_t> m_events;
+    LatencyHistogram m_delivery;
+};
+
+#endif // SUBSCRIBERLOAD_H
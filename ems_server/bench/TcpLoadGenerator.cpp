@@ -0,0 +1,246 @@
+#include "TcpLoadGenerator.h"
+#include "BinaryProtocol.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+
+TcpLoadGenerator::TcpLoadGenerator(int port, size_t clients, size_t window,
+                                   std::vector<std::string> commands, bool binary)
+    : m_port(port),
+      m_window(window == 0 ? 1 : window),
+      m_commands(std::move(commands)),
+      m_binary(binary),
+      m_running(false),
+      m_completed(0),
+      m_errors(0),
+      m_bytesSent(0),
+      m_bytesReceived(0)
+{
+    for (size_t i = 0; i < clients; ++i)
+        m_clients.emplace_back(new Client());
+}
+
+TcpLoadGenerator::~TcpLoadGenerator()
+{
+    stop();
+}
+
+bool TcpLoadGenerator::start()
+{
+    if (m_commands.empty())
+        return false;
+
+    for (auto& client : m_clients)
+    {
+        client->fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+        struct sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(m_port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (client->fd < 0 || connect(client->fd, (struct sockaddr*)&address, sizeof(address)) < 0)
+        {
+            perror("부하 생성기 연결 실패");
+            stop();
+            return false;
+        }
+
+        int one = 1;
+        setsockopt(client->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        // 종료 시 recv에서 오래 멈추지 않도록
+        struct timeval timeout = {0, 200 * 1000};
+        setsockopt(client->fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        if (m_binary && !negotiate(*client))
+        {
+            std::fprintf(stderr, "바이너리 프로토콜 협상 실패\n");
+            stop();
+            return false;
+        }
+    }
+
+    m_running = true;
+    for (size_t i = 0; i < m_clients.size(); ++i)
+        m_clients[i]->thread = std::thread(m_binary ? &TcpLoadGenerator::runBinary : &TcpLoadGenerator::run,
+                                           this, std::ref(*m_clients[i]), i);
+    return true;
+}
+
+void TcpLoadGenerator::stop()
+{
+    m_running = false;
+    for (auto& client : m_clients)
+    {
+        if (client->thread.joinable())
+            client->thread.join();
+        if (client->fd >= 0)
+            close(client->fd);
+        client->fd = -1;
+    }
+}
+
+// [magic][version]을 보내고 서버가 같은 2바이트로 답하는지 확인
+bool TcpLoadGenerator::negotiate(Client& client)
+{
+    const char hello[kBinaryHelloSize] = { static_cast<char>(kBinaryMagic), static_cast<char>(kBinaryVersion) };
+    if (send(client.fd, hello, sizeof(hello), MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(hello)))
+        return false;
+
+    char reply[kBinaryHelloSize];
+    size_t received = 0;
+    while (received < sizeof(reply))
+    {
+        ssize_t n = recv(client.fd, reply + received, sizeof(reply) - received, 0);
+        if (n <= 0)
+            return false;
+        received += n;
+    }
+    return std::memcmp(reply, hello, sizeof(hello)) == 0;
+}
+
+double TcpLoadGenerator::cpuSeconds()
+{
+    double total = 0.0;
+    for (auto& client : m_clients)
+    {
+        clockid_t clock;
+        struct timespec ts;
+        if (client->thread.joinable() &&
+            pthread_getcpuclockid(client->thread.native_handle(), &clock) == 0 &&
+            clock_gettime(clock, &ts) == 0)
+        {
+            total += ts.tv_sec + ts.tv_nsec / 1e9;
+        }
+    }
+    return total;
+}
+
+// 닫힌 루프: 응답 하나가 오면 명령 하나를 더 보내서 항상 window개를 유지
+void TcpLoadGenerator::run(Client& client, size_t index)
+{
+    using Clock = std::chrono::steady_clock;
+    std::deque<Clock::time_point> inFlight;
+    size_t next = index;
+    std::string out;
+    char buffer[4096];
+
+    while (m_running)
+    {
+        out.clear();
+        while (inFlight.size() < m_window)
+        {
+            out += m_commands[next++ % m_commands.size()];
+            out += '\n';
+            inFlight.push_back(Clock::now());
+        }
+        if (!out.empty() && send(client.fd, out.data(), out.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(out.size()))
+        {
+            m_errors.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        m_bytesSent.fetch_add(out.size(), std::memory_order_relaxed);
+
+        ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+            continue;
+        if (n <= 0)
+        {
+            m_errors.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        m_bytesReceived.fetch_add(n, std::memory_order_relaxed);
+
+        // 응답은 명령 순서대로 한 줄씩 옴
+        Clock::time_point now = Clock::now();
+        for (ssize_t i = 0; i < n; ++i)
+        {
+            if (buffer[i] != '\n' || inFlight.empty())
+                continue;
+            m_roundTrip.record(now - inFlight.front());
+            inFlight.pop_front();
+            m_completed.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+// 바이너리 프로토콜: 응답이 보낸 순서대로 오지 않으므로 requestId로 보낸 시각을 찾음
+void TcpLoadGenerator::runBinary(Client& client, size_t index)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // 텍스트 명령을 한 번만 opcode + payload로 변환
+    std::vector<std::pair<Opcode, std::string>> requests;
+    for (const std::string& text : m_commands)
+    {
+        Command command = parseCommand(text);
+        requests.emplace_back(command.spec ? command.spec->opcode : Opcode::None, std::string(command.args));
+    }
+
+    std::unordered_map<uint32_t, Clock::time_point> inFlight;
+    uint32_t nextId = 0;
+    size_t next = index;
+    std::string out;
+    std::string in;
+    char buffer[4096];
+
+    while (m_running)
+    {
+        out.clear();
+        while (inFlight.size() < m_window)
+        {
+            const auto& request = requests[next++ % requests.size()];
+            size_t start = beginBinaryFrame(out, request.first, ++nextId, 0);
+            out += request.second;
+            finishBinaryFrame(out, start, BinaryStatus::Ok);
+            inFlight.emplace(nextId, Clock::now());
+        }
+        if (!out.empty() && send(client.fd, out.data(), out.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(out.size()))
+        {
+            m_errors.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        m_bytesSent.fetch_add(out.size(), std::memory_order_relaxed);
+
+        ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+            continue;
+        if (n <= 0)
+        {
+            m_errors.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        m_bytesReceived.fetch_add(n, std::memory_order_relaxed);
+        in.append(buffer, n);
+
+        Clock::time_point now = Clock::now();
+        size_t offset = 0;
+        while (in.size() - offset >= kBinaryHeaderSize)
+        {
+            BinaryHeader header = decodeBinaryHeader(in.data() + offset);
+            if (in.size() - offset < kBinaryHeaderSize + header.length)
+                break;
+            offset += kBinaryHeaderSize + header.length;
+
+            auto it = inFlight.find(header.requestId);
+            if (it == inFlight.end())
+                continue;
+            m_roundTrip.record(now - it->second);
+            inFlight.erase(it);
+            m_completed.fetch_add(1, std::memory_order_relaxed);
+        }
+        in.erase(0, offset);
+    }
+}
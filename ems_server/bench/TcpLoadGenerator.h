@@ -0,0 +1,59 @@
+#ifndef TCPLOADGENERATOR_H
+#define TCPLOADGENERATOR_H
+
+#include "Metrics.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+// TCP 명령 부하 생성기
+// 클라이언트마다 명령 window개를 파이프라이닝해서 보내고 응답 줄이 올 때마다 왕복 시간을 기록
+// binary면 바이너리 프로토콜로 협상해서 같은 명령을 opcode 프레임으로 보냄 (응답은 requestId로 짝을 맞춤)
+class TcpLoadGenerator
+{
+public:
+    TcpLoadGenerator(int port, size_t clients, size_t window, std::vector<std::string> commands,
+                     bool binary = false);
+    ~TcpLoadGenerator();
+    TcpLoadGenerator(const TcpLoadGenerator&) = delete;
+    TcpLoadGenerator& operator=(const TcpLoadGenerator&) = delete;
+
+    bool start();
+    void stop();
+
+    uint64_t completed() const { return m_completed.load(std::memory_order_relaxed); }
+    uint64_t errors() const { return m_errors.load(std::memory_order_relaxed); }
+    uint64_t bytesSent() const { return m_bytesSent.load(std::memory_order_relaxed); }
+    uint64_t bytesReceived() const { return m_bytesReceived.load(std::memory_order_relaxed); }
+    const LatencyHistogram& roundTrip() const { return m_roundTrip; }
+    void resetLatency() { m_roundTrip.reset(); }
+    // 클라이언트 스레드들이 지금까지 쓴 CPU 시간 (실행 중에만 유효)
+    double cpuSeconds();
+
+private:
+    struct Client
+    {
+        int fd = -1;
+        std::thread thread;
+    };
+
+    void run(Client& client, size_t index);
+    void runBinary(Client& client, size_t index);
+    bool negotiate(Client& client);
+
+    int m_port;
+    size_t m_window;
+    std::vector<std::string> m_commands;
+    bool m_binary;
+    std::vector<std::unique_ptr<Client>> m_clients;
+    std::atomic<bool> m_running;
+    std::atomic<uint64_t> m_completed;
+    std::atomic<uint64_t> m_errors;
+    std::atomic<uint64_t> m_bytesSent;
+    std::atomic<uint64_t> m_bytesReceived;
+    LatencyHistogram m_roundTrip;
+};
+
+#endif // TCPLOADGENERATOR_H
@@ -1,47 +1,97 @@
 #include <iostream>
 #include <thread>
-#include <signal.h>
+#include "Lifecycle.h"
 #include "BluetoothManager.h"
 #include "DBManager.h"
 #include "TCPServer.h"
+#include "Logger.h"
+#include "MetricsServer.h"
+#include "TimeSeriesStore.h"
+#include "LatestValueCache.h"
+#include "SubscriptionHub.h"
+#include "SampleAggregator.h"
+#include "RuleEngine.h"
+#include "ServerConfig.h"
 
-// 전역 변수로 서버 인스턴스 관리
-TCPServer* tcpServer = nullptr;
-std::atomic<bool> running(true);
+// 종료 전체 기한 (systemd 기본 TimeoutStopSec 90초보다 충분히 짧게)
+constexpr std::chrono::seconds kShutdownBudget(10);
 
-// 시그널 핸들러
-void signalHandler(int signal)
+int main(int argc, char* argv[])
 {
-    std::cout << "\n종료 신호 받음..." << std::endl;
-    running = false;
-    
-    if (tcpServer)
+    // 종료/reload 신호는 signalfd로 받음 (다른 스레드를 만들기 전에 SIGINT/SIGTERM/SIGHUP을 막아야 함)
+    Lifecycle lifecycle;
+
+    // 설정 파일 (기본 ems.conf, 인자로 다른 경로)
+    // SIGHUP을 보내면 로그 레벨, 경보 기준, 명령 기한, 구동기 debounce만 바로 바뀌고 나머지는 재시작해야 적용됨
+    std::string configPath = (argc > 1) ? argv[1] : "ems.conf";
+    if (!RuntimeConfig::instance().load(configPath))
     {
-        tcpServer->stop();
+        std::cerr << "설정 파일 오류: " << configPath << std::endl;
+        return 1;
     }
-}
-
-int main()
-{
-    // 시그널 핸들러 등록
-    signal(SIGINT, signalHandler);
-    signal(SIGTERM, signalHandler);
+    std::shared_ptr<const ServerConfig> config = RuntimeConfig::instance().snapshot();
 
     // 1. DB 연결
-    if (!DBManager::instance().connect("127.0.0.1", "user1", "1234", "hometer", 3306))
+    // db.spool을 정하면 센서 행을 spool 디렉터리에 먼저 기록 (MySQL이 꺼져 있거나 서버가 죽어도 다음에 이어서 기록)
+    DBManager::instance().configure(config->dbWrite);
+    DBManager::instance().configurePool(config->dbPool);
+    if (!DBManager::instance().connect(config->db.host, config->db.user, config->db.password,
+                                       config->db.name, config->db.port))
     {
         std::cerr << "DB 연결 실패" << std::endl;
         return 1;
     }
 
+    // 로컬 시계열 저장소 (외부 서비스 없이 gateway에 원본 샘플 보관, 실패해도 MySQL 저장은 계속)
+    TimeSeriesStore localStore;
+    TimeSeriesOptions storeOptions;
+    storeOptions.directory = config->timeSeriesDirectory;
+    bool localStoreReady = !storeOptions.directory.empty() && localStore.open(storeOptions);
+
+    // MySQL에는 구간 집계와 deadband 이상 바뀐 샘플만 기록 (화재/가스 임계값을 넘은 샘플은 항상 즉시)
+    SampleAggregator dbAggregator(&DBManager::instance());
+
+    // TCP get/snapshot 명령으로 조회하는 디바이스별 최신 값
+    LatestValueCache latestValues;
+
+    // TCP subscribe 명령으로 받는 실시간 센서 업데이트
+    SubscriptionHub streamHub;
+
     // 2. 블루투스 매니저 초기화
     BluetoothManager btManager;
-    btManager.addDevice("fireModule",   "/dev/rfcomm0");
-    // btManager.addDevice("petModule",    "/dev/rfcomm1");
-    // btManager.addDevice("plantModule",  "/dev/rfcomm2");
-    // btManager.addDevice("windowModule", "/dev/rfcomm3");  // Smart Window 모듈
-    // btManager.addDevice("lightModule",  "/dev/rfcomm4");  // 조명 제어 모듈 (필요시)
-    // btManager.addDevice("doorModule",   "/dev/rfcomm5");  // 문 제어 모듈 (필요시)
+    btManager.setIngestWorkers(config->ingestWorkers, config->ingestQueueCapacity);
+    btManager.setSupervisorOptions(config->supervisor);
+    btManager.setCommandTimeout(config->commandTimeout);
+    btManager.setActuatorOptions(config->actuator);
+
+    // 센서 규칙 (rules.file, 수정하면 재시작 없이 다시 읽음)
+    // 가장 먼저 등록해서 화재/가스 대응 명령이 DB 기록을 기다리지 않도록 함
+    // 규칙 동작은 샘플을 보낸 home의 디바이스로 보냄
+    RuleEngine rules([&btManager](uint32_t homeId, const std::string& target, const std::string& command) {
+        if (target == "all")
+            btManager.sendToAllDevices(homeId, command);
+        else
+            btManager.sendCommand(homeId, target, command);
+    });
+    rules.loadFile(config->rulesFile);
+    rules.watch(config->rulesFile);
+    btManager.addSink(&rules);
+    btManager.addSink(&latestValues);
+    btManager.addSink(&streamHub);
+    btManager.addSink(&dbAggregator);
+    if (localStoreReady)
+    {
+        btManager.addSink(&localStore);
+    }
+
+    // 설정 파일의 device/remote 줄 (원격 gateway가 TCP sensor 명령으로 넘겨주는 모듈은 포트 없이 등록)
+    for (const DeviceConfig& device : config->devices)
+    {
+        if (device.path.empty())
+            btManager.addRemoteDevice(device.name, device.homeId);
+        else
+            btManager.addDevice(device.name, device.path, device.homeId);
+    }
 
     if (!btManager.initializeDevices())
     {
@@ -50,20 +100,35 @@ int main()
     }
 
     // 3. TCP 서버 초기화 및 시작
-    tcpServer = new TCPServer(8080);
+    TCPServer tcpServer(config->tcpPort, config->tcpThreads);
+    tcpServer.setLatestValueCache(&latestValues);
+    tcpServer.setSubscriptionHub(&streamHub, config->subscription);
     
     // TCP 명령을 블루투스로 전달하는 콜백 설정
-    tcpServer->setCommandCallback([&btManager](const std::string& command) {
-        btManager.handleTCPCommand(command);
+    tcpServer.setCommandCallback([&btManager](const Command& command, CommandCompletion done) {
+        btManager.handleTCPCommand(command, std::move(done));
+    });
+
+    // 원격 gateway가 넘기는 센서 줄은 로컬 포트와 같은 ingest worker로
+    tcpServer.setSensorLineCallback([&btManager](uint32_t homeId, std::string_view device, std::string_view line) {
+        return btManager.submitRemoteLine(homeId, device, line);
     });
 
-    if (!tcpServer->start())
+    // state 명령은 블루투스를 거치지 않고 마지막으로 요청/전송된 구동기 상태로 바로 응답
+    tcpServer.setActuatorStateCallback([&btManager](uint32_t homeId, std::string_view device, ActuatorState& state) {
+        return btManager.actuatorState(homeId, device, state);
+    });
+
+    if (!tcpServer.start())
     {
         std::cerr << "TCP 서버 시작 실패" << std::endl;
-        delete tcpServer;
         return 1;
     }
 
+    // Prometheus 수집용 /metrics (실패해도 서버는 계속 동작)
+    MetricsServer metricsServer(config->metricsPort);
+    metricsServer.start();
+
     // 4. 블루투스 데이터 수신을 별도 스레드에서 실행
     std::thread bluetoothThread([&btManager]() {
         btManager.processDataLoop();
@@ -71,30 +136,55 @@ int main()
 
     // 5. 메인 스레드는 종료 신호 대기
     std::cout << "스마트 홈 서버가 시작되었습니다." << std::endl;
-    std::cout << "TCP 포트: 8080" << std::endl;
+    std::cout << "TCP 포트: " << config->tcpPort << std::endl;
     std::cout << "블루투스 데이터 수신 중..." << std::endl;
     std::cout << "종료하려면 Ctrl+C를 누르세요." << std::endl;
 
-    while (running)
-    {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-    }
+    // 6. 종료 순서: 새 입력을 먼저 끊고, 데이터가 흘러가는 방향대로 비움
+    // 새 TCP 명령을 받지 않음 (대기 중인 응답은 블루투스 쓰기 결과와 함께 정리됨)
+    lifecycle.addStage("tcp", [&tcpServer](Lifecycle::Clock::time_point) {
+        tcpServer.stop();
+    });
+    // 수신 루프 종료 → 송신 큐 마지막 쓰기 → 재연결 감시와 ingest 워커가 큐를 비우고 종료
+    lifecycle.addStage("bluetooth", [&btManager, &bluetoothThread](Lifecycle::Clock::time_point) {
+        btManager.stop();
+        if (bluetoothThread.joinable())
+            bluetoothThread.join();
+    });
+    lifecycle.addStage("rules", [&rules](Lifecycle::Clock::time_point) {
+        rules.stopWatching();
+    });
+    // 열린 집계 구간과 큐에 남은 센서 데이터를 DB에 기록 (남은 기한 안에서만, 못 한 행은 spool에 남음)
+    lifecycle.addStage("db", [&dbAggregator](Lifecycle::Clock::time_point deadline) {
+        dbAggregator.flush();
+        DBManager::instance().shutdown(remainingUntil(deadline));
+    });
+    lifecycle.addStage("tsdb", [&localStore](Lifecycle::Clock::time_point) {
+        localStore.close();
+    });
+    // 종료 중에도 수집할 수 있도록 마지막에 멈춤
+    lifecycle.addStage("metrics", [&metricsServer](Lifecycle::Clock::time_point) {
+        metricsServer.stop();
+    });
 
-    // 6. 정리
-    std::cout << "서버 종료 중..." << std::endl;
-    
-    if (tcpServer)
-    {
-        tcpServer->stop();
-        delete tcpServer;
-    }
+    // SIGHUP: 설정 파일과 규칙 파일을 바로 다시 읽음 (main 스레드에서 실행)
+    // 경보 기준은 sink가 설정 스냅샷에서 직접 읽고, 명령 기한과 구동기 debounce는 여기서 넘겨줌
+    lifecycle.setReloadHandler([&btManager, &rules, &config]() {
+        if (RuntimeConfig::instance().reload())
+        {
+            std::shared_ptr<const ServerConfig> reloaded = RuntimeConfig::instance().snapshot();
+            btManager.setCommandTimeout(reloaded->commandTimeout);
+            btManager.setActuatorOptions(reloaded->actuator);
+        }
+        rules.loadFile(config->rulesFile);
+    });
 
-    // 블루투스 스레드는 무한루프라서 강제 종료
-    // 실제 운영환경에서는 더 우아한 종료 방법 필요
-    if (bluetoothThread.joinable())
-    {
-        bluetoothThread.detach();
-    }
+    int signo = lifecycle.waitForStop();
+    std::cout << "\n종료 신호 받음 (" << signo << "), 서버 종료 중..." << std::endl;
+    lifecycle.shutdown(kShutdownBudget);
+
+    // 남은 로그 출력
+    Logger::instance().shutdown();
 
     std::cout << "서버가 종료되었습니다." << std::endl;
     return 0;